@@ -0,0 +1,77 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See https://alice-o2.web.cern.ch/ for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \author R+Preghenella - September 2017
+
+#include "CheckpointHook.h"
+#include "FairLogger.h"
+
+namespace o2sim
+{
+
+  /*****************************************************************/
+  /*****************************************************************/
+
+  CheckpointHook::CheckpointHook() :
+    fEvery(0),
+    fEvents(0),
+    fFailed(kFALSE),
+    fCheckpoint()
+  {
+    /** default constructor **/
+
+  }
+
+  /*****************************************************************/
+
+  CheckpointHook &
+  CheckpointHook::Instance()
+  {
+    /** instance **/
+
+    static CheckpointHook instance;
+    return instance;
+  }
+  
+  /*****************************************************************/
+
+  void
+  CheckpointHook::Set(Int_t every, const std::function<Bool_t(Long64_t)> &checkpoint)
+  {
+    /** set, the event count restarts **/
+
+    fEvery = checkpoint ? every : 0;
+    fEvents = 0;
+    fFailed = kFALSE;
+    fCheckpoint = checkpoint;
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  CheckpointHook::BeginEvent()
+  {
+    /** begin event, the checkpoint is taken before the
+	first event after every given number of events **/
+
+    if (fEvery <= 0) return kTRUE;
+    auto events = fEvents++;
+    if (events == 0 || events % fEvery != 0) return kTRUE;
+    if (fCheckpoint(events)) return kTRUE;
+    LOG(ERROR) << "Checkpoint failed after " << events << " events, stopping the run" << std::endl;
+    fFailed = kTRUE;
+    fEvery = 0;
+    return kFALSE;
+  }
+  
+  /*****************************************************************/
+  /*****************************************************************/
+
+} /** namespace o2sim **/
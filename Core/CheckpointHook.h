@@ -0,0 +1,69 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See https://alice-o2.web.cern.ch/ for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \author R+Preghenella - September 2017
+
+#ifndef ALICEO2SIM_CHECKPOINTHOOK_H_
+#define ALICEO2SIM_CHECKPOINTHOOK_H_
+
+#include "Rtypes.h"
+#include <functional>
+
+namespace o2sim {
+
+  /*****************************************************************/
+  /*****************************************************************/
+
+  /** checkpoint hook, called by the primary generator at the
+      beginning of each transport event. the checkpoints are written
+      between events while FairRunSim and FairMCApplication drive
+      the whole run, the previous events are complete and filled **/
+  
+  class CheckpointHook
+  {
+
+  public:
+
+    /** instance **/
+    static CheckpointHook &Instance();
+
+    /** getters **/
+    Bool_t IsFailed() const {return fFailed;};
+    
+    /** setters, the checkpoint is called every given number
+	of events with the events done so far, 0 removes it **/
+    void Set(Int_t every, const std::function<Bool_t(Long64_t)> &checkpoint);
+
+    /** methods, kFALSE if the checkpoint failed **/
+    Bool_t BeginEvent();
+    
+  private:
+
+    /** default constructor **/
+    CheckpointHook();
+    /** copy constructor **/
+    CheckpointHook(const CheckpointHook &);
+    /** operator= **/
+    CheckpointHook &operator=(const CheckpointHook &);
+
+    /** data members **/
+    Int_t fEvery;
+    Long64_t fEvents;  // events started since set
+    Bool_t fFailed;
+    std::function<Bool_t(Long64_t)> fCheckpoint;
+    
+  }; /** class CheckpointHook **/
+
+  /*****************************************************************/
+  /*****************************************************************/
+
+} /** namespace o2sim **/
+
+#endif /* ALICEO2SIM_CHECKPOINTHOOK_H_ */
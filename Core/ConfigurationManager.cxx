@@ -11,12 +11,17 @@
 /// \author R+Preghenella - August 2017
 
 #include "ConfigurationManager.h"
+#include "Profiler.h"
 #include "TString.h"
 #include "TObjArray.h"
 #include "TObjString.h"
 #include <iostream>
 #include <iomanip>
-#include "TSystem.h"
+#include <sstream>
+#include <cstdlib>
+#include <cerrno>
+#include <climits>
+#include <cmath>
 #include "TROOT.h"
 #include "TClass.h"
 
@@ -29,11 +34,20 @@ namespace o2sim
   /*****************************************************************/
 
   TString ConfigurationManager::fgPrependCommand;
+  std::vector<std::string> *ConfigurationManager::fgRecordFiles = nullptr;
   
   /*****************************************************************/
 
   ConfigurationManager::ConfigurationManager() :
-    TObject()
+    TObject(),
+    fValue(),
+    fPath(),
+    fDelegate(),
+    fDelegateClass(),
+    fChanged(),
+    fCompiled(kFALSE),
+    fSlot(),
+    fSlotHandle()
   {
     /** deafult constructor **/
 
@@ -58,6 +72,58 @@ namespace o2sim
 
   /*****************************************************************/
 
+  Bool_t
+  ConfigurationManager::RegisterPath(TString name, value_t value)
+  {
+    /** register value holding file paths **/
+
+    if (!RegisterValue(name, value)) return kFALSE;
+    fPath.insert(name);
+    return kTRUE;
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  ConfigurationManager::MakePathsAbsolute(TString directory)
+  {
+    /** make paths absolute, each token of a path value is
+	expanded and prefixed with the directory unless it is
+	absolute or an URL. a leading @ marks a manifest file **/
+
+    if (fCompiled) {
+      LOG(ERROR) << "Configuration is compiled, cannot change paths" << std::endl;
+      return kFALSE;
+    }
+    for (auto const &name : fPath) {
+      std::istringstream stream(fValue[name].Data());
+      TString value;
+      for (std::string token; stream >> token;) {
+	TString prefix, path;
+	TString str = token;
+	if (str.BeginsWith("@")) {
+	  prefix = "@";
+	  str.Remove(0, 1);
+	}
+	if (!ExpandVariables(str, path)) path = str;
+	if (!path.BeginsWith("/") && !path.Contains("://"))
+	  path = directory + "/" + path;
+	if (!value.IsNull()) value += " ";
+	value += prefix + path;
+      }
+      fValue[name] = value;
+    }
+
+    /** delegates **/
+    for (auto const &x : fDelegate)
+      if (x.second && !x.second->MakePathsAbsolute(directory)) return kFALSE;
+
+    /** success **/
+    return kTRUE;
+  }
+
+  /*****************************************************************/
+
   Bool_t
   ConfigurationManager::RegisterDelegate(TString name, delegate_t *delegate, TClass *delegate_class)
   {
@@ -97,8 +163,11 @@ namespace o2sim
       }
       args += " " + ((TObjString *)oa->At(i))->GetString();
     }
+    delete oa;
     oa = name.Tokenize(".");
     TString value = ((TObjString *)oa->At(0))->GetString();
+    Bool_t forward = oa->GetEntries() > 1;
+    delete oa;
 
 #if PROCESSCOMMAND_VERBOSE
     std::cout << "[" << this->ClassName() << "]" << " process command \"" << command << "\"" << std::endl;
@@ -120,7 +189,7 @@ namespace o2sim
     }
 
     /** commands to be forwarded to delegate **/
-    if (oa->GetEntries() > 1) {
+    if (forward) {
       command.Remove(0, value.Sizeof());
       /** send command to all delegates **/
       if (value.EqualTo("*")) {
@@ -147,26 +216,26 @@ namespace o2sim
     if (value.EqualTo("delegate()")) {
       if (!(processMask & kDelegates)) return kTRUE;
       oa = args.Tokenize(" \t");
-      if (oa->GetEntries() != 2) return kFALSE;
-      TString delegate_name = ((TObjString *)oa->At(0))->GetString();
-      TString delegate_class_name = ((TObjString *)oa->At(1))->GetString();
+      Int_t entries = oa->GetEntries();
+      TString delegate_name = entries > 0 ? ((TObjString *)oa->At(0))->GetString() : "";
+      TString delegate_class_name = entries > 1 ? ((TObjString *)oa->At(1))->GetString() : "";
+      delete oa;
+      if (entries != 2) return kFALSE;
       if (!delegate_class_name.BeginsWith("o2sim::"))
 	delegate_class_name = "o2sim::" + delegate_class_name;
-      TClass *delegate_class = gROOT->GetClass(delegate_class_name);
 #if PROCESSCOMMAND_VERBOSE
       std::cout << "[" << this->ClassName() << "]" << " delegate \"" << delegate_name << "\" to \"" << delegate_class_name << "\"" << std::endl;
 #endif      
-      if (!delegate_class) return kFALSE;
-      auto delegate = (ConfigurationManager *)delegate_class->New();
-      if (!delegate) return kFALSE;
-      return RegisterDelegate(delegate_name, delegate, delegate_class);
+      return CreateDelegate(delegate_name, delegate_class_name);
     }
       
     /** special include() command **/
     if (value.EqualTo("include()")) {
       oa = args.Tokenize(" \t");
-      if (oa->GetEntries() != 1) return kFALSE;
-      TString filename = ((TObjString *)oa->At(0))->GetString();
+      Int_t entries = oa->GetEntries();
+      TString filename = entries > 0 ? ((TObjString *)oa->At(0))->GetString() : "";
+      delete oa;
+      if (entries != 1) return kFALSE;
       TString prepend = fgPrependCommand;
       Bool_t retval = ProcessFile(filename, processMask);
       fgPrependCommand = prepend;
@@ -179,7 +248,12 @@ namespace o2sim
       std::cout << "[" << this->ClassName() << "]" << " change \"" << value << "\" value: \"" << args << "\"" << std::endl;
 #endif
       if (!ValidValue(value)) return kFALSE;
+      if (fCompiled) {
+	LOG(ERROR) << "Configuration is compiled, cannot change \"" << value << "\" value" << std::endl;
+	return kFALSE;
+      }
       fValue[value] = args;
+      fChanged.insert(value);
     }
     
     /** success **/
@@ -195,10 +269,15 @@ namespace o2sim
     /** process file **/
 
     /** open file **/
-    gSystem->ExpandPathName(filename);
-    std::ifstream fin(filename.Data());
+    if (fgRecordFiles) fgRecordFiles->push_back(filename.Data());
+    TString path;
+    if (!ExpandVariables(filename, path)) {
+      LOG(ERROR) << "Cannot expand file name " << filename << std::endl;
+      return kFALSE;
+    }
+    std::ifstream fin(path.Data());
     if (!fin.is_open()) {
-      LOG(ERROR) << "Cannot open file " << filename << std::endl;
+      LOG(ERROR) << "Cannot open file " << path << std::endl;
       return kFALSE;
     }
 
@@ -261,19 +340,48 @@ namespace o2sim
   {
     /** get value **/
 
+    /** compiled values **/
+    if (fCompiled) {
+      auto handle = GetValueHandle(name);
+      if (handle < 0) return kFALSE;
+      auto const &slot = fSlot[handle];
+      if (!slot.numeric || !slot.integral || slot.size != n) return kFALSE;
+      for (Int_t i = 0; i < n; i++) v[i] = slot.ivalue[i];
+      return kTRUE;
+    }
+    
     /** check values **/
     if (!ValidValue(name)) return kFALSE;
     TString str = GetValue(name);
     TObjArray *oa = str.Tokenize(" \t");
-    if (oa->GetEntries() != n) return kFALSE;
-    for (Int_t i = 0; i < n; i++) {
+    Bool_t retval = oa->GetEntries() == n;
+    for (Int_t i = 0; retval && i < n; i++) {
       TObjString *os = (TObjString *)oa->At(i);
       TString val = os->String();
-      if (!val.IsFloat() && !val.IsDigit()) return kFALSE;
-      v[i] = val.Atoi();
+      if (!val.IsFloat() && !val.IsDigit()) retval = kFALSE;
+      else v[i] = val.Atoi();
     }
-    /** success **/
-    return kTRUE;
+    delete oa;
+    return retval;
+  }
+
+  /*****************************************************************/
+
+  Int_t
+  ConfigurationManager::GetValueSize(TString name) const
+  {
+    /** get value size **/
+
+    if (fCompiled) {
+      auto handle = GetValueHandle(name);
+      return handle < 0 ? 0 : fSlot[handle].size;
+    }
+    if (!ValidValue(name)) return 0;
+    TString str = GetValue(name);
+    TObjArray *oa = str.Tokenize(" \t");
+    Int_t n = oa->GetEntries();
+    delete oa;
+    return n;
   }
 
   /*****************************************************************/
@@ -283,21 +391,284 @@ namespace o2sim
   {
     /** get value **/
 
+    /** compiled values **/
+    if (fCompiled) {
+      auto handle = GetValueHandle(name);
+      if (handle < 0) return kFALSE;
+      auto const &slot = fSlot[handle];
+      if (!slot.numeric || slot.size != n) return kFALSE;
+      for (Int_t i = 0; i < n; i++) v[i] = slot.dvalue[i];
+      return kTRUE;
+    }
+    
     /** check values **/
     if (!ValidValue(name)) return kFALSE;
     TString str = GetValue(name);
     TObjArray *oa = str.Tokenize(" \t");
-    if (oa->GetEntries() != n) return kFALSE;
-    for (Int_t i = 0; i < n; i++) {
+    Bool_t retval = oa->GetEntries() == n;
+    for (Int_t i = 0; retval && i < n; i++) {
       TObjString *os = (TObjString *)oa->At(i);
       TString val = os->String();
-      if (!val.IsFloat() && !val.IsDigit()) return kFALSE;
-      v[i] = val.Atof();
+      if (!val.IsFloat() && !val.IsDigit()) retval = kFALSE;
+      else v[i] = val.Atof();
+    }
+    delete oa;
+    return retval;
+  }
+
+  /*****************************************************************/
+
+  void
+  ConfigurationManager::StartRecording(std::vector<std::string> *files)
+  {
+    /** start recording **/
+
+    fgRecordFiles = files;
+  }
+
+  /*****************************************************************/
+
+  void
+  ConfigurationManager::StopRecording()
+  {
+    /** stop recording **/
+
+    fgRecordFiles = nullptr;
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  ConfigurationManager::CreateDelegate(TString name, TString class_name)
+  {
+    /** create delegate, the class lookup loads the delegate library
+	through the rootmap, libraries nobody asks for are never loaded **/
+
+    TClass *delegate_class = nullptr;
+    {
+      Profiler::Timer timer(Profiler::Instance().GetEntry(std::string("startup.load.") + class_name.Data()));
+      delegate_class = TClass::GetClass(class_name, kTRUE);
+    }
+    if (!delegate_class) {
+      LOG(ERROR) << "Cannot find delegate class \"" << class_name << "\", is its library in the rootmap?" << std::endl;
+      return kFALSE;
+    }
+    auto delegate = (ConfigurationManager *)delegate_class->New();
+    if (!delegate) return kFALSE;
+    return RegisterDelegate(name, delegate, delegate_class);
+  }
+
+  /*****************************************************************/
+
+  ConfigurationManager *
+  ConfigurationManager::FindManager(const std::string &path, TString &name)
+  {
+    /** find the manager of a value or a delegate from its
+	full path, name is the last component of the path **/
+
+    auto manager = this;
+    std::string::size_type begin = 0, end;
+    while ((end = path.find('.', begin)) != std::string::npos) {
+      TString delegate_name = path.substr(begin, end - begin);
+      if (!manager->fDelegate.count(delegate_name)) return nullptr;
+      manager = manager->fDelegate.at(delegate_name);
+      begin = end + 1;
+    }
+    name = path.substr(begin);
+    return manager;
+  }
+
+  /*****************************************************************/
+
+  void
+  ConfigurationManager::GetSnapshot(snapshot_t &delegates, snapshot_t &values, TString prefix) const
+  {
+    /** get snapshot, each delegate before its own delegates **/
+
+    for (auto const &name : fChanged)
+      values.emplace_back((prefix + name).Data(), fValue.at(name).Data());
+    for (auto const &x : fDelegate) {
+      delegates.emplace_back((prefix + x.first).Data(), fDelegateClass.at(x.first)->GetName());
+      x.second->GetSnapshot(delegates, values, prefix + x.first + ".");
+    }
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  ConfigurationManager::SetSnapshot(const snapshot_t &delegates, const snapshot_t &values)
+  {
+    /** set snapshot, the delegates are created and the values
+	set directly, without processing any command **/
+
+    if (fCompiled) {
+      LOG(ERROR) << "Configuration is compiled, cannot set snapshot" << std::endl;
+      return kFALSE;
+    }
+    TString name;
+    for (auto const &x : delegates) {
+      auto manager = FindManager(x.first, name);
+      if (!manager || !manager->CreateDelegate(name, x.second)) {
+	LOG(ERROR) << "Cannot create \"" << x.first << "\" delegate from snapshot" << std::endl;
+	return kFALSE;
+      }
+    }
+    for (auto const &x : values) {
+      auto manager = FindManager(x.first, name);
+      if (!manager || !manager->ValidValue(name)) {
+	LOG(ERROR) << "Cannot set \"" << x.first << "\" value from snapshot" << std::endl;
+	return kFALSE;
+      }
+      manager->fValue[name] = x.second;
+      manager->fChanged.insert(name);
     }
+
     /** success **/
     return kTRUE;
   }
 
+  /*****************************************************************/
+
+  Bool_t
+  ConfigurationManager::GetPath(TString name, TString &path) const
+  {
+    /** get path, the value with environment variables expanded **/
+
+    if (fCompiled) {
+      auto handle = GetValueHandle(name);
+      if (handle < 0 || !fSlot[handle].validPath) return kFALSE;
+      path = fSlot[handle].path;
+      return kTRUE;
+    }
+    if (!ValidValue(name)) return kFALSE;
+    return ExpandVariables(GetValue(name), path);
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  ConfigurationManager::Compile()
+  {
+    /** compile **/
+
+    /** values **/
+    fSlot.clear();
+    fSlotHandle.clear();
+    for (auto const &x : fValue) {
+      value_slot_t slot;
+      slot.value = x.second;
+      slot.validPath = ExpandVariables(x.second, slot.path);
+      /** tokenize and parse numbers **/
+      std::istringstream stream(x.second.Data());
+      slot.numeric = kTRUE;
+      slot.integral = kTRUE;
+      for (std::string token; stream >> token; slot.size++) {
+	Double_t dval = 0.;
+	Int_t ival = 0;
+	Bool_t integral = kFALSE;
+	if (!ParseNumber(token, dval, ival, integral)) slot.numeric = kFALSE;
+	if (!integral) slot.integral = kFALSE;
+	slot.dvalue.push_back(dval);
+	slot.ivalue.push_back(ival);
+      }
+      if (!slot.numeric) {
+	slot.integral = kFALSE;
+	slot.dvalue.clear();
+	slot.ivalue.clear();
+      }
+      fSlotHandle[x.first] = fSlot.size();
+      fSlot.push_back(slot);
+    }
+
+    /** delegates **/
+    for (auto const &x : fDelegate)
+      if (!x.second->Compile()) return kFALSE;
+
+    /** success **/
+    fCompiled = kTRUE;
+    return kTRUE;
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  ConfigurationManager::ParseNumber(const std::string &token, Double_t &dvalue, Int_t &ivalue, Bool_t &integral)
+  {
+    /** parse a decimal number, as [+-]digits[.digits][(e|E)[+-]digits].
+	hexadecimal, inf and nan are refused, and so are values out of
+	the double range. integral tells if the value, truncated as
+	by Atoi, fits in an integer **/
+
+    dvalue = 0.;
+    ivalue = 0;
+    integral = kFALSE;
+    size_t i = 0, n = token.size();
+    auto digits = [&token, &i, n]() {
+      size_t begin = i;
+      while (i < n && isdigit((UChar_t)token[i])) i++;
+      return i - begin;
+    };
+    if (i < n && (token[i] == '+' || token[i] == '-')) i++;
+    auto mantissa = digits();
+    if (i < n && token[i] == '.') {
+      i++;
+      mantissa += digits();
+    }
+    if (mantissa == 0) return kFALSE;
+    if (i < n && (token[i] == 'e' || token[i] == 'E')) {
+      i++;
+      if (i < n && (token[i] == '+' || token[i] == '-')) i++;
+      if (digits() == 0) return kFALSE;
+    }
+    if (i != n) return kFALSE;
+
+    /** the format is checked, strtod only converts **/
+    errno = 0;
+    dvalue = std::strtod(token.c_str(), nullptr);
+    if (errno == ERANGE && std::fabs(dvalue) > 1.) return kFALSE;
+    integral = dvalue > (Double_t)INT_MIN - 1. && dvalue < (Double_t)INT_MAX + 1.;
+    if (integral) ivalue = (Int_t)dvalue;
+    return kTRUE;
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  ConfigurationManager::ExpandVariables(TString value, TString &path)
+  {
+    /** expand environment variables, $VAR, ${VAR} and $(VAR), and
+	a leading ~, without going through the shell **/
+
+    path = "";
+    Bool_t retval = kTRUE;
+    for (Int_t i = 0; i < value.Length(); i++) {
+      /** home directory **/
+      if (i == 0 && value[i] == '~' && (value.Length() == 1 || value[1] == '/')) {
+	auto home = getenv("HOME");
+	if (!home) retval = kFALSE;
+	else path += home;
+	continue;
+      }
+      if (value[i] != '$') {
+	path += value[i];
+	continue;
+      }
+      /** variable name **/
+      char close = '\0';
+      if (i + 1 < value.Length() && value[i + 1] == '{') close = '}';
+      if (i + 1 < value.Length() && value[i + 1] == '(') close = ')';
+      Int_t begin = close ? i + 2 : i + 1, end = begin;
+      while (end < value.Length() && (isalnum(value[end]) || value[end] == '_')) end++;
+      if (close && (end >= value.Length() || value[end] != close)) retval = kFALSE;
+      TString var = value(begin, end - begin);
+      auto env = var.IsNull() ? nullptr : getenv(var.Data());
+      if (!env) retval = kFALSE;
+      else path += env;
+      i = close ? end : end - 1;
+    }
+    return retval;
+  }
+  
   /*****************************************************************/
   /*****************************************************************/
 
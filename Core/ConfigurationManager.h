@@ -17,6 +17,10 @@
 #include "TString.h"
 #include "FairLogger.h"
 #include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
 #include <iostream>
 #include "TClass.h"
 
@@ -36,11 +40,43 @@ namespace o2sim {
     typedef std::map<TString, value_t> value_map_t;
     typedef std::map<TString, delegate_t *> delegate_map_t;
 
+    /** compiled value, parsed once into typed slots **/
+    struct value_slot_t {
+      value_t value;                 // raw value
+      TString path;                  // value with environment variables expanded
+      Bool_t validPath = kFALSE;     // all environment variables were found
+      Int_t size = 0;                // number of tokens
+      Bool_t numeric = kFALSE;       // all tokens are decimal numbers
+      Bool_t integral = kFALSE;      // all tokens fit in an integer
+      std::vector<Int_t> ivalue;     // tokens as integers
+      std::vector<Double_t> dvalue;  // tokens as doubles
+    };
+
     /** default constructor/destructor **/
     ConfigurationManager();
 
     /** methods **/
     Bool_t IsActive() const {return IsValue("status", "active") || IsValue("status", "on");};
+
+    /** compile the values of this manager and its delegates into an
+	immutable snapshot, later value changes are refused **/
+    Bool_t Compile();
+    Bool_t IsCompiled() const {return fCompiled;};
+
+    /** record the included files while processing, to cache them **/
+    static void StartRecording(std::vector<std::string> *files);
+    static void StopRecording();
+
+    /** snapshot of the delegates, with their full path and class,
+	and of the values changed by commands. it is set back without
+	processing commands, the defaults come from the delegates **/
+    typedef std::vector<std::pair<std::string, std::string>> snapshot_t;
+    void GetSnapshot(snapshot_t &delegates, snapshot_t &values, TString prefix = "") const;
+    Bool_t SetSnapshot(const snapshot_t &delegates, const snapshot_t &values);
+
+    /** make the relative file paths of this manager and its
+	delegates absolute with respect to the given directory **/
+    Bool_t MakePathsAbsolute(TString directory);
     
   protected:
 
@@ -57,11 +93,14 @@ namespace o2sim {
     void PrintStatus(TString prepend = "") const;
 
     Bool_t RegisterValue(TString name, value_t value = "");
+    Bool_t RegisterPath(TString name, value_t value = "");
 
     Bool_t ValidValue(TString name) const {return fValue.count(name) == 1;};
-    value_t GetValue(TString name) const {return fValue.at(name);};
+    value_t GetValue(TString name) const {return fCompiled ? fSlot[fSlotHandle.at(name)].value : fValue.at(name);};
+    Int_t GetValueSize(TString name) const;
     Bool_t GetValue(TString name, Double_t *v, Int_t n) const;
     Bool_t GetValue(TString name, Int_t *v, Int_t n) const;
+    Bool_t GetPath(TString name, TString &path) const;
     Bool_t GetValue(TString name, Int_t &v) const {return GetValue(name, &v, 1);};
     Bool_t GetValue(TString name, Double_t &v) const {return GetValue(name, &v, 1);};
     Bool_t IsValue(TString name, TString value, TString::ECaseCompare cmp = TString::kIgnoreCase) const {return GetValue(name).EqualTo(value, cmp);};
@@ -75,13 +114,30 @@ namespace o2sim {
     
     virtual void NotifyUpdate(TString value, TString args) {};
 
+    /** expand environment variables, as in GetPath **/
+    static Bool_t ExpandVariables(TString value, TString &path);
+
   private:
 
     value_map_t fValue;
+    std::set<TString> fPath;                     //!
     delegate_map_t fDelegate;
     std::map<TString, TClass *> fDelegateClass;
+    std::set<TString> fChanged;                  //! values changed by commands
+
+    /** compiled snapshot, values are only looked up
+	by name while initialising, never per event **/
+    Bool_t fCompiled;                            //!
+    std::vector<value_slot_t> fSlot;             //!
+    std::map<TString, Int_t> fSlotHandle;        //!
+    Int_t GetValueHandle(TString name) const {return fSlotHandle.count(name) ? fSlotHandle.at(name) : -1;};
+    
+    Bool_t CreateDelegate(TString name, TString class_name);
+    ConfigurationManager *FindManager(const std::string &path, TString &name);
     
     static TString fgPrependCommand;
+    static std::vector<std::string> *fgRecordFiles;
+    static Bool_t ParseNumber(const std::string &token, Double_t &dvalue, Int_t &ivalue, Bool_t &integral);
     
     ClassDefOverride(ConfigurationManager, 1)
       
@@ -11,6 +11,10 @@
 /// \author R+Preghenella - August 2017
 
 #include "GeneratorManagerDelegate.h"
+#include "TriggerManagerDelegate.h"
+#include "Trigger/Trigger.h"
+#include <cstdlib>
+#include <cerrno>
 
 namespace o2sim
 {
@@ -19,7 +23,9 @@ namespace o2sim
   /*****************************************************************/
 
   GeneratorManagerDelegate::GeneratorManagerDelegate() :
-    ConfigurationManager()
+    ConfigurationManager(),
+    fWorker(0),
+    fNWorkers(1)
   {
     /** deafult constructor **/
 
@@ -29,8 +35,10 @@ namespace o2sim
     RegisterValue("target_P");
     RegisterValue("target_AZ");
     RegisterValue("trigger_mode");
+    RegisterValue("trigger_expression");
     RegisterValue("nevents", "1");
-    RegisterValue("decay_table", "$O2SIM_ROOT/data/decaytable.dat");
+    RegisterPath("decay_table", "$O2SIM_ROOT/data/decaytable.dat");
+    RegisterValue("seed", "0");
 
   }
 
@@ -155,6 +163,63 @@ namespace o2sim
     
   }
 
+  /*****************************************************************/
+
+  Bool_t
+  GeneratorManagerDelegate::GetSeed(UInt_t &seed) const
+  {
+    /** get seed **/
+
+    TString value = GetValue("seed");
+    char *end = nullptr;
+    errno = 0;
+    auto val = std::strtoull(value.Data(), &end, 10);
+    if (!value.IsDigit() || value.IsNull() || *end != '\0' || errno == ERANGE || val > kMaxUInt) {
+      LOG(ERROR) << "Invalid random seed: " << value << std::endl;
+      return kFALSE;
+    }
+    /** success **/
+    seed = val;
+    return kTRUE;
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  GeneratorManagerDelegate::InitTrigger(std::vector<o2::eventgen::Trigger *> &triggers, UInt_t seed) const
+  {
+    /** init trigger, the triggers draw from their own
+	random generators seeded after the generator seed **/
+
+    /** check trigger mode, a trigger expression combines the triggers by itself **/
+    triggers.clear();
+    if (IsNull("trigger_expression")) {
+      if (IsNull("trigger_mode") || IsValue("trigger_mode", "OFF")) return kTRUE;
+      if (!IsValue("trigger_mode", "OR") && !IsValue("trigger_mode", "AND")) {
+	LOG(ERROR) << "Invalid trigger_mode: " << GetValue("trigger_mode") << std::endl;
+	return kFALSE;
+      }
+    }
+    
+    /** loop over all delegates **/
+    for (auto const &x : DelegateMap()) {
+      auto delegate = dynamic_cast<TriggerManagerDelegate *>(x.second);
+      if (!delegate || !delegate->IsActive()) continue;
+      LOG(INFO) << "Initialising \"" << x.first << "\" manager (" << GetDelegateClassName(x.first) << ")" << std::endl;
+      auto trigger = delegate->Init();      
+      if (!trigger) {
+	LOG(ERROR) << "Failed initialising \"" << x.first << "\" manager" << std::endl;
+	return kFALSE;
+      }
+      trigger->SetName(x.first);
+      trigger->SetSeed(seed + triggers.size());
+      triggers.push_back(trigger);
+    }
+
+    /** success **/
+    return kTRUE;
+  }
+
   /*****************************************************************/
   /*****************************************************************/
   
@@ -15,10 +15,16 @@
 
 #include "Core/ConfigurationManager.h"
 #include "TLorentzVector.h"
+#include <vector>
 
 class FairGenerator;
 class TLorentzVector;
 
+namespace o2 {
+namespace eventgen {
+  class Trigger;
+}}
+
 namespace o2sim {
 
   /*****************************************************************/
@@ -36,6 +42,13 @@ namespace o2sim {
     virtual FairGenerator *Init() const = 0;
     virtual Bool_t Terminate() const = 0;
 
+    /** ROOT objects are read by threads of the generator **/
+    virtual Bool_t UsesThreads() const {return kFALSE;};
+
+    /** worker among the forked workers, delegates reading
+	an input take their own slice of it **/
+    void SetWorker(Int_t worker, Int_t nworkers) {fWorker = worker; fNWorkers = nworkers;};
+
   protected:
 
     Bool_t GetBeamP(TString beam, Double_t &p) const;
@@ -47,6 +60,14 @@ namespace o2sim {
     Bool_t GetCMSRapidity(Double_t &y) const;
 
     Bool_t GetNumberOfEvents(Int_t &n) const;
+    Bool_t GetSeed(UInt_t &seed) const;
+
+    /** init the triggers of the active trigger delegates, none
+	when the trigger is off. the generator combines them **/
+    Bool_t InitTrigger(std::vector<o2::eventgen::Trigger *> &triggers, UInt_t seed) const;
+
+    Int_t fWorker;    //!
+    Int_t fNWorkers;  //!
     
   private:
 
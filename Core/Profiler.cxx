@@ -0,0 +1,166 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See https://alice-o2.web.cern.ch/ for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \author R+Preghenella - September 2017
+
+#include "Profiler.h"
+#include "FairLogger.h"
+#include "TFile.h"
+#include "TTree.h"
+#include <fstream>
+#include <iomanip>
+
+namespace o2sim
+{
+
+  /*****************************************************************/
+  /*****************************************************************/
+
+  Bool_t Profiler::fgEnabled = kFALSE;
+  Bool_t Profiler::fgStartupEnabled = kFALSE;
+  
+  /*****************************************************************/
+
+  Profiler::Profiler() :
+    fEntries(),
+    fMutex(),
+    fFileName("o2sim.profile.json")
+  {
+    /** default constructor **/
+
+  }
+
+  /*****************************************************************/
+
+  Profiler &
+  Profiler::Instance()
+  {
+    /** instance **/
+
+    static Profiler instance;
+    return instance;
+  }
+  
+  /*****************************************************************/
+
+  Profiler::Entry *
+  Profiler::GetEntry(const std::string &name)
+  {
+    /** get entry, created if not there **/
+
+    if (!fgEnabled && !(fgStartupEnabled && (name.compare(0, 8, "startup.") == 0 || name.compare(0, 5, "init.") == 0)))
+      return nullptr;
+    std::lock_guard<std::mutex> lock(fMutex);
+    return &fEntries[name];
+  }
+  
+  /*****************************************************************/
+
+  void
+  Profiler::Print(const std::string &prefix) const
+  {
+    /** print, only the entries starting with prefix **/
+
+    std::lock_guard<std::mutex> lock(fMutex);
+    if (prefix.empty()) LOG(INFO) << "Profiling summary:" << std::endl;
+    else LOG(INFO) << "Profiling summary of \"" << prefix << "*\":" << std::endl;
+    for (auto const &x : fEntries) {
+      if (x.first.compare(0, prefix.size(), prefix) != 0) continue;
+      auto count = x.second.GetCount();
+      auto time = x.second.GetTime();
+      LOG(INFO) << std::setw(48) << std::left << x.first
+		<< " count = " << count
+		<< " | time = " << time << " s"
+		<< " | time/count = " << (count > 0 ? time / count : 0.) << " s"
+		<< std::endl;
+    }
+  }
+  
+  /*****************************************************************/
+
+  Bool_t
+  Profiler::Dump() const
+  {
+    /** dump, the format follows the file extension **/
+
+    auto n = fFileName.size();
+    if (n > 5 && fFileName.compare(n - 5, 5, ".root") == 0) return DumpROOT();
+    return DumpJSON();
+  }
+  
+  /*****************************************************************/
+
+  Bool_t
+  Profiler::DumpJSON() const
+  {
+    /** dump JSON **/
+
+    std::ofstream fout(fFileName);
+    if (!fout.is_open()) {
+      LOG(ERROR) << "Cannot open profiling output file: " << fFileName << std::endl;
+      return kFALSE;
+    }
+    
+    std::lock_guard<std::mutex> lock(fMutex);
+    fout << "{" << std::endl;
+    auto n = fEntries.size();
+    for (auto const &x : fEntries) {
+      fout << "  \"" << x.first << "\": {"
+	   << "\"count\": " << x.second.GetCount() << ", "
+	   << "\"time\": " << std::setprecision(9) << x.second.GetTime() << "}"
+	   << (--n > 0 ? "," : "") << std::endl;
+    }
+    fout << "}" << std::endl;
+    fout.close();
+    
+    LOG(INFO) << "Profiling summary written to " << fFileName << std::endl;
+    return kTRUE;
+  }
+  
+  /*****************************************************************/
+
+  Bool_t
+  Profiler::DumpROOT() const
+  {
+    /** dump ROOT, one tree entry per profiling entry **/
+
+    auto fout = TFile::Open(fFileName.c_str(), "RECREATE");
+    if (!fout || !fout->IsOpen()) {
+      LOG(ERROR) << "Cannot open profiling output file: " << fFileName << std::endl;
+      return kFALSE;
+    }
+    
+    std::string name;
+    Long64_t count;
+    Double_t time;
+    auto tree = new TTree("profile", "o2sim profiling summary");
+    tree->Branch("name", &name);
+    tree->Branch("count", &count, "count/L");
+    tree->Branch("time", &time, "time/D");
+    
+    std::lock_guard<std::mutex> lock(fMutex);
+    for (auto const &x : fEntries) {
+      name = x.first;
+      count = x.second.GetCount();
+      time = x.second.GetTime();
+      tree->Fill();
+    }
+    tree->Write();
+    fout->Close();
+    delete fout;
+    
+    LOG(INFO) << "Profiling summary written to " << fFileName << std::endl;
+    return kTRUE;
+  }
+  
+  /*****************************************************************/
+  /*****************************************************************/
+
+} /** namespace o2sim **/
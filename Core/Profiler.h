@@ -0,0 +1,113 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See https://alice-o2.web.cern.ch/ for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \author R+Preghenella - September 2017
+
+#ifndef ALICEO2SIM_PROFILER_H_
+#define ALICEO2SIM_PROFILER_H_
+
+#include "Rtypes.h"
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace o2sim {
+
+  /*****************************************************************/
+  /*****************************************************************/
+
+  /** registry of named timers and counters, enabled by the
+      "simulation.profiling" value. the ro2sim --startup-profile
+      option enables only the "startup." and "init." entries, from
+      the very start until the end of init. entries are looked up once
+      and updated through their pointer, which is null when the
+      profiling is off so that the instrumented code only pays
+      for a pointer check **/
+  
+  class Profiler
+  {
+
+  public:
+
+    /** accumulated calls and elapsed time, thread safe **/
+    class Entry
+    {
+    public:
+      Entry() : fCount(0), fTime(0) {};
+      void Add(Long64_t count) {fCount += count;};
+      void Add(Long64_t count, Long64_t nanoseconds) {fCount += count; fTime += nanoseconds;};
+      void Add(Long64_t count, Double_t seconds) {Add(count, (Long64_t)(seconds * 1.e9));};
+      Long64_t GetCount() const {return fCount;};
+      Double_t GetTime() const {return fTime * 1.e-9;};
+    private:
+      std::atomic<Long64_t> fCount;
+      std::atomic<Long64_t> fTime;  // [ns]
+    };
+
+    /** scoped timer, does nothing without an entry **/
+    class Timer
+    {
+    public:
+      Timer(Entry *entry) : fEntry(entry), fStart(entry ? Now() : 0) {};
+      ~Timer() {if (fEntry) fEntry->Add(1, Now() - fStart);};
+    private:
+      Entry *fEntry;
+      Long64_t fStart;
+    };
+    
+    /** instance **/
+    static Profiler &Instance();
+
+    /** getters **/
+    static Bool_t IsEnabled() {return fgEnabled;};
+    static Bool_t IsStartupEnabled() {return fgStartupEnabled;};
+    static Long64_t Now() {return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();};
+    Entry *GetEntry(const std::string &name);
+    
+    /** setters **/
+    static void SetEnabled(Bool_t val) {fgEnabled = val;};
+    static void SetStartupEnabled(Bool_t val) {fgStartupEnabled = val;};
+    void SetFileName(const std::string &val) {fFileName = val;};
+
+    /** methods **/
+    void Print(const std::string &prefix = "") const;
+    Bool_t Dump() const;
+    
+  private:
+
+    /** default constructor **/
+    Profiler();
+    /** copy constructor **/
+    Profiler(const Profiler &);
+    /** operator= **/
+    Profiler &operator=(const Profiler &);
+    
+    /** methods **/
+    Bool_t DumpJSON() const;
+    Bool_t DumpROOT() const;
+    
+    /** data members **/
+    std::map<std::string, Entry> fEntries;  // node addresses are stable
+    mutable std::mutex fMutex;
+    std::string fFileName;
+
+    static Bool_t fgEnabled;
+    static Bool_t fgStartupEnabled;
+    
+  }; /** class Profiler **/
+
+  /*****************************************************************/
+  /*****************************************************************/
+
+} /** namespace o2sim **/
+
+#endif /* ALICEO2SIM_PROFILER_H_ */
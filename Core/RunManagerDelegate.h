@@ -15,6 +15,8 @@
 
 #include "Core/ConfigurationManager.h"
 
+class TDirectory;
+
 namespace o2sim {
 
   /*****************************************************************/
@@ -32,6 +34,30 @@ namespace o2sim {
     virtual Bool_t Init() const = 0;
     virtual Bool_t Terminate() const = 0;
 
+    /** delegates only needed for transport are skipped in
+	the generator-only mode **/
+    virtual Bool_t IsTransportOnly() const {return kFALSE;};
+
+    /** generator events per transport event, set by the run
+	manager from "simulation.batch" and not configurable **/
+    virtual void SetBatchSize(Int_t val) {};
+
+    /** checkpoints are written, set by the run manager from
+	"simulation.checkpoint" before the delegates are initialised **/
+    virtual void SetCheckpointing(Bool_t val) {};
+
+    /** ROOT objects are read by other threads, the ROOT thread
+	safety is enabled only if a delegate does **/
+    virtual Bool_t UsesThreads() const {return kFALSE;};
+
+    /** worker among the forked workers, set by the run manager **/
+    virtual void SetWorker(Int_t worker, Int_t nworkers) {};
+
+    /** checkpoint methods, delegates with a run-time state
+	save and load it in their own directory **/
+    virtual Bool_t SaveState(TDirectory *dir) const {return kTRUE;};
+    virtual Bool_t LoadState(TDirectory *dir) const {return kTRUE;};
+
   protected:
 
     ClassDefOverride(RunManagerDelegate, 1)
@@ -0,0 +1,181 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See https://alice-o2.web.cern.ch/ for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \author R+Preghenella - September 2017
+
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include "Core/ConfigurationManager.h"
+
+/** configuration manager test, expansion of environment
+    variables, typed values of the compiled configuration
+    and the snapshot of the configuration cache **/
+
+using o2sim::ConfigurationManager;
+
+/** manager with values of each kind, the protected
+    methods are made public for the test **/
+class TestManager : public ConfigurationManager
+{
+public:
+  TestManager() : ConfigurationManager() {
+    RegisterValue("count", "3");
+    RegisterValue("xyz", "1. 2 30.");
+    RegisterValue("exponent", "3e1");
+    RegisterValue("big", "3e9");
+    RegisterValue("word", "on");
+    RegisterValue("hex", "0x10");
+    RegisterPath("file", "$O2SIM_TEST_DIR/file.txt");
+    RegisterPath("unset", "$O2SIM_TEST_UNSET/file.txt");
+  };
+  using ConfigurationManager::ProcessCommand;
+  using ConfigurationManager::RegisterDelegate;
+  using ConfigurationManager::GetValue;
+  using ConfigurationManager::GetValueSize;
+  using ConfigurationManager::GetPath;
+  using ConfigurationManager::IsValue;
+  using ConfigurationManager::ExpandVariables;
+};
+
+Int_t gFailures = 0;
+
+/*****************************************************************/
+
+void
+check(Bool_t condition, const std::string &what)
+{
+  /** check **/
+
+  if (condition) return;
+  std::cout << "FAILED: " << what << std::endl;
+  gFailures++;
+}
+
+/*****************************************************************/
+
+void
+checkExpand(const TString &value, Bool_t retval, const TString &expected = "")
+{
+  /** check the expansion of a value **/
+
+  TString path;
+  auto what = std::string("expand \"") + value.Data() + "\"";
+  check(TestManager::ExpandVariables(value, path) == retval, what);
+  if (retval) check(path == expected, what + ": \"" + path.Data() + "\"");
+}
+
+/*****************************************************************/
+
+void
+checkValues(TestManager &manager, const std::string &what)
+{
+  /** check the typed values, the same compiled or not **/
+
+  Int_t ivalue = 0, ixyz[3] = {0, 0, 0};
+  Double_t dvalue = 0., dxyz[3] = {0., 0., 0.};
+  check(manager.GetValue("count", ivalue) && ivalue == 3, what + ": integer value");
+  check(manager.GetValue("count", dvalue) && dvalue == 3., what + ": integer value as double");
+  check(manager.GetValue("xyz", dxyz, 3) && dxyz[0] == 1. && dxyz[1] == 2. && dxyz[2] == 30., what + ": double array");
+  check(manager.GetValue("xyz", ixyz, 3) && ixyz[0] == 1 && ixyz[1] == 2 && ixyz[2] == 30, what + ": integer array");
+  check(!manager.GetValue("xyz", dxyz, 2), what + ": array size mismatch");
+  check(manager.GetValueSize("xyz") == 3 && manager.GetValueSize("word") == 1, what + ": value sizes");
+  check(manager.GetValue("big", dvalue) && dvalue == 3.e9, what + ": double beyond the integer range");
+  check(!manager.GetValue("word", ivalue) && !manager.GetValue("word", dvalue), what + ": word is not a number");
+  check(manager.IsValue("word", "ON"), what + ": case insensitive comparison");
+  check(!manager.GetValue("missing", ivalue), what + ": missing value");
+  TString path;
+  check(manager.GetPath("file", path) && path == "/o2sim/test/file.txt", what + ": path");
+  check(!manager.GetPath("unset", path), what + ": path with an unset variable");
+}
+
+/*****************************************************************/
+
+int
+main (Int_t argc, char **argv)
+{
+
+  setenv("O2SIM_TEST_DIR", "/o2sim/test", 1);
+  setenv("O2SIM_TEST_NAME", "name", 1);
+  unsetenv("O2SIM_TEST_UNSET");
+  TString home = getenv("HOME") ? getenv("HOME") : "";
+
+  /** variable expansion **/
+  checkExpand("plain/file.txt", kTRUE, "plain/file.txt");
+  checkExpand("$O2SIM_TEST_DIR/file.txt", kTRUE, "/o2sim/test/file.txt");
+  checkExpand("${O2SIM_TEST_DIR}/file.txt", kTRUE, "/o2sim/test/file.txt");
+  checkExpand("$(O2SIM_TEST_DIR)/file.txt", kTRUE, "/o2sim/test/file.txt");
+  checkExpand("${O2SIM_TEST_DIR}suffix", kTRUE, "/o2sim/testsuffix");
+  checkExpand("$O2SIM_TEST_DIR/$O2SIM_TEST_NAME.txt", kTRUE, "/o2sim/test/name.txt");
+  checkExpand("$O2SIM_TEST_DIR$O2SIM_TEST_NAME", kTRUE, "/o2sim/testname");
+  checkExpand("${O2SIM_TEST_DIR", kFALSE);
+  checkExpand("$(O2SIM_TEST_DIR}", kFALSE);
+  checkExpand("$O2SIM_TEST_UNSET/file.txt", kFALSE);
+  checkExpand("${}/file.txt", kFALSE);
+  checkExpand("$", kFALSE);
+  if (!home.IsNull()) {
+    checkExpand("~", kTRUE, home);
+    checkExpand("~/file.txt", kTRUE, home + "/file.txt");
+  }
+  checkExpand("~user/file.txt", kTRUE, "~user/file.txt");
+  checkExpand("dir/~/file.txt", kTRUE, "dir/~/file.txt");
+
+  /** values before and after compilation **/
+  TestManager manager;
+  check(!manager.IsCompiled(), "not compiled");
+  checkValues(manager, "not compiled");
+  check(manager.Compile() && manager.IsCompiled(), "compile");
+  checkValues(manager, "compiled");
+
+  /** numbers are decimal in the compiled snapshot **/
+  Int_t ivalue = 0;
+  check(!manager.GetValue("hex", ivalue), "hexadecimal is not a number");
+  check(manager.GetValue("exponent", ivalue) && ivalue == 30, "integer with an exponent");
+
+  /** values cannot change once compiled **/
+  check(!manager.ProcessCommand("count 5"), "refuse changes once compiled");
+  check(manager.GetValue("count", ivalue) && ivalue == 3, "value unchanged once compiled");
+
+  /** delegates are compiled with their manager **/
+  TestManager parent;
+  auto delegate = new TestManager();
+  check(parent.RegisterDelegate("sub", delegate, ConfigurationManager::Class()), "register delegate");
+  check(parent.ProcessCommand("sub.count 7"), "forward to delegate");
+  check(parent.Compile() && delegate->IsCompiled(), "compile delegate");
+  check(delegate->GetValue("count", ivalue) && ivalue == 7, "compiled delegate value");
+  check(!parent.ProcessCommand("sub.count 8"), "refuse delegate changes once compiled");
+
+  /** the snapshot holds the delegates and the changed values **/
+  {
+    TestManager source;
+    check(source.ProcessCommand("count 5") && source.ProcessCommand("count 6"), "change value");
+    check(source.RegisterDelegate("sub", new ConfigurationManager(), ConfigurationManager::Class()), "register snapshot delegate");
+    check(source.ProcessCommand("sub.status off"), "change delegate value");
+    ConfigurationManager::snapshot_t delegates, values;
+    source.GetSnapshot(delegates, values);
+    check(delegates.size() == 1 && delegates[0].first == "sub" && delegates[0].second == "o2sim::ConfigurationManager", "snapshot delegates");
+    check(values.size() == 2, "snapshot holds only the changed values");
+    TestManager target;
+    check(target.SetSnapshot(delegates, values), "set snapshot");
+    check(target.GetValue("count", ivalue) && ivalue == 6, "snapshot value");
+    check(target.IsValue("word", "on"), "default value kept");
+    check(target.ProcessCommand("sub.status on"), "snapshot delegate created");
+    ConfigurationManager::snapshot_t bad = {{"missing", "1"}};
+    check(!TestManager().SetSnapshot({}, bad), "refuse unknown snapshot value");
+  }
+
+  /** summary **/
+  if (gFailures > 0) {
+    std::cout << "testConfigurationManager: " << gFailures << " failures" << std::endl;
+    return 1;
+  }
+  std::cout << "testConfigurationManager: success" << std::endl;
+  return 0;
+}
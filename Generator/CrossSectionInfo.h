@@ -56,6 +56,7 @@ namespace eventgen
     
     /** statics **/
     static std::string KeyName() {return "cross-section";};
+    static constexpr Int_t kTypeId = kCrossSectionInfo;
     
   protected:
     
@@ -0,0 +1,348 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See https://alice-o2.web.cern.ch/ for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \author R+Preghenella - September 2017
+
+#include "DecompressionBuffer.h"
+#include "FairLogger.h"
+#ifdef O2SIM_WITH_ZLIB
+#include <zlib.h>
+#endif
+#ifdef O2SIM_WITH_ZSTD
+#include <zstd.h>
+#endif
+#ifdef O2SIM_WITH_LZMA
+#include <lzma.h>
+#endif
+#include <sys/stat.h>
+#include <cerrno>
+#include <cstring>
+
+namespace o2
+{
+namespace eventgen
+{
+
+  /*****************************************************************/
+  /*****************************************************************/
+
+  struct DecompressionBuffer::Decoder_t {
+#ifdef O2SIM_WITH_ZLIB
+    z_stream zlib;
+#endif
+#ifdef O2SIM_WITH_ZSTD
+    ZSTD_DStream *zstd = nullptr;
+#endif
+#ifdef O2SIM_WITH_LZMA
+    lzma_stream lzma = LZMA_STREAM_INIT;
+#endif
+  };
+
+  /*****************************************************************/
+  /*****************************************************************/
+
+  DecompressionBuffer::DecompressionBuffer() :
+    std::streambuf(),
+    fFile(NULL),
+    fCompression(kCompressionNone),
+    fDecoder(NULL),
+    fInput(),
+    fOutput(),
+    fInputPosition(0),
+    fInputSize(0),
+    fInputEnd(kFALSE),
+    fStreamEnd(kFALSE),
+    fBytesIn(0),
+    fBytesOut(0)
+  {
+    /** default constructor **/
+
+  }
+
+  /*****************************************************************/
+
+  DecompressionBuffer::~DecompressionBuffer()
+  {
+    /** default destructor **/
+
+    Close();
+  }
+
+  /*****************************************************************/
+
+  DecompressionBuffer::ECompression_t
+  DecompressionBuffer::Detect(const std::string &filename)
+  {
+    /** detect compression from the magic bytes, only regular
+	files are looked at to leave fifos untouched **/
+
+    struct stat info;
+    if (stat(filename.c_str(), &info) != 0 || !S_ISREG(info.st_mode)) return kCompressionNone;
+    unsigned char magic[6] = {0};
+    auto file = std::fopen(filename.c_str(), "rb");
+    if (!file) return kCompressionNone;
+    auto n = std::fread(magic, 1, sizeof(magic), file);
+    std::fclose(file);
+    if (n >= 2 && magic[0] == 0x1f && magic[1] == 0x8b)
+      return kCompressionGzip;
+    if (n >= 4 && magic[0] == 0x28 && magic[1] == 0xb5 && magic[2] == 0x2f && magic[3] == 0xfd)
+      return kCompressionZstd;
+    if (n >= 6 && std::memcmp(magic, "\xfd" "7zXZ\0", 6) == 0)
+      return kCompressionXz;
+    return kCompressionNone;
+  }
+
+  /*****************************************************************/
+
+  const Char_t *
+  DecompressionBuffer::GetCompressionName(ECompression_t compression)
+  {
+    /** get compression name **/
+
+    switch (compression) {
+    case kCompressionGzip: return "gzip";
+    case kCompressionZstd: return "zstd";
+    case kCompressionXz: return "xz";
+    default: return "none";
+    }
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  DecompressionBuffer::Open(const std::string &filename)
+  {
+    /** open **/
+
+    Close();
+    fCompression = Detect(filename);
+    fFile = std::fopen(filename.c_str(), "rb");
+    if (!fFile) {
+      LOG(ERROR) << "Cannot open input file " << filename << ": " << strerror(errno) << std::endl;
+      return kFALSE;
+    }
+
+    /** setup decoder **/
+    fDecoder = new Decoder_t;
+    Bool_t retval = kTRUE;
+    switch (fCompression) {
+#ifdef O2SIM_WITH_ZLIB
+    case kCompressionGzip:
+      std::memset(&fDecoder->zlib, 0, sizeof(z_stream));
+      /** automatic gzip/zlib header detection **/
+      retval = inflateInit2(&fDecoder->zlib, 15 + 32) == Z_OK;
+      break;
+#endif
+#ifdef O2SIM_WITH_ZSTD
+    case kCompressionZstd:
+      fDecoder->zstd = ZSTD_createDStream();
+      retval = fDecoder->zstd && !ZSTD_isError(ZSTD_initDStream(fDecoder->zstd));
+      break;
+#endif
+#ifdef O2SIM_WITH_LZMA
+    case kCompressionXz:
+      retval = lzma_stream_decoder(&fDecoder->lzma, UINT64_MAX, LZMA_CONCATENATED) == LZMA_OK;
+      break;
+#endif
+    case kCompressionNone:
+      break;
+    default:
+      /** the decoder library was not found at build time **/
+      LOG(ERROR) << "Cannot read " << GetCompressionName(fCompression) << " input file " << filename << ": built without " << GetCompressionName(fCompression) << " support" << std::endl;
+      Close();
+      return kFALSE;
+    }
+    if (!retval) {
+      LOG(ERROR) << "Cannot setup " << GetCompressionName(fCompression) << " decoder for input file " << filename << std::endl;
+      Close();
+      return kFALSE;
+    }
+
+    /** buffers, the uncompressed input is read straight into the output **/
+    if (fCompression != kCompressionNone) fInput.resize(fgBufferSize);
+    fOutput.resize(fgBufferSize);
+    setg(fOutput.data(), fOutput.data(), fOutput.data());
+
+    /** success **/
+    return kTRUE;
+  }
+
+  /*****************************************************************/
+
+  void
+  DecompressionBuffer::Close()
+  {
+    /** close **/
+
+    if (fDecoder) {
+      switch (fCompression) {
+#ifdef O2SIM_WITH_ZLIB
+      case kCompressionGzip: inflateEnd(&fDecoder->zlib); break;
+#endif
+#ifdef O2SIM_WITH_ZSTD
+      case kCompressionZstd: ZSTD_freeDStream(fDecoder->zstd); break;
+#endif
+#ifdef O2SIM_WITH_LZMA
+      case kCompressionXz: lzma_end(&fDecoder->lzma); break;
+#endif
+      default: break;
+      }
+      delete fDecoder;
+      fDecoder = NULL;
+    }
+    if (fFile) {
+      std::fclose(fFile);
+      fFile = NULL;
+    }
+    fInputPosition = fInputSize = 0;
+    fInputEnd = fStreamEnd = kFALSE;
+    fBytesIn = fBytesOut = 0;
+    setg(NULL, NULL, NULL);
+  }
+
+  /*****************************************************************/
+
+  DecompressionBuffer::int_type
+  DecompressionBuffer::underflow()
+  {
+    /** underflow, refill the get area with the next decompressed chunk **/
+
+    if (gptr() < egptr()) return traits_type::to_int_type(*gptr());
+    if (!fFile) return traits_type::eof();
+    size_t n = 0;
+    if (!Decompress(n)) return traits_type::eof();
+    fBytesOut += n;
+    setg(fOutput.data(), fOutput.data(), fOutput.data() + n);
+    return traits_type::to_int_type(*gptr());
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  DecompressionBuffer::ReadInput()
+  {
+    /** read input **/
+
+    fInputSize = std::fread(fInput.data(), 1, fInput.size(), fFile);
+    fInputPosition = 0;
+    fBytesIn += fInputSize;
+    if (fInputSize > 0) return kTRUE;
+    if (std::ferror(fFile)) {
+      LOG(ERROR) << "Failed reading compressed input: " << strerror(errno) << std::endl;
+      return kFALSE;
+    }
+    fInputEnd = kTRUE;
+    return kTRUE;
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  DecompressionBuffer::Decompress(size_t &n)
+  {
+    /** decompress into the output buffer until some data comes out,
+	kFALSE at the end of the stream or on error **/
+
+    /** uncompressed input **/
+    if (fCompression == kCompressionNone) {
+      n = std::fread(fOutput.data(), 1, fOutput.size(), fFile);
+      fBytesIn += n;
+      return n > 0;
+    }
+
+    while (kTRUE) {
+
+      /** refill input **/
+      if (fInputPosition == fInputSize && !fInputEnd && !ReadInput()) return kFALSE;
+      auto in = fInput.data() + fInputPosition;
+      auto nin = fInputSize - fInputPosition;
+
+      switch (fCompression) {
+
+#ifdef O2SIM_WITH_ZLIB
+      case kCompressionGzip: {
+	auto &zlib = fDecoder->zlib;
+	/** a new gzip member follows the end of the previous one **/
+	if (fStreamEnd && nin > 0) {
+	  inflateReset(&zlib);
+	  fStreamEnd = kFALSE;
+	}
+	zlib.next_in = (Bytef *)in;
+	zlib.avail_in = nin;
+	zlib.next_out = (Bytef *)fOutput.data();
+	zlib.avail_out = fOutput.size();
+	auto ret = fStreamEnd ? Z_STREAM_END : inflate(&zlib, Z_NO_FLUSH);
+	if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR) {
+	  LOG(ERROR) << "Failed decompressing gzip input: " << (zlib.msg ? zlib.msg : "unknown error") << std::endl;
+	  return kFALSE;
+	}
+	if (ret == Z_STREAM_END) fStreamEnd = kTRUE;
+	fInputPosition += nin - zlib.avail_in;
+	n = fOutput.size() - zlib.avail_out;
+	break;
+      }
+#endif
+
+#ifdef O2SIM_WITH_ZSTD
+      case kCompressionZstd: {
+	ZSTD_inBuffer input = {in, nin, 0};
+	ZSTD_outBuffer output = {fOutput.data(), fOutput.size(), 0};
+	auto ret = ZSTD_decompressStream(fDecoder->zstd, &output, &input);
+	if (ZSTD_isError(ret)) {
+	  LOG(ERROR) << "Failed decompressing zstd input: " << ZSTD_getErrorName(ret) << std::endl;
+	  return kFALSE;
+	}
+	/** a frame is complete when nothing is left to flush **/
+	if (input.pos > 0 || output.pos > 0) fStreamEnd = ret == 0;
+	fInputPosition += input.pos;
+	n = output.pos;
+	break;
+      }
+#endif
+
+#ifdef O2SIM_WITH_LZMA
+      case kCompressionXz: {
+	auto &lzma = fDecoder->lzma;
+	lzma.next_in = (const uint8_t *)in;
+	lzma.avail_in = nin;
+	lzma.next_out = (uint8_t *)fOutput.data();
+	lzma.avail_out = fOutput.size();
+	auto ret = lzma_code(&lzma, fInputEnd ? LZMA_FINISH : LZMA_RUN);
+	if (ret != LZMA_OK && ret != LZMA_STREAM_END && ret != LZMA_BUF_ERROR) {
+	  LOG(ERROR) << "Failed decompressing xz input: error " << ret << std::endl;
+	  return kFALSE;
+	}
+	if (ret == LZMA_STREAM_END) fStreamEnd = kTRUE;
+	fInputPosition += nin - lzma.avail_in;
+	n = fOutput.size() - lzma.avail_out;
+	break;
+      }
+#endif
+
+      default:
+	return kFALSE;
+      }
+
+      /** some data came out **/
+      if (n > 0) return kTRUE;
+
+      /** end of input **/
+      if (fInputEnd && fInputPosition == fInputSize) {
+	if (!fStreamEnd) LOG(ERROR) << "Truncated " << GetCompressionName(fCompression) << " input" << std::endl;
+	return kFALSE;
+      }
+    }
+  }
+
+  /*****************************************************************/
+  /*****************************************************************/
+
+} /* namespace eventgen */
+} /* namespace o2 */
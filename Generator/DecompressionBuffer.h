@@ -0,0 +1,105 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See https://alice-o2.web.cern.ch/ for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \author R+Preghenella - September 2017
+
+#ifndef ALICEO2_EVENTGEN_DECOMPRESSIONBUFFER_H_
+#define ALICEO2_EVENTGEN_DECOMPRESSIONBUFFER_H_
+
+#include "Rtypes.h"
+#include <cstdio>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+namespace o2
+{
+namespace eventgen
+{
+
+  /*****************************************************************/
+  /*****************************************************************/
+
+  /** input stream buffer decompressing a gzip, zstd or xz file
+      on the fly, the compression is detected from the magic bytes.
+      concatenated streams are read through as one. a compression
+      whose library was not found at build time fails at open **/
+
+  class DecompressionBuffer : public std::streambuf
+  {
+
+  public:
+
+    enum ECompression_t {
+      kCompressionNone,
+      kCompressionGzip,
+      kCompressionZstd,
+      kCompressionXz
+    };
+
+    /** default constructor **/
+    DecompressionBuffer();
+    /** destructor **/
+    virtual ~DecompressionBuffer();
+
+    /** methods **/
+    Bool_t Open(const std::string &filename);
+    void Close();
+
+    /** getters **/
+    ECompression_t GetCompression() const {return fCompression;};
+    ULong64_t GetBytesIn() const {return fBytesIn;};
+    ULong64_t GetBytesOut() const {return fBytesOut;};
+
+    /** static methods **/
+    static ECompression_t Detect(const std::string &filename);
+    static const Char_t *GetCompressionName(ECompression_t compression);
+
+  protected:
+
+    /** copy constructor **/
+    DecompressionBuffer(const DecompressionBuffer &);
+    /** operator= **/
+    DecompressionBuffer &operator=(const DecompressionBuffer &);
+
+    /** std::streambuf interface **/
+    int_type underflow() override;
+
+    /** methods **/
+    Bool_t ReadInput();
+    Bool_t Decompress(size_t &n);
+
+    /** decoder state of the compression libraries **/
+    struct Decoder_t;
+
+    /** data members **/
+    std::FILE *fFile;
+    ECompression_t fCompression;
+    Decoder_t *fDecoder;
+    std::vector<Char_t> fInput;
+    std::vector<Char_t> fOutput;
+    size_t fInputPosition;
+    size_t fInputSize;
+    Bool_t fInputEnd;
+    Bool_t fStreamEnd;
+    ULong64_t fBytesIn;
+    ULong64_t fBytesOut;
+
+    static const size_t fgBufferSize = 1 << 20;
+
+  }; /** class DecompressionBuffer **/
+
+  /*****************************************************************/
+  /*****************************************************************/
+
+} /** namespace eventgen **/
+} /** namespace o2 **/
+
+#endif /* ALICEO2_EVENTGEN_DECOMPRESSIONBUFFER_H_ */
@@ -0,0 +1,207 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See https://alice-o2.web.cern.ch/ for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \author R+Preghenella - September 2017
+
+#include "EventIndex.h"
+#include "FairLogger.h"
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cerrno>
+#include <cstring>
+#include <chrono>
+
+namespace o2
+{
+namespace eventgen
+{
+
+  /*****************************************************************/
+  /*****************************************************************/
+
+  EventIndex::EventIndex() :
+    fOffsets(),
+    fFileSize(0),
+    fFileTime(0)
+  {
+    /** default constructor **/
+
+  }
+
+  /*****************************************************************/
+
+  EventIndex::~EventIndex()
+  {
+    /** default destructor **/
+
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  EventIndex::Stat(const std::string &filename, ULong64_t &size, Long64_t &time)
+  {
+    /** stat **/
+
+    struct stat info;
+    if (stat(filename.c_str(), &info) != 0) {
+      LOG(ERROR) << "Cannot stat input file " << filename << ": " << strerror(errno) << std::endl;
+      return kFALSE;
+    }
+    size = info.st_size;
+    time = info.st_mtime;
+
+    /** success **/
+    return kTRUE;
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  EventIndex::Init(const std::string &filename)
+  {
+    /** init, the sidecar index is used if up to date,
+	otherwise the index is built and saved **/
+
+    if (!Stat(filename, fFileSize, fFileTime)) return kFALSE;
+    auto indexname = GetIndexFileName(filename);
+    if (Load(indexname)) {
+      LOG(INFO) << "Loaded event index: " << indexname << " | events = " << fOffsets.size() << std::endl;
+      return kTRUE;
+    }
+    if (!Build(filename)) return kFALSE;
+
+    /** an index that cannot be saved is only used by this job **/
+    if (!Save(indexname))
+      LOG(WARNING) << "Cannot save event index, it will be rebuilt by the next job: " << indexname << std::endl;
+
+    /** success **/
+    return kTRUE;
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  EventIndex::Build(const std::string &filename)
+  {
+    /** build, scanning for the lines starting with "E " **/
+
+    auto start = std::chrono::steady_clock::now();
+    auto file = std::fopen(filename.c_str(), "rb");
+    if (!file) {
+      LOG(ERROR) << "Cannot open input file " << filename << ": " << strerror(errno) << std::endl;
+      return kFALSE;
+    }
+    fOffsets.clear();
+    std::vector<Char_t> buffer(1 << 20);
+    ULong64_t position = 0, candidate = 0;
+    Bool_t lineStart = kTRUE, pending = kFALSE;
+    size_t n;
+    while ((n = std::fread(buffer.data(), 1, buffer.size(), file)) > 0) {
+      for (size_t i = 0; i < n; i++, position++) {
+	auto c = buffer[i];
+	/** the character after an "E" at the beginning of a line **/
+	if (pending && c == ' ') fOffsets.push_back(candidate);
+	pending = lineStart && c == 'E';
+	if (pending) candidate = position;
+	lineStart = c == '\n';
+      }
+    }
+    Bool_t error = std::ferror(file);
+    std::fclose(file);
+    if (error) {
+      LOG(ERROR) << "Failed reading input file " << filename << std::endl;
+      return kFALSE;
+    }
+    std::chrono::duration<Double_t> elapsed = std::chrono::steady_clock::now() - start;
+    LOG(INFO) << "Built event index: " << filename << " | events = " << fOffsets.size()
+	      << " | time = " << elapsed.count() << " s" << std::endl;
+
+    /** success **/
+    return kTRUE;
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  EventIndex::Load(const std::string &indexname)
+  {
+    /** load, kFALSE if missing or not matching the input **/
+
+    auto file = std::fopen(indexname.c_str(), "rb");
+    if (!file) return kFALSE;
+    UInt_t magic = 0, version = 0;
+    ULong64_t size = 0, nevents = 0;
+    Long64_t time = 0;
+    Bool_t retval =
+      std::fread(&magic, sizeof(magic), 1, file) == 1 && magic == fgMagic &&
+      std::fread(&version, sizeof(version), 1, file) == 1 && version == fgVersion &&
+      std::fread(&size, sizeof(size), 1, file) == 1 && size == fFileSize &&
+      std::fread(&time, sizeof(time), 1, file) == 1 && time == fFileTime &&
+      std::fread(&nevents, sizeof(nevents), 1, file) == 1;
+
+    /** the offsets must fill the rest of the file exactly,
+	checked before anything is allocated **/
+    if (retval) {
+      auto header = std::ftell(file);
+      retval = header >= 0 && std::fseek(file, 0, SEEK_END) == 0;
+      auto end = retval ? std::ftell(file) : -1;
+      retval = retval && end >= header && std::fseek(file, header, SEEK_SET) == 0 &&
+	nevents == (ULong64_t)(end - header) / sizeof(ULong64_t) &&
+	(ULong64_t)(end - header) % sizeof(ULong64_t) == 0;
+    }
+    if (retval) {
+      fOffsets.resize(nevents);
+      retval = std::fread(fOffsets.data(), sizeof(ULong64_t), nevents, file) == nevents;
+    }
+    std::fclose(file);
+    if (!retval) {
+      LOG(INFO) << "Event index missing or out of date: " << indexname << std::endl;
+      fOffsets.clear();
+    }
+    return retval;
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  EventIndex::Save(const std::string &indexname) const
+  {
+    /** save, through a temporary file that is renamed
+	to let concurrent jobs see complete indices only **/
+
+    auto tmpname = indexname + "." + std::to_string(getpid());
+    auto file = std::fopen(tmpname.c_str(), "wb");
+    if (!file) return kFALSE;
+    UInt_t magic = fgMagic, version = fgVersion;
+    ULong64_t nevents = fOffsets.size();
+    Bool_t retval =
+      std::fwrite(&magic, sizeof(magic), 1, file) == 1 &&
+      std::fwrite(&version, sizeof(version), 1, file) == 1 &&
+      std::fwrite(&fFileSize, sizeof(fFileSize), 1, file) == 1 &&
+      std::fwrite(&fFileTime, sizeof(fFileTime), 1, file) == 1 &&
+      std::fwrite(&nevents, sizeof(nevents), 1, file) == 1 &&
+      std::fwrite(fOffsets.data(), sizeof(ULong64_t), nevents, file) == nevents;
+    retval = std::fclose(file) == 0 && retval;
+    if (!retval || std::rename(tmpname.c_str(), indexname.c_str()) != 0) {
+      std::remove(tmpname.c_str());
+      return kFALSE;
+    }
+
+    /** success **/
+    return kTRUE;
+  }
+
+  /*****************************************************************/
+  /*****************************************************************/
+
+} /* namespace eventgen */
+} /* namespace o2 */
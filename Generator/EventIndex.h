@@ -0,0 +1,77 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See https://alice-o2.web.cern.ch/ for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \author R+Preghenella - September 2017
+
+#ifndef ALICEO2_EVENTGEN_EVENTINDEX_H_
+#define ALICEO2_EVENTGEN_EVENTINDEX_H_
+
+#include "Rtypes.h"
+#include <string>
+#include <vector>
+
+namespace o2
+{
+namespace eventgen
+{
+
+  /*****************************************************************/
+  /*****************************************************************/
+
+  /** byte offsets of the events in a HepMC2/3 ascii file, that is
+      of the lines starting with "E ". the index is built once and
+      stored in a sidecar file next to the input, it is rebuilt
+      when the size or the modification time of the input change **/
+
+  class EventIndex
+  {
+
+  public:
+
+    /** default constructor **/
+    EventIndex();
+    /** destructor **/
+    virtual ~EventIndex();
+
+    /** methods **/
+    Bool_t Init(const std::string &filename);
+    Bool_t Build(const std::string &filename);
+    Bool_t Load(const std::string &indexname);
+    Bool_t Save(const std::string &indexname) const;
+
+    /** getters **/
+    Long64_t GetNumberOfEvents() const {return fOffsets.size();};
+    ULong64_t GetOffset(Long64_t event) const {return fOffsets[event];};
+
+    /** static methods **/
+    static std::string GetIndexFileName(const std::string &filename) {return filename + ".idx";};
+
+  protected:
+
+    /** methods **/
+    static Bool_t Stat(const std::string &filename, ULong64_t &size, Long64_t &time);
+
+    /** data members **/
+    std::vector<ULong64_t> fOffsets;
+    ULong64_t fFileSize;
+    Long64_t fFileTime;
+
+    static const UInt_t fgMagic = 0x6f326978; // "o2ix"
+    static const UInt_t fgVersion = 1;
+
+  }; /** class EventIndex **/
+
+  /*****************************************************************/
+  /*****************************************************************/
+
+} /** namespace eventgen **/
+} /** namespace o2 **/
+
+#endif /* ALICEO2_EVENTGEN_EVENTINDEX_H_ */
@@ -15,8 +15,14 @@
 #include "FairPrimaryGenerator.h"
 #include "PrimaryGenerator.h"
 #include "Trigger/Trigger.h"
+#include "Trigger/TriggerParticles.h"
+#include "Trigger/TriggerExpression.h"
 #include "FairLogger.h"
+#include "TDirectory.h"
+#include "TParameter.h"
 #include <cmath>
+#include <map>
+#include <chrono>
 
 namespace o2
 {
@@ -31,8 +37,36 @@ namespace eventgen
     fTriggerMode(kTriggerOFF),
     fMaxTriggerAttempts(100000),
     fTriggers(new TObjArray()),
+    fTriggerList(),
+    fParticleTriggers(),
+    fParticleTriggered(kFALSE),
     fBoost(0.),
-    fHeader(new GeneratorHeader())
+    fHeader(new GeneratorHeader()),
+    fParticleBuffer(),
+    fInstances(),
+    fPrefetchDepth(0),
+    fPrefetchSlots(),
+    fPrefetchFree(),
+    fPrefetchReady(),
+    fPrefetchThreads(),
+    fPrefetchMutex(),
+    fPrefetchCondition(),
+    fPrefetchStop(kFALSE),
+    fPrefetchEvents(0),
+    fPrefetchFillSum(0.),
+    fPrefetchStalls(0),
+    fPrefetchStallTime(0.),
+    fGenerateEvents(0),
+    fGenerateTime(0.),
+    fGenerateFirstTime(0.),
+    fBoostParticles(0),
+    fBoostTime(0.),
+    fProfileGenerate(nullptr),
+    fProfileBoost(nullptr),
+    fProfileTrigger(nullptr),
+    fProfileAddTracks(nullptr),
+    fProfileAttempts(nullptr),
+    fProfileAccepted(nullptr)
   {
     /** default constructor **/
 
@@ -45,8 +79,36 @@ namespace eventgen
     fTriggerMode(kTriggerOFF),
     fMaxTriggerAttempts(100000),
     fTriggers(new TObjArray()),
+    fTriggerList(),
+    fParticleTriggers(),
+    fParticleTriggered(kFALSE),
     fBoost(0.),
-    fHeader(new GeneratorHeader(name))
+    fHeader(new GeneratorHeader(name)),
+    fParticleBuffer(),
+    fInstances(),
+    fPrefetchDepth(0),
+    fPrefetchSlots(),
+    fPrefetchFree(),
+    fPrefetchReady(),
+    fPrefetchThreads(),
+    fPrefetchMutex(),
+    fPrefetchCondition(),
+    fPrefetchStop(kFALSE),
+    fPrefetchEvents(0),
+    fPrefetchFillSum(0.),
+    fPrefetchStalls(0),
+    fPrefetchStallTime(0.),
+    fGenerateEvents(0),
+    fGenerateTime(0.),
+    fGenerateFirstTime(0.),
+    fBoostParticles(0),
+    fBoostTime(0.),
+    fProfileGenerate(nullptr),
+    fProfileBoost(nullptr),
+    fProfileTrigger(nullptr),
+    fProfileAddTracks(nullptr),
+    fProfileAttempts(nullptr),
+    fProfileAccepted(nullptr)
   {
     /** constructor **/
 
@@ -58,6 +120,9 @@ namespace eventgen
   {
     /** default destructor **/
 
+    StopPrefetch();
+    for (auto &instance : fInstances)
+      delete instance;
     if (fTriggers) delete fTriggers;
     if (fHeader) delete fHeader;
   }
@@ -67,9 +132,147 @@ namespace eventgen
   void
   Generator::AddTrigger(Trigger *trigger)
   {
-    /** add trigger **/
+    /** add trigger, the particle triggers are cast once here **/
 
     fTriggers->Add(trigger);
+    fTriggerList.push_back(trigger);
+    fParticleTriggers.push_back(dynamic_cast<TriggerParticles *>(trigger));
+    if (fParticleTriggers.back() && fParticleTriggers.back()->UsesParticles()) fParticleTriggered = kTRUE;
+    /** generator-specific operands of an expression are handed back **/
+    auto triggerExpression = dynamic_cast<TriggerExpression *>(trigger);
+    if (triggerExpression) triggerExpression->SetTriggerFired([this](Trigger *operand) {return TriggerFired(operand);});
+  }
+  
+  /*****************************************************************/
+
+  Bool_t
+  Generator::InitTrigger(const std::vector<Trigger *> &triggers, const TString &mode, const TString &expression, UInt_t seed)
+  {
+    /** init trigger from the triggers of the generator delegate,
+	compiled into one trigger expression. the OR/AND trigger
+	modes are the expression joining all triggers **/
+
+    if (triggers.empty()) return kTRUE;
+    
+    /** expression of the trigger mode **/
+    std::string text = expression.Data();
+    if (expression.IsNull()) {
+      std::string op;
+      if (mode.EqualTo("OR", TString::kIgnoreCase)) op = " OR ";
+      else if (mode.EqualTo("AND", TString::kIgnoreCase)) op = " AND ";
+      else {
+	LOG(ERROR) << "Invalid trigger_mode: " << mode << std::endl;
+	for (auto const &trigger : triggers) delete trigger;
+	return kFALSE;
+      }
+      for (auto const &trigger : triggers)
+	text += (text.empty() ? "" : op) + trigger->GetName();
+    }
+    
+    /** trigger expression, owns the triggers **/
+    std::map<std::string, Trigger *> leaves;
+    for (auto const &trigger : triggers)
+      leaves[trigger->GetName()] = trigger;
+    auto triggerExpression = new TriggerExpression();
+    triggerExpression->SetName("trigger_expression");
+    triggerExpression->SetSeed(seed);
+    if (!triggerExpression->Parse(text, leaves)) {
+      LOG(ERROR) << "Invalid trigger expression: " << text << std::endl;
+      delete triggerExpression;
+      return kFALSE;
+    }
+    SetTriggerMode(kTriggerOR);
+    AddTrigger(triggerExpression);
+    LOG(INFO) << "Added trigger expression: " << triggerExpression->ToString() << std::endl;
+
+    /** success **/
+    return kTRUE;
+  }
+  
+  /*****************************************************************/
+
+  void
+  Generator::AddInstance(Generator *instance)
+  {
+    /** add instance **/
+
+    fInstances.push_back(instance);
+  }
+  
+  /*****************************************************************/
+
+  void
+  Generator::InitProfiling()
+  {
+    /** init profiling, instances share the entries **/
+
+    std::string prefix = std::string("generator.") + GetName() + ".";
+    auto &profiler = o2sim::Profiler::Instance();
+    fProfileGenerate = profiler.GetEntry(prefix + "generate");
+    fProfileBoost = profiler.GetEntry(prefix + "boost");
+    fProfileTrigger = profiler.GetEntry(prefix + "trigger");
+    fProfileAddTracks = profiler.GetEntry(prefix + "add_tracks");
+    fProfileAttempts = profiler.GetEntry(prefix + "trigger_attempts");
+    fProfileAccepted = profiler.GetEntry(prefix + "trigger_accepted");
+    for (auto &particleTrigger : fParticleTriggers)
+      if (particleTrigger) particleTrigger->InitProfiling();
+    for (auto &instance : fInstances)
+      instance->InitProfiling();
+  }
+  
+  /*****************************************************************/
+
+  Bool_t
+  Generator::SaveState(TDirectory *dir) const
+  {
+    /** save state **/
+
+    /** prefetched events are generated ahead of the checkpoint **/
+    if (!IsCheckpointable()) {
+      LOG(ERROR) << "Cannot checkpoint \"" << GetName() << "\" generator with prefetch or instances" << std::endl;
+      return kFALSE;
+    }
+    
+    /** generated events **/
+    TParameter<Long64_t> events("events", fGenerateEvents);
+    if (dir->WriteTObject(&events) <= 0) return kFALSE;
+
+    /** triggers **/
+    for (UInt_t itrigger = 0; itrigger < fTriggerList.size(); itrigger++)
+      if (!fTriggerList[itrigger]->SaveState(dir, Form("trigger%d", itrigger))) return kFALSE;
+
+    /** generator-specific state **/
+    return SaveGeneratorState(dir);
+  }
+  
+  /*****************************************************************/
+
+  Bool_t
+  Generator::LoadState(TDirectory *dir)
+  {
+    /** load state **/
+
+    auto events = dynamic_cast<TParameter<Long64_t> *>(dir->Get("events"));
+    if (!events) {
+      LOG(ERROR) << "Cannot find state of \"" << GetName() << "\" generator" << std::endl;
+      return kFALSE;
+    }
+    auto nevents = events->GetVal();
+    delete events;
+    
+    /** generator-specific state, given the events generated so far **/
+    if (!LoadGeneratorState(dir, nevents)) {
+      LOG(ERROR) << "Failed loading state of \"" << GetName() << "\" generator" << std::endl;
+      return kFALSE;
+    }
+    fGenerateEvents = nevents;
+
+    /** triggers **/
+    for (UInt_t itrigger = 0; itrigger < fTriggerList.size(); itrigger++)
+      if (!fTriggerList[itrigger]->LoadState(dir, Form("trigger%d", itrigger))) return kFALSE;
+
+    /** success **/
+    return kTRUE;
   }
   
   /*****************************************************************/
@@ -79,13 +282,50 @@ namespace eventgen
   {
     /** read event **/
 
+    /** events are generated ahead in the background **/
+    if (fPrefetchDepth > 0 || !fInstances.empty()) return ReadPrefetchedEvent(primGen);
+    
     /** reset header **/
     fHeader->Reset();
     
+    /** generate triggered event **/
+    Int_t nAttempts;
+    if (!GenerateTriggeredEvent(nAttempts)) return kFALSE;
+
+    /** fill header **/
+    fHeader->SetNumberOfAttempts(nAttempts);
+    if (!FillHeader(fHeader)) return kFALSE;
+    
+    /** add tracks **/
+    {
+      o2sim::Profiler::Timer timer(fProfileAddTracks);
+      fParticleBuffer.AddTracks(primGen);
+    }
+
+    /** add header **/
+    auto o2primGen = dynamic_cast<PrimaryGenerator *>(primGen);
+    if (o2primGen && !AddHeader(o2primGen)) return kFALSE;
+
+    /** success **/
+    return kTRUE;
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  Generator::GenerateTriggeredEvent(Int_t &nAttempts, const std::atomic<Bool_t> *stop)
+  {
+    /** generate triggered event, a prefetch producer
+	gives up between attempts when asked to stop **/
+
     /** trigger loop **/
-    Int_t nAttempts = 0;
+    nAttempts = 0;
+    Bool_t triggered;
     do {
       
+      /** check stop request **/
+      if (stop && *stop) return kFALSE;
+
       /** check attempts **/
       nAttempts++;
       if (nAttempts % 1000 == 0)
@@ -95,49 +335,94 @@ namespace eventgen
 	return kFALSE;
       }
       
-      /** generate event **/
+      /** generate event, timed only when profiling **/
+      auto start = fProfileGenerate ? o2sim::Profiler::Now() : 0;
       if (!GenerateEvent()) return kFALSE;
+      if (fProfileGenerate) {
+	auto elapsed = o2sim::Profiler::Now() - start;
+	if (fGenerateEvents == 0) fGenerateFirstTime = elapsed * 1.e-9;
+	fGenerateTime += elapsed * 1.e-9;
+	fProfileGenerate->Add(1, elapsed);
+      }
+      fGenerateEvents++;
 
-      /** boost event **/
-      if (!BoostEvent(fBoost)) return kFALSE;      
-
-    } while (!TriggerEvent()); /** end of trigger loop **/
+      /** fill particles before the trigger only when a trigger runs
+	  on the particle buffer, otherwise once the event is accepted **/
+      auto fillFirst = fParticleTriggered && fTriggerMode != kTriggerOFF;
+      if (fillFirst && !FillEvent()) return kFALSE;
 
-    /** add tracks **/
-    if (!AddTracks(primGen)) return kFALSE;
+      /** trigger event **/
+      {
+	o2sim::Profiler::Timer timer(fProfileTrigger);
+	triggered = TriggerEvent();
+      }
+      if (triggered && !fillFirst && !FillEvent()) return kFALSE;
+      
+    } while (!triggered); /** end of trigger loop **/
 
-    /** setup header **/
-    fHeader->SetNumberOfAttempts(nAttempts);
+    /** profiling counters **/
+    if (fProfileAttempts) fProfileAttempts->Add(nAttempts);
+    if (fProfileAccepted) fProfileAccepted->Add(1);
     
-    /** add header **/
-    auto o2primGen = dynamic_cast<PrimaryGenerator *>(primGen);
-    if (o2primGen && !AddHeader(o2primGen)) return kFALSE;
-
     /** success **/
     return kTRUE;
   }
 
   /*****************************************************************/
 
+  Bool_t
+  Generator::FillEvent()
+  {
+    /** fill particles and boost **/
+
+    fParticleBuffer.Reset();
+    if (!FillParticles(fParticleBuffer)) return kFALSE;
+    return BoostEvent(fBoost);
+  }
+  
+  /*****************************************************************/
+
+  Bool_t
+  Generator::BoostEvent(Double_t boost)
+  {
+    /** boost event **/
+
+    if (std::abs(boost) < 1.e-6) return kTRUE;
+    auto start = fProfileBoost ? o2sim::Profiler::Now() : 0;
+    fParticleBuffer.Boost(boost);
+    if (fProfileBoost) {
+      auto elapsed = o2sim::Profiler::Now() - start;
+      fBoostTime += elapsed * 1.e-9;
+      fProfileBoost->Add(1, elapsed);
+    }
+    fBoostParticles += fParticleBuffer.GetSize();
+    
+    /** success **/
+    return kTRUE;
+  }
+  
+  /*****************************************************************/
+
   Bool_t
   Generator::TriggerEvent() const
   {
     /** trigger event **/
 
     auto triggered = kTRUE;
-    if (fTriggers->GetEntries() == 0) return kTRUE;
+    if (fTriggerList.empty()) return kTRUE;
     else if (fTriggerMode == kTriggerOFF) return kTRUE;
     else if (fTriggerMode == kTriggerOR) triggered = kFALSE;
     else if (fTriggerMode == kTriggerAND) triggered = kTRUE;
     else return kTRUE;
     
     /** loop over triggers **/
-    for (Int_t itrigger = 0; itrigger < fTriggers->GetEntries(); itrigger++) {
-      auto trigger = dynamic_cast<Trigger *>(fTriggers->At(itrigger));
-      if (!trigger) continue;
-      auto retval = TriggerFired(trigger);
-      if (fTriggerMode == kTriggerOR) triggered |= retval;
-      if (fTriggerMode == kTriggerAND) triggered &= retval;
+    for (UInt_t itrigger = 0; itrigger < fTriggerList.size(); itrigger++) {
+      /** triggers on the particle buffer are preferred,
+	  generator-specific triggers see the event before the boost **/
+      auto particleTrigger = fParticleTriggers[itrigger];
+      auto retval = particleTrigger ? particleTrigger->TriggerEvent(fParticleBuffer) : TriggerFired(fTriggerList[itrigger]);
+      if (fTriggerMode == kTriggerOR && retval) return kTRUE;
+      if (fTriggerMode == kTriggerAND && !retval) return kFALSE;
     } /** end of loop over triggers **/
 
     /** success **/
@@ -157,6 +442,210 @@ namespace eventgen
     return kTRUE;
   }
   
+  /*****************************************************************/
+
+  Bool_t
+  Generator::ReadPrefetchedEvent(FairPrimaryGenerator *primGen)
+  {
+    /** read prefetched event **/
+
+    /** start prefetch at the first event **/
+    if (fPrefetchSlots.empty() && !StartPrefetch()) return kFALSE;
+
+    /** wait for a ready slot **/
+    std::unique_lock<std::mutex> lock(fPrefetchMutex);
+    fPrefetchFillSum += fPrefetchReady.size();
+    if (fPrefetchReady.empty()) {
+      auto start = std::chrono::steady_clock::now();
+      fPrefetchCondition.wait(lock, [this] {return fPrefetchStop || !fPrefetchReady.empty();});
+      std::chrono::duration<Double_t> stall = std::chrono::steady_clock::now() - start;
+      fPrefetchStallTime += stall.count();
+      fPrefetchStalls++;
+    }
+    /** production ended on a failure **/
+    if (fPrefetchReady.empty()) return kFALSE;
+    auto islot = fPrefetchReady.front();
+    fPrefetchReady.pop_front();
+    lock.unlock();
+    fPrefetchEvents++;
+    
+    /** take the header, the slot gets the old one back **/
+    auto &slot = fPrefetchSlots[islot];
+    std::swap(fHeader, slot.header);
+    
+    /** add tracks **/
+    auto status = slot.status;
+    if (status) {
+      o2sim::Profiler::Timer timer(fProfileAddTracks);
+      slot.particles.AddTracks(primGen);
+    }
+    
+    /** release the slot **/
+    lock.lock();
+    fPrefetchFree.push_back(islot);
+    lock.unlock();
+    fPrefetchCondition.notify_all();
+    if (!status) return kFALSE;
+
+    /** add header **/
+    auto o2primGen = dynamic_cast<PrimaryGenerator *>(primGen);
+    if (o2primGen && !AddHeader(o2primGen)) return kFALSE;
+
+    /** success **/
+    return kTRUE;
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  Generator::StartPrefetch()
+  {
+    /** start prefetch **/
+
+    /** init instances, the main one is initialised by the primary generator **/
+    for (auto &instance : fInstances) {
+      if (!instance->Init()) {
+	LOG(ERROR) << "Failed initialising instance of \"" << GetName() << "\" generator" << std::endl;
+	return kFALSE;
+      }
+    }
+    
+    /** allocate slots, at least one per instance **/
+    Int_t nInstances = fInstances.size() + 1;
+    if (fPrefetchDepth < nInstances) fPrefetchDepth = nInstances;
+    fPrefetchSlots.resize(fPrefetchDepth);
+    for (Int_t islot = 0; islot < fPrefetchDepth; islot++) {
+      fPrefetchSlots[islot].header = new GeneratorHeader(GetName());
+      fPrefetchFree.push_back(islot);
+    }
+
+    /** start one producer thread per instance **/
+    fPrefetchStop = kFALSE;
+    fPrefetchThreads.emplace_back(&Generator::PrefetchLoop, this, this);
+    for (auto &instance : fInstances)
+      fPrefetchThreads.emplace_back(&Generator::PrefetchLoop, this, instance);
+    LOG(INFO) << "Started event prefetch for \"" << GetName() << "\" generator: depth = " << fPrefetchDepth
+	      << " | instances = " << nInstances << std::endl;
+
+    /** success **/
+    return kTRUE;
+  }
+  
+  /*****************************************************************/
+
+  void
+  Generator::StopPrefetch()
+  {
+    /** stop prefetch, the producers are signalled and the ready
+	events drained. a producer inside a trigger loop stops at
+	the next attempt, one inside GenerateEvent when it returns **/
+
+    if (fPrefetchThreads.empty()) return;
+    {
+      std::lock_guard<std::mutex> lock(fPrefetchMutex);
+      fPrefetchStop = kTRUE;
+      while (!fPrefetchReady.empty()) {
+	fPrefetchFree.push_back(fPrefetchReady.front());
+	fPrefetchReady.pop_front();
+      }
+    }
+    fPrefetchCondition.notify_all();
+    for (auto &thread : fPrefetchThreads)
+      thread.join();
+    fPrefetchThreads.clear();
+    for (auto &slot : fPrefetchSlots)
+      if (slot.header) delete slot.header;
+    fPrefetchSlots.clear();
+    fPrefetchFree.clear();
+    fPrefetchReady.clear();
+  }
+  
+  /*****************************************************************/
+
+  void
+  Generator::PrefetchLoop(Generator *generator)
+  {
+    /** prefetch loop, runs in a producer thread for the given instance **/
+
+    while (kTRUE) {
+
+      /** wait for a free slot **/
+      std::unique_lock<std::mutex> lock(fPrefetchMutex);
+      fPrefetchCondition.wait(lock, [this] {return fPrefetchStop || !fPrefetchFree.empty();});
+      if (fPrefetchStop) return;
+      auto islot = fPrefetchFree.front();
+      fPrefetchFree.pop_front();
+      lock.unlock();
+
+      /** generate triggered event into the slot,
+	  the attempts are those of the instance that accepted it **/
+      auto &slot = fPrefetchSlots[islot];
+      Int_t nAttempts;
+      slot.header->Reset();
+      slot.status = generator->GenerateTriggeredEvent(nAttempts, &fPrefetchStop);
+      slot.header->SetNumberOfAttempts(nAttempts);
+      slot.status = slot.status && generator->FillHeader(slot.header);
+      slot.particles.Swap(generator->fParticleBuffer);
+      
+      /** hand the slot over, a failure ends the production **/
+      lock.lock();
+      fPrefetchReady.push_back(islot);
+      if (!slot.status) fPrefetchStop = kTRUE;
+      lock.unlock();
+      fPrefetchCondition.notify_all();
+      if (!slot.status) return;
+    }
+  }
+  
+  /*****************************************************************/
+
+  void
+  Generator::PrintCounters() const
+  {
+    /** print counters **/
+
+    if (fPrefetchDepth > 0)
+      LOG(INFO) << "Prefetch counters for \"" << GetName() << "\" generator:"
+		<< " depth = " << fPrefetchDepth
+		<< " | events = " << fPrefetchEvents
+		<< " | average fill level = " << GetPrefetchFillLevel()
+		<< " | stalls = " << fPrefetchStalls
+		<< " | stall time = " << fPrefetchStallTime << " s"
+		<< std::endl;
+
+    /** times are measured only when profiling **/
+    if (fGenerateEvents > 0 && fProfileGenerate)
+      LOG(INFO) << "Generate counters for \"" << GetName() << "\" generator:"
+		<< " events = " << fGenerateEvents
+		<< " | first event time = " << fGenerateFirstTime << " s"
+		<< " | total time = " << fGenerateTime << " s"
+		<< " | rate = " << fGenerateEvents / fGenerateTime << " events/s"
+		<< std::endl;
+    else if (fGenerateEvents > 0)
+      LOG(INFO) << "Generate counters for \"" << GetName() << "\" generator:"
+		<< " events = " << fGenerateEvents
+		<< std::endl;
+    
+    if (fBoostParticles > 0 && fProfileBoost)
+      LOG(INFO) << "Boost counters for \"" << GetName() << "\" generator:"
+		<< " particles = " << fBoostParticles
+		<< " | total time = " << fBoostTime << " s"
+		<< " | rate = " << fBoostParticles / fBoostTime << " particles/s"
+		<< std::endl;
+    else if (fBoostParticles > 0)
+      LOG(INFO) << "Boost counters for \"" << GetName() << "\" generator:"
+		<< " particles = " << fBoostParticles
+		<< std::endl;
+    
+    /** triggers **/
+    for (auto const &particleTrigger : fParticleTriggers)
+      if (particleTrigger) particleTrigger->PrintCounters();
+    
+    /** instances **/
+    for (auto const &instance : fInstances)
+      instance->PrintCounters();
+  }
+  
   /*****************************************************************/
   /*****************************************************************/
     
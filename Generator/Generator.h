@@ -15,6 +15,16 @@
 #define ALICEO2_EVENTGEN_GENERATOR_H_
 
 #include "FairGenerator.h"
+#include "Trigger/ParticleBuffer.h"
+#include "Core/Profiler.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <vector>
+
+class TDirectory;
 
 namespace o2
 {
@@ -24,6 +34,7 @@ namespace eventgen
   class PrimaryGenerator;
   class GeneratorHeader;
   class Trigger;
+  class TriggerParticles;
   
   /*****************************************************************/
   /*****************************************************************/
@@ -57,12 +68,36 @@ namespace eventgen
 
     /** getters **/
     GeneratorHeader *GetHeader() const {return fHeader;};
+    Int_t GetPrefetchDepth() const {return fPrefetchDepth;};
+    Long64_t GetPrefetchEvents() const {return fPrefetchEvents;};
+    Double_t GetPrefetchFillLevel() const {return fPrefetchEvents > 0 ? fPrefetchFillSum / fPrefetchEvents : 0.;};
+    Long64_t GetPrefetchStalls() const {return fPrefetchStalls;};
+    Double_t GetPrefetchStallTime() const {return fPrefetchStallTime;};
+    Long64_t GetGenerateEvents() const {return fGenerateEvents;};
+    Double_t GetGenerateTime() const {return fGenerateTime;};
+    Double_t GetGenerateFirstTime() const {return fGenerateFirstTime;};
+    Long64_t GetBoostParticles() const {return fBoostParticles;};
+    Double_t GetBoostTime() const {return fBoostTime;};
     
     /** setters **/
     void SetTriggerMode(ETriggerMode_t val) {fTriggerMode = val;};
     void SetMaxTriggerAttempts(Int_t val) {fMaxTriggerAttempts = val;};
     void AddTrigger(Trigger *trigger);
+    Bool_t InitTrigger(const std::vector<Trigger *> &triggers, const TString &mode, const TString &expression, UInt_t seed);
     void SetBoost(Double_t val) {fBoost = val;};
+    void SetPrefetchDepth(Int_t val) {fPrefetchDepth = val;};
+    void AddInstance(Generator *instance);
+
+    /** methods **/
+    virtual void PrintCounters() const;
+    void InitProfiling();
+
+    /** checkpoint methods, the number of generated events
+	and the state of the triggers are saved together with
+	the generator-specific state **/
+    Bool_t SaveState(TDirectory *dir) const;
+    Bool_t LoadState(TDirectory *dir);
+    Bool_t IsCheckpointable() const {return fPrefetchDepth == 0 && fInstances.empty();};
 
   protected:
 
@@ -73,20 +108,77 @@ namespace eventgen
 
     /** methods to override **/
     virtual Bool_t GenerateEvent() = 0;
-    virtual Bool_t BoostEvent(Double_t boost) = 0;
     virtual Bool_t TriggerFired(Trigger *trigger) const = 0;
-    virtual Bool_t AddTracks(FairPrimaryGenerator *primGen) const = 0;
+    virtual Bool_t FillParticles(ParticleBuffer &buffer) const = 0;
+    virtual Bool_t FillHeader(GeneratorHeader *header) const {return kTRUE;};
+    virtual Bool_t SaveGeneratorState(TDirectory *dir) const {return kTRUE;};
+    virtual Bool_t LoadGeneratorState(TDirectory *dir, Long64_t events) {return kTRUE;};
 
     /** methods **/
-    virtual Bool_t AddHeader(PrimaryGenerator *primGen) const;
+    Bool_t GenerateTriggeredEvent(Int_t &nAttempts, const std::atomic<Bool_t> *stop = nullptr);
+    Bool_t BoostEvent(Double_t boost);
+    Bool_t FillEvent();
+    Bool_t AddHeader(PrimaryGenerator *primGen) const;
     Bool_t TriggerEvent() const;
+
+    /** prefetch methods **/
+    Bool_t ReadPrefetchedEvent(FairPrimaryGenerator *primGen);
+    Bool_t StartPrefetch();
+    void StopPrefetch();
+    void PrefetchLoop(Generator *generator);
     
     /** data members **/
     ETriggerMode_t fTriggerMode;
     Int_t fMaxTriggerAttempts;
     TObjArray *fTriggers;
+    std::vector<Trigger *> fTriggerList;                //! cast once when added
+    std::vector<TriggerParticles *> fParticleTriggers;  //! null for generator-specific triggers
+    Bool_t fParticleTriggered;                          //! a trigger runs on the particle buffer
     Double_t fBoost;
     GeneratorHeader *fHeader;
+    ParticleBuffer fParticleBuffer;   //! filled once per generated event
+
+    /** independent instances of the same generator, each one
+	runs its own trigger loop feeding the prefetch queue **/
+    std::vector<Generator *> fInstances;  //!
+
+    /** prefetch queue, slots are cycled between the free and ready lists **/
+    struct PrefetchSlot_t {
+      ParticleBuffer particles;
+      GeneratorHeader *header = nullptr;
+      Bool_t status = kFALSE;
+    };
+    Int_t fPrefetchDepth;
+    std::vector<PrefetchSlot_t> fPrefetchSlots;  //!
+    std::deque<Int_t> fPrefetchFree;             //!
+    std::deque<Int_t> fPrefetchReady;            //!
+    std::vector<std::thread> fPrefetchThreads;   //!
+    std::mutex fPrefetchMutex;                   //!
+    std::condition_variable fPrefetchCondition;  //!
+    std::atomic<Bool_t> fPrefetchStop;           //! checked by the producers between attempts
+    
+    /** prefetch counters **/
+    Long64_t fPrefetchEvents;     //! events delivered from the queue
+    Double_t fPrefetchFillSum;    //! sum of ready slots seen at delivery
+    Long64_t fPrefetchStalls;     //! deliveries that had to wait
+    Double_t fPrefetchStallTime;  //! total waiting time [s]
+
+    /** generate counters **/
+    Long64_t fGenerateEvents;     //! generated events, before trigger
+    Double_t fGenerateTime;       //! total generation time [s], when profiling
+    Double_t fGenerateFirstTime;  //! generation time of the first event [s], when profiling
+
+    /** boost counters **/
+    Long64_t fBoostParticles;     //! boosted particles
+    Double_t fBoostTime;          //! total boost time [s], when profiling
+
+    /** profiling entries, null when profiling is off **/
+    o2sim::Profiler::Entry *fProfileGenerate;   //!
+    o2sim::Profiler::Entry *fProfileBoost;      //!
+    o2sim::Profiler::Entry *fProfileTrigger;    //!
+    o2sim::Profiler::Entry *fProfileAddTracks;  //!
+    o2sim::Profiler::Entry *fProfileAttempts;   //!
+    o2sim::Profiler::Entry *fProfileAccepted;   //!
     
     ClassDefOverride(Generator, 1);
     
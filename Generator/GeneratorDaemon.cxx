@@ -0,0 +1,377 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See https://alice-o2.web.cern.ch/ for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \author R+Preghenella - September 2017
+
+
+#include "GeneratorDaemon.h"
+#include "FairLogger.h"
+#include <cstring>
+#include <cstdlib>
+#include <cerrno>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <sys/socket.h>
+#include <sys/file.h>
+#include <sys/un.h>
+
+namespace o2
+{
+namespace eventgen
+{
+
+  /*****************************************************************/
+  /*****************************************************************/
+
+  std::string
+  GeneratorDaemon::GetSocketName()
+  {
+    /** get socket name, one server per user and node by default **/
+
+    auto name = getenv("O2SIM_GEND_SOCKET");
+    if (name && strlen(name) > 0) return name;
+    return "/tmp/o2sim-gend." + std::to_string(getuid()) + ".sock";
+  }
+  
+  /*****************************************************************/
+
+  ULong64_t
+  GeneratorDaemon::Hash(const std::string &kind, const std::string &config)
+  {
+    /** hash, FNV-1a over kind and configuration **/
+
+    ULong64_t hash = 0xcbf29ce484222325ULL;
+    for (auto const &text : {kind, std::string(1, '\0'), config})
+      for (auto c : text) {
+	hash ^= (UChar_t)c;
+	hash *= 0x100000001b3ULL;
+      }
+    return hash;
+  }
+  
+  /*****************************************************************/
+
+  Bool_t
+  GeneratorDaemon::Request(const std::string &kind, const std::string &config, UInt_t seed,
+			   const std::string &shmName, ULong64_t shmSize, Bool_t autostart)
+  {
+    /** request, the events are then read from the ring **/
+
+    /** connect, starting the server if needed. the check and
+	the spawn are serialised between jobs by a lock file **/
+    auto name = GetSocketName();
+    Int_t fd = Connect(name);
+    if (fd < 0 && autostart) {
+      Int_t lock = open((name + ".spawn.lock").c_str(), O_RDWR | O_CREAT | O_CLOEXEC, S_IRUSR | S_IWUSR);
+      if (lock >= 0) flock(lock, LOCK_EX);
+      fd = Connect(name);
+      if (fd < 0 && Spawn(name)) {
+	for (Int_t itry = 0; itry < 100 && fd < 0; itry++) {
+	  usleep(100000);
+	  fd = Connect(name);
+	}
+      }
+      if (lock >= 0) {
+	flock(lock, LOCK_UN);
+	close(lock);
+      }
+    }
+    if (fd < 0) {
+      LOG(ERROR) << "Cannot connect to generator server: " << name << std::endl;
+      return kFALSE;
+    }
+
+    /** send request **/
+    Request_t request;
+    memset(&request, 0, sizeof(request));
+    request.magic = fgMagic;
+    request.version = fgVersion;
+    strncpy(request.kind, kind.c_str(), sizeof(request.kind) - 1);
+    request.seed = seed;
+    request.configSize = config.size();
+    request.hash = Hash(kind, config);
+    request.shmSize = shmSize;
+    strncpy(request.shmName, shmName.c_str(), sizeof(request.shmName) - 1);
+    if (!WriteFully(fd, &request, sizeof(request)) ||
+	!WriteFully(fd, config.data(), config.size())) {
+      LOG(ERROR) << "Cannot send request to generator server: " << name << std::endl;
+      close(fd);
+      return kFALSE;
+    }
+
+    /** wait for the reply, a new generator is initialised first **/
+    Reply_t reply;
+    Bool_t retval = ReadFully(fd, &reply, sizeof(reply));
+    close(fd);
+    if (!retval || reply.magic != fgMagic) {
+      LOG(ERROR) << "Invalid reply from generator server: " << name << std::endl;
+      return kFALSE;
+    }
+    if (reply.status != kStatusOK) {
+      LOG(ERROR) << "Generator server failed request: status " << reply.status << std::endl;
+      return kFALSE;
+    }
+    LOG(INFO) << "Generator server streams " << kind << " events from process " << reply.pid
+	      << (reply.reused ? " (initialised generator reused)" : " (generator initialised)") << std::endl;
+    
+    /** success **/
+    return kTRUE;
+  }
+
+  /*****************************************************************/
+
+  Int_t
+  GeneratorDaemon::Listen(const std::string &name, Int_t &lock)
+  {
+    /** listen, fails if a server is already there **/
+
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (name.size() >= sizeof(address.sun_path)) {
+      LOG(ERROR) << "Socket name too long: " << name << std::endl;
+      return -1;
+    }
+    strncpy(address.sun_path, name.c_str(), sizeof(address.sun_path) - 1);
+
+    /** the lock is released by the kernel when the server dies **/
+    lock = open((name + ".lock").c_str(), O_RDWR | O_CREAT, S_IRUSR | S_IWUSR);
+    if (lock < 0 || flock(lock, LOCK_EX | LOCK_NB) < 0) {
+      LOG(ERROR) << "Generator server already running: " << name << std::endl;
+      if (lock >= 0) close(lock);
+      lock = -1;
+      return -1;
+    }
+
+    /** a socket still accepting connections is not removed **/
+    Int_t fd = Connect(name);
+    if (fd >= 0) {
+      close(fd);
+      LOG(ERROR) << "Generator server already running: " << name << std::endl;
+      close(lock);
+      lock = -1;
+      return -1;
+    }
+    unlink(name.c_str());
+    
+    /** the socket is created private to the user **/
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    auto mask = umask(S_IRWXG | S_IRWXO);
+    Bool_t bound = fd >= 0 && bind(fd, (struct sockaddr *)&address, sizeof(address)) == 0;
+    umask(mask);
+    if (!bound || listen(fd, 16) < 0) {
+      LOG(ERROR) << "Cannot listen on socket " << name << ": " << strerror(errno) << std::endl;
+      if (fd >= 0) close(fd);
+      close(lock);
+      lock = -1;
+      return -1;
+    }
+    return fd;
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  GeneratorDaemon::ReadRequest(Int_t fd, Request_t &request, std::string &config)
+  {
+    /** read request **/
+
+    if (!ReadFully(fd, &request, sizeof(request))) return kFALSE;
+    if (request.magic != fgMagic || request.version != fgVersion) return kFALSE;
+    if (request.configSize > 16 * 1024 * 1024) return kFALSE;
+    request.kind[sizeof(request.kind) - 1] = '\0';
+    request.shmName[sizeof(request.shmName) - 1] = '\0';
+    config.resize(request.configSize);
+    if (!ReadFully(fd, &config[0], config.size())) return kFALSE;
+    return request.hash == Hash(request.kind, config);
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  GeneratorDaemon::WriteReply(Int_t fd, Int_t status, Bool_t reused)
+  {
+    /** write reply **/
+
+    Reply_t reply;
+    reply.magic = fgMagic;
+    reply.status = status;
+    reply.reused = reused;
+    reply.pid = getpid();
+    return WriteFully(fd, &reply, sizeof(reply));
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  GeneratorDaemon::SendClient(Int_t channel, Int_t client, const Request_t &request, Bool_t reused)
+  {
+    /** send client, the descriptor travels as ancillary data **/
+
+    struct {
+      Request_t request;
+      Int_t reused;
+    } message = {request, reused};
+    struct iovec iov = {&message, sizeof(message)};
+    union {
+      struct cmsghdr align;
+      Char_t buffer[CMSG_SPACE(sizeof(Int_t))];
+    } control;
+    memset(&control, 0, sizeof(control));
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buffer;
+    msg.msg_controllen = sizeof(control.buffer);
+    auto cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(Int_t));
+    memcpy(CMSG_DATA(cmsg), &client, sizeof(Int_t));
+    while (true) {
+      auto n = sendmsg(channel, &msg, MSG_NOSIGNAL);
+      if (n < 0 && errno == EINTR) continue;
+      return n == (ssize_t)sizeof(message);
+    }
+  }
+
+  /*****************************************************************/
+
+  Int_t
+  GeneratorDaemon::ReceiveClient(Int_t channel, Request_t &request, Bool_t &reused)
+  {
+    /** receive client, -1 when the channel is closed **/
+
+    struct {
+      Request_t request;
+      Int_t reused;
+    } message;
+    struct iovec iov = {&message, sizeof(message)};
+    union {
+      struct cmsghdr align;
+      Char_t buffer[CMSG_SPACE(sizeof(Int_t))];
+    } control;
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buffer;
+    msg.msg_controllen = sizeof(control.buffer);
+    ssize_t n;
+    do n = recvmsg(channel, &msg, 0);
+    while (n < 0 && errno == EINTR);
+    if (n != (ssize_t)sizeof(message)) return -1;
+    auto cmsg = CMSG_FIRSTHDR(&msg);
+    if (!cmsg || cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) return -1;
+    Int_t client;
+    memcpy(&client, CMSG_DATA(cmsg), sizeof(Int_t));
+    request = message.request;
+    reused = message.reused;
+    return client;
+  }
+
+  /*****************************************************************/
+
+  Int_t
+  GeneratorDaemon::Connect(const std::string &name)
+  {
+    /** connect **/
+
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (name.size() >= sizeof(address.sun_path)) return -1;
+    strncpy(address.sun_path, name.c_str(), sizeof(address.sun_path) - 1);
+    Int_t fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    if (connect(fd, (struct sockaddr *)&address, sizeof(address)) < 0) {
+      close(fd);
+      return -1;
+    }
+    return fd;
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  GeneratorDaemon::Spawn(const std::string &name)
+  {
+    /** spawn the server, detached from this job **/
+
+    auto path = getenv("O2SIM_ROOT");
+    if (!path) return kFALSE;
+    std::string cmd = std::string(path) + "/bin/ro2sim-gend";
+    std::string log = name + ".log";
+
+    /** double fork, the server is not a child of this job **/
+    Int_t pid = fork();
+    if (pid < 0) return kFALSE;
+    if (pid == 0) {
+      setsid();
+      if (fork() != 0) _exit(0);
+      Int_t fd = open(log.c_str(), O_WRONLY | O_CREAT | O_APPEND, S_IRUSR | S_IWUSR);
+      if (fd >= 0) {
+	dup2(fd, STDOUT_FILENO);
+	dup2(fd, STDERR_FILENO);
+	close(fd);
+      }
+      execl(cmd.c_str(), "ro2sim-gend", name.c_str(), (Char_t *)NULL);
+      _exit(1);
+    }
+    waitpid(pid, NULL, 0);
+    LOG(INFO) << "Generator server started: " << name << std::endl;
+    return kTRUE;
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  GeneratorDaemon::ReadFully(Int_t fd, void *buffer, ULong64_t size)
+  {
+    /** read fully **/
+
+    auto data = (Char_t *)buffer;
+    while (size > 0) {
+      auto n = read(fd, data, size);
+      if (n < 0 && errno == EINTR) continue;
+      if (n <= 0) return kFALSE;
+      data += n;
+      size -= n;
+    }
+    return kTRUE;
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  GeneratorDaemon::WriteFully(Int_t fd, const void *buffer, ULong64_t size)
+  {
+    /** write fully **/
+
+    auto data = (const Char_t *)buffer;
+    while (size > 0) {
+      auto n = write(fd, data, size);
+      if (n < 0 && errno == EINTR) continue;
+      if (n <= 0) return kFALSE;
+      data += n;
+      size -= n;
+    }
+    return kTRUE;
+  }
+
+  /*****************************************************************/
+  /*****************************************************************/
+    
+} /* namespace eventgen */
+} /* namespace o2 */
@@ -0,0 +1,99 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See https://alice-o2.web.cern.ch/ for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \author R+Preghenella - September 2017
+
+
+#ifndef ALICEO2_EVENTGEN_GENERATORDAEMON_H_
+#define ALICEO2_EVENTGEN_GENERATORDAEMON_H_
+
+#include "Rtypes.h"
+#include <string>
+
+namespace o2
+{
+namespace eventgen
+{
+
+  /*****************************************************************/
+  /*****************************************************************/
+
+  /** local generator server protocol. a request carries the
+      generator kind and its configuration without the seed, the
+      ro2sim-gend server keeps one initialised generator per
+      configuration hash and streams the events of each request
+      into the requested shared-memory ring from a forked copy **/
+  
+  class GeneratorDaemon
+  {
+    
+  public:
+
+    /** packed messages **/
+    struct Request_t {
+      UInt_t    magic;
+      UInt_t    version;
+      Char_t    kind[16];
+      UInt_t    seed;         // 0 for a seed drawn by the server
+      UInt_t    configSize;   // configuration text that follows
+      ULong64_t hash;         // of kind and configuration
+      ULong64_t shmSize;      // [bytes]
+      Char_t    shmName[256];
+    };
+    struct Reply_t {
+      UInt_t magic;
+      Int_t  status;
+      Int_t  reused;          // generator was already initialised
+      Int_t  pid;             // of the writer process
+    };
+    enum EStatus_t {
+      kStatusOK = 0,
+      kStatusBadRequest,
+      kStatusInitFailed,
+      kStatusForkFailed
+    };
+
+    /** client methods **/
+    static std::string GetSocketName();
+    static ULong64_t Hash(const std::string &kind, const std::string &config);
+    static Bool_t Request(const std::string &kind, const std::string &config, UInt_t seed,
+			  const std::string &shmName, ULong64_t shmSize, Bool_t autostart = kTRUE);
+
+    /** server methods. the server holds the lock file for its
+	whole lifetime, a stale socket is only removed under it **/
+    static Int_t Listen(const std::string &name, Int_t &lock);
+    static Bool_t ReadRequest(Int_t fd, Request_t &request, std::string &config);
+    static Bool_t WriteReply(Int_t fd, Int_t status, Bool_t reused);
+
+    /** pass a client connection and its request to the process
+	holding the generator, over a SOCK_SEQPACKET channel **/
+    static Bool_t SendClient(Int_t channel, Int_t client, const Request_t &request, Bool_t reused);
+    static Int_t ReceiveClient(Int_t channel, Request_t &request, Bool_t &reused);
+    
+  protected:
+
+    /** methods **/
+    static Int_t Connect(const std::string &name);
+    static Bool_t Spawn(const std::string &name);
+    static Bool_t ReadFully(Int_t fd, void *buffer, ULong64_t size);
+    static Bool_t WriteFully(Int_t fd, const void *buffer, ULong64_t size);
+
+    static const UInt_t fgMagic = 0x6f326764; // "o2gd"
+    static const UInt_t fgVersion = 1;
+    
+  }; /** class GeneratorDaemon **/
+  
+  /*****************************************************************/
+  /*****************************************************************/
+    
+} /** namespace eventgen **/
+} /** namespace o2 **/
+
+#endif /* ALICEO2_EVENTGEN_GENERATORDAEMON_H_ */ 
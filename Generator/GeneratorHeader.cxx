@@ -28,6 +28,9 @@ namespace eventgen
     fTrackOffset(0),
     fNumberOfTracks(0),
     fNumberOfAttempts(0),
+    fTimeOffset(0.),
+    fSubEvent(0),
+    fInfoMask(0),
     fInfo()
   {
     /** default constructor **/
@@ -41,6 +44,9 @@ namespace eventgen
     fTrackOffset(0),
     fNumberOfTracks(0),
     fNumberOfAttempts(0),
+    fTimeOffset(0.),
+    fSubEvent(0),
+    fInfoMask(0),
     fInfo()
   {
     /** constructor **/
@@ -54,9 +60,15 @@ namespace eventgen
     fTrackOffset(rhs.fTrackOffset),
     fNumberOfTracks(rhs.fNumberOfTracks),
     fNumberOfAttempts(rhs.fNumberOfAttempts),
-    fInfo(rhs.fInfo)
+    fTimeOffset(rhs.fTimeOffset),
+    fSubEvent(rhs.fSubEvent),
+    fInfoMask(0),
+    fInfo()
   {
-    /** copy constructor **/
+    /** copy constructor, the info is deep copied **/
+
+    CopyInfo<CrossSectionInfo>(rhs);
+    CopyInfo<HeavyIonInfo>(rhs);
 
   }
 
@@ -72,7 +84,10 @@ namespace eventgen
     fTrackOffset = rhs.fTrackOffset;
     fNumberOfTracks = rhs.fNumberOfTracks;
     fNumberOfAttempts = rhs.fNumberOfAttempts;
-    fInfo = rhs.fInfo;
+    fTimeOffset = rhs.fTimeOffset;
+    fSubEvent = rhs.fSubEvent;
+    CopyInfo<CrossSectionInfo>(rhs);
+    CopyInfo<HeavyIonInfo>(rhs);
     return *this;
   }
 
@@ -82,6 +97,8 @@ namespace eventgen
   {
     /** default destructor **/
 
+    for (auto &info : fInfo)
+      if (info) delete info;
   }
 
   /*****************************************************************/
@@ -94,8 +111,10 @@ namespace eventgen
     fTrackOffset = 0;
     fNumberOfTracks = 0;
     fNumberOfAttempts = 0;
+    fTimeOffset = 0.;
+    fSubEvent = 0;
     for (auto &info : fInfo) 
-      info.second->Reset();
+      if (info) info->Reset();
   }
 
   /*****************************************************************/
@@ -108,9 +127,11 @@ namespace eventgen
     auto name = GetName();
     auto offset = GetTrackOffset();
     auto ntracks = GetNumberOfTracks();
-    std::cout << ">> generator: " << name << " | tracks: " << offset  << " -> " << offset + ntracks - 1 << std::endl;
-    for (auto const &info : fInfo) 
-      info.second->Print();
+    std::cout << ">> generator: " << name << " | sub-event: " << fSubEvent << " | tracks: " << offset  << " -> " << offset + ntracks - 1;
+    if (fTimeOffset != 0.) std::cout << " | time offset: " << fTimeOffset * 1.e9 << " ns";
+    std::cout << std::endl;
+    for (Int_t type = 0; type < GeneratorInfo::kNInfoTypes; type++)
+      if (HasInfo(type)) fInfo[type]->Print();
   }
 
   /*****************************************************************/
@@ -120,9 +141,7 @@ namespace eventgen
   {
     /** get cross-section info **/
 
-    std::string key = CrossSectionInfo::KeyName();
-    if (!fInfo.count(key)) return NULL;
-    return dynamic_cast<CrossSectionInfo *>(fInfo.at(key));
+    return GetInfo<CrossSectionInfo>();
   }
   
   /*****************************************************************/
@@ -132,10 +151,7 @@ namespace eventgen
   {
     /** add cross-section info **/
 
-    std::string key = CrossSectionInfo::KeyName();
-    if (!fInfo.count(key))
-      fInfo[key] = new CrossSectionInfo();
-    return static_cast<CrossSectionInfo *>(fInfo.at(key));
+    return AddInfo<CrossSectionInfo>();
   }
   
   /*****************************************************************/
@@ -145,7 +161,7 @@ namespace eventgen
   {
     /** remove cross-section info **/
     
-    RemoveGeneratorInfo(CrossSectionInfo::KeyName());
+    RemoveGeneratorInfo(CrossSectionInfo::kTypeId);
   }
   
   /*****************************************************************/
@@ -155,9 +171,7 @@ namespace eventgen
   {
     /** get heavy-ion info **/
 
-    std::string key = HeavyIonInfo::KeyName();
-    if (!fInfo.count(key)) return NULL;
-    return dynamic_cast<HeavyIonInfo *>(fInfo.at(key));
+    return GetInfo<HeavyIonInfo>();
   }
   
   /*****************************************************************/
@@ -165,12 +179,9 @@ namespace eventgen
   HeavyIonInfo *
   GeneratorHeader::AddHeavyIonInfo()
   {
-    /** add cross-section info **/
+    /** add heavy-ion info **/
 
-    std::string key = HeavyIonInfo::KeyName();
-    if (!fInfo.count(key))
-      fInfo[key] = new HeavyIonInfo();
-    return static_cast<HeavyIonInfo *>(fInfo.at(key));
+    return AddInfo<HeavyIonInfo>();
   }
   
   /*****************************************************************/
@@ -178,9 +189,9 @@ namespace eventgen
   void
   GeneratorHeader::RemoveHeavyIonInfo()
   {
-    /** remove cross-section info **/
+    /** remove heavy-ion info **/
     
-    RemoveGeneratorInfo(HeavyIonInfo::KeyName());
+    RemoveGeneratorInfo(HeavyIonInfo::kTypeId);
   }
   
   /*****************************************************************/
@@ -15,14 +15,13 @@
 #define ALICEO2_EVENTGEN_GENERATORHEADER_H_
 
 #include "TNamed.h"
-#include <map>
+#include "GeneratorInfo.h"
 
 namespace o2
 {
 namespace eventgen
 {
 
-  class GeneratorInfo;
   class CrossSectionInfo;
   class HeavyIonInfo;
   
@@ -49,18 +48,25 @@ namespace eventgen
     Int_t GetTrackOffset() const {return fTrackOffset;};
     Int_t GetNumberOfTracks() const {return fNumberOfTracks;};
     Int_t GetNumberOfAttempts() const {return fNumberOfAttempts;};
+    Double_t GetTimeOffset() const {return fTimeOffset;};
+    Int_t GetSubEvent() const {return fSubEvent;};
     CrossSectionInfo *GetCrossSectionInfo() const;
     HeavyIonInfo *GetHeavyIonInfo() const;
+    template <typename T> T *GetInfo() const {return HasInfo(T::kTypeId) ? static_cast<T *>(fInfo[T::kTypeId]) : nullptr;};
+    Bool_t HasInfo(Int_t type) const {return fInfoMask & (1 << type);};
     
     /** setters **/
     void SetTrackOffset(Int_t val) {fTrackOffset = val;};
     void SetNumberOfTracks(Int_t val) {fNumberOfTracks = val;};
     void SetNumberOfAttempts(Int_t val) {fNumberOfAttempts = val;};
+    void SetTimeOffset(Double_t val) {fTimeOffset = val;};
+    void SetSubEvent(Int_t val) {fSubEvent = val;};
     
     /** methods **/
     void Print(Option_t *opt = "") const override;
     virtual void Reset();
-    void RemoveGeneratorInfo(const std::string &key) {if (fInfo.count(key)) fInfo.erase(key);};
+    template <typename T> T *AddInfo();
+    void RemoveGeneratorInfo(Int_t type) {fInfoMask &= ~(1 << type);};
     CrossSectionInfo *AddCrossSectionInfo();
     void RemoveCrossSectionInfo();
     HeavyIonInfo *AddHeavyIonInfo();
@@ -72,11 +78,44 @@ namespace eventgen
     Int_t fTrackOffset;
     Int_t fNumberOfTracks;
     Int_t fNumberOfAttempts;
-    std::map<std::string, GeneratorInfo *> fInfo;
+    Double_t fTimeOffset;                              // of the collision in the timeframe [s]
+    Int_t fSubEvent;                                   // generator event within the transport event
+    Int_t fInfoMask;                                   // bit set of the present info types
+    GeneratorInfo *fInfo[GeneratorInfo::kNInfoTypes];  // one slot per type, kept once allocated
+
+    /** methods **/
+    template <typename T> void CopyInfo(const GeneratorHeader &rhs);
     
-    ClassDefOverride(GeneratorHeader, 1);
+    ClassDefOverride(GeneratorHeader, 2);
 
   }; /** class GeneratorHeader **/
+
+  /*****************************************************************/
+
+  template <typename T>
+  T *
+  GeneratorHeader::AddInfo()
+  {
+    /** add info, the slot is allocated at the first use and
+	reused afterwards, removing only clears the presence bit **/
+    
+    if (!fInfo[T::kTypeId]) fInfo[T::kTypeId] = new T();
+    fInfoMask |= 1 << T::kTypeId;
+    return static_cast<T *>(fInfo[T::kTypeId]);
+  }
+  
+  /*****************************************************************/
+
+  template <typename T>
+  void
+  GeneratorHeader::CopyInfo(const GeneratorHeader &rhs)
+  {
+    /** copy info **/
+
+    auto info = rhs.GetInfo<T>();
+    if (info) *AddInfo<T>() = *info;
+    else RemoveGeneratorInfo(T::kTypeId);
+  }
   
   /*****************************************************************/
   /*****************************************************************/
@@ -17,13 +17,20 @@
 #include "Trigger/TriggerHepMC.h"
 #include "FairLogger.h"
 #include "FairPrimaryGenerator.h"
-#include "HepMC/ReaderAscii.h"
-#include "HepMC/ReaderAsciiHepMC2.h"
+#include "ReaderSharedMemory.h"
+#include "ReaderQueue.h"
+#include "ReaderSelection.h"
+#include "EventIndex.h"
+#include "HepMCFile.h"
+#include "DecompressionBuffer.h"
 #include "HepMC/GenEvent.h"
 #include "HepMC/GenParticle.h"
 #include "HepMC/GenVertex.h"
 #include "HepMC/FourVector.h"
+#include "TDirectory.h"
+#include "TParameter.h"
 #include <cmath>
+#include <sys/stat.h>
 
 namespace o2
 {
@@ -35,11 +42,21 @@ namespace eventgen
 
   GeneratorHepMC::GeneratorHepMC() :
     Generator("ALICEo2", "ALICEo2 HepMC Generator"),
-    fStream(),
     fFileName(),
     fVersion(3),
+    fFormat(kFormatAscii),
     fReader(NULL),
-    fEvent(NULL)
+    fEvent(NULL),
+    fFile(NULL),
+    fReadAhead(0),
+    fQueue(NULL),
+    fFirstEvent(0),
+    fSkipEvents(0),
+    fStride(1),
+    fRandom(kFALSE),
+    fRandomSeed(0),
+    fIndex(NULL),
+    fSelection(NULL)
   {
     /** default constructor **/
 
@@ -49,11 +66,21 @@ namespace eventgen
 
   GeneratorHepMC::GeneratorHepMC(const Char_t *name, const Char_t *title) :
     Generator(name, title),
-    fStream(),
     fFileName(),
     fVersion(3),
+    fFormat(kFormatAscii),
     fReader(NULL),
-    fEvent(NULL)
+    fEvent(NULL),
+    fFile(NULL),
+    fReadAhead(0),
+    fQueue(NULL),
+    fFirstEvent(0),
+    fSkipEvents(0),
+    fStride(1),
+    fRandom(kFALSE),
+    fRandomSeed(0),
+    fIndex(NULL),
+    fSelection(NULL)
   {
     /** constructor **/
 
@@ -65,12 +92,15 @@ namespace eventgen
   {
     /** default destructor **/
 
-    if (fStream.is_open()) fStream.close();
+    /** the reader thread is stopped before the reader goes away **/
+    if (fQueue) delete fQueue;
+    else if (fEvent) delete fEvent;
     if (fReader) {
       fReader->close();
       delete fReader;
     }
-    if (fEvent) delete fEvent;
+    if (fFile) delete fFile;
+    if (fIndex) delete fIndex;
   }
 
   /*****************************************************************/
@@ -80,10 +110,8 @@ namespace eventgen
   {
     /** generate event **/
 
-    /** clear and read event **/
-    fEvent->clear();
-    fReader->read_event(*fEvent);
-    if(fReader->failed()) return kFALSE;      
+    /** read event **/
+    if (!ReadHepMCEvent()) return kFALSE;
     /** set units to desired output **/
     fEvent->set_units(HepMC::Units::GEV, HepMC::Units::CM);
 
@@ -93,6 +121,22 @@ namespace eventgen
   
   /*****************************************************************/
 
+  Bool_t
+  GeneratorHepMC::ReadHepMCEvent()
+  {
+    /** read HepMC event, from the read-ahead queue if any **/
+
+    if (fQueue) {
+      fEvent = fQueue->Next(fEvent);
+      return fEvent != NULL;
+    }
+    fEvent->clear();
+    fReader->read_event(*fEvent);
+    return !fReader->failed();
+  }
+  
+  /*****************************************************************/
+
   Bool_t
   GeneratorHepMC::TriggerFired(Trigger *trigger) const
   {
@@ -111,21 +155,21 @@ namespace eventgen
   /*****************************************************************/
 
   Bool_t
-  GeneratorHepMC::AddTracks(FairPrimaryGenerator *primGen) const
+  GeneratorHepMC::FillParticles(ParticleBuffer &buffer) const
   {
-    /** add tracks **/
+    /** fill particles **/
     
-    /** loop over particles **/
-    auto particles = fEvent->particles();
+    /** loop over particles, parents and children are
+	looked up through the vertices to avoid temporaries **/
+    auto const &particles = fEvent->particles();
     for (auto const &particle : particles) {
       
       /** get particle information **/
       auto pdg = particle->pid();
       auto st = particle->status();
-      auto momentum = particle->momentum();
-      auto vertex = particle->production_vertex()->position();
-      auto parents = particle->parents(); // less efficient than via vertex
-      auto children = particle->children(); // less efficient than via vertex
+      auto const &momentum = particle->momentum();
+      auto const &production = particle->production_vertex();
+      auto const &end = particle->end_vertex();
       
       /** get momentum information **/
       auto px = momentum.x();
@@ -134,22 +178,28 @@ namespace eventgen
       auto et = momentum.t();
       
       /** get vertex information **/
-      auto vx = vertex.x();
-      auto vy = vertex.y();
-      auto vz = vertex.z();
-      auto vt = vertex.t() * 3.33564095198152022e-11; // [cm -> s]
+      Double_t vx = 0., vy = 0., vz = 0., vt = 0.;
+      if (production) {
+	auto const &vertex = production->position();
+	vx = vertex.x();
+	vy = vertex.y();
+	vz = vertex.z();
+	vt = vertex.t() * 3.33564095198152022e-11; // [cm -> s]
+      }
       
       /** get mother information **/
-      auto mm = parents.empty() ? -1 : parents.front()->id() - 1;
+      auto mm = -1;
+      if (production && !production->particles_in().empty())
+	mm = production->particles_in().front()->id() - 1;
       
       /** get weight information [WIP] **/
       auto ww = 1.;
       
       /** set want tracking [WIP] **/
-      auto wt = children.empty();
+      auto wt = !end || end->particles_out().empty();
 
-      /* add track */
-      primGen->AddTrack(pdg, px, py, pz, vx, vy, vz, mm, wt, et, vt, ww);
+      /* add particle */
+      buffer.AddParticle(pdg, st, px, py, pz, et, vx, vy, vz, vt, mm, wt, ww);
       
     } /** end of loop over particles **/
     
@@ -160,25 +210,25 @@ namespace eventgen
   /*****************************************************************/
 
   Bool_t
-  GeneratorHepMC::AddHeader(PrimaryGenerator *primGen) const
+  GeneratorHepMC::FillHeader(GeneratorHeader *header) const
   {
-    /** add header **/
+    /** fill header **/
 
     /** add cross-section info **/
     auto cs = fEvent->cross_section();
     if (cs && cs->is_valid()) {
-      auto crossSection = fHeader->AddCrossSectionInfo();
+      auto crossSection = header->AddCrossSectionInfo();
       crossSection->SetCrossSection(cs->cross_section);
       crossSection->SetCrossSectionError(cs->cross_section_error);
       crossSection->SetAcceptedEvents(cs->accepted_events);
       crossSection->SetAttemptedEvents(cs->attempted_events);
     }
-    else fHeader->RemoveCrossSectionInfo();
+    else header->RemoveCrossSectionInfo();
     
     /** add heavy-ion info **/
     auto hi = fEvent->heavy_ion();
     if (hi && hi->is_valid()) {
-      auto heavyIon = fHeader->AddHeavyIonInfo();
+      auto heavyIon = header->AddHeavyIonInfo();
       heavyIon->SetNcollHard(hi->Ncoll_hard);
       heavyIon->SetNpartProj(hi->Npart_proj);
       heavyIon->SetNpartTarg(hi->Npart_targ);
@@ -191,28 +241,23 @@ namespace eventgen
       heavyIon->SetSigmaNN(hi->sigma_inel_NN);
       heavyIon->SetCentrality(hi->centrality);
     }
-    else fHeader->RemoveHeavyIonInfo();
+    else header->RemoveHeavyIonInfo();
     
     /** success **/
-    return Generator::AddHeader(primGen);
+    return kTRUE;
   }
   
   /*****************************************************************/
 
   Bool_t
-  GeneratorHepMC::BoostEvent(Double_t boost)
+  GeneratorHepMC::SaveGeneratorState(TDirectory *dir) const
   {
-    /** boost **/
-
-    /** loop over particles **/
-    if (std::abs(boost) < 1.e-6) return kTRUE;
-    auto particles = fEvent->particles();
-    for (auto &particle : particles) {
-      auto momentum = GetBoostedVector(particle->momentum(), boost);
-      particle->set_momentum(momentum);
-      auto position = GetBoostedVector(particle->production_vertex()->position(), boost);
-      particle->production_vertex()->set_position(position);
-    }
+    /** save generator state, the seed of the random selection
+	as it may have been drawn from the system **/
+
+    if (!fSelection || !fRandom) return kTRUE;
+    TParameter<Long64_t> seed("hepmc.seed", fSelection->GetSeed());
+    if (dir->WriteTObject(&seed) <= 0) return kFALSE;
 
     /** success **/
     return kTRUE;
@@ -220,24 +265,65 @@ namespace eventgen
   
   /*****************************************************************/
 
-  const HepMC::FourVector
-  GeneratorHepMC::GetBoostedVector(const HepMC::FourVector &vector, Double_t boost)
+  Bool_t
+  GeneratorHepMC::LoadGeneratorState(TDirectory *dir, Long64_t events)
   {
-    /** boost **/
-
-    auto x = vector.x();
-    auto y = vector.y();
-    auto z = vector.z();
-    auto t = vector.t();
-    auto coshb = std::cosh(boost);
-    auto sinhb = std::sinh(boost);
-    auto xx = x;
-    auto yy = y;
-    auto zz = z * coshb - t * sinhb;
-    auto tt = t * coshb - z * sinhb;
-    return HepMC::FourVector(xx, yy, zz, tt);
-  }
+    /** load generator state. with an event index the selection is
+	restarted after the events read up to the checkpoint, otherwise
+	they are read through. fifos and shared-memory rings written
+	by a live generator cannot be resumed **/
 
+    if (events == 0) return kTRUE;
+    if (fFile && fFile->GetAsciiStream()) {
+      
+      /** the events read ahead are dropped **/
+      delete fQueue;
+      fQueue = NULL;
+
+      /** the random draws are repeated from the saved seed **/
+      if (fRandom) {
+	auto seed = dynamic_cast<TParameter<Long64_t> *>(dir->Get("hepmc.seed"));
+	if (!seed) {
+	  LOG(ERROR) << "Cannot find random selection seed of \"" << GetName() << "\" generator" << std::endl;
+	  return kFALSE;
+	}
+	fRandomSeed = seed->GetVal();
+	delete seed;
+	if (!fSelection->SetRandom(fRandomSeed)) return kFALSE;
+      }
+
+      /** select the events after the checkpoint **/
+      if (fSelection && !fSelection->Restart(events)) return kFALSE;
+      if (!fSelection) {
+	fSkipEvents = events;
+	if (!InitSelection()) return kFALSE;
+      }
+      LOG(INFO) << "Skipped " << events << " events of \"" << GetName() << "\" generator through the event index" << std::endl;
+      
+      if (fReadAhead > 0) {
+	fQueue = new ReaderQueue(fReader, fReadAhead);
+	return fQueue->Start();
+      }
+      return kTRUE;
+    }
+    
+    /** a live writer would generate new events rather than resume **/
+    if (!IsRegularFile()) {
+      LOG(ERROR) << "Cannot resume \"" << GetName() << "\" generator, input is not a regular file: " << fFileName << std::endl;
+      return kFALSE;
+    }
+    LOG(INFO) << "Skipping " << events << " events of \"" << GetName() << "\" generator" << std::endl;
+    for (Long64_t ievent = 0; ievent < events; ievent++) {
+      if (!ReadHepMCEvent()) {
+	LOG(ERROR) << "Input ended while skipping to event " << events << ": " << fFileName << std::endl;
+	return kFALSE;
+      }
+    }
+    
+    /** success **/
+    return kTRUE;
+  }
+  
   /*****************************************************************/
 
   Bool_t
@@ -245,32 +331,105 @@ namespace eventgen
   {
     /** init **/
 
-    /** open file **/
-    fStream.open(fFileName);
-    if (!fStream.is_open()) {
-      LOG(ERROR) << "Cannot open input file: " << fFileName << std::endl;
-      return kFALSE;
-    }
-    
-    /** create reader according to HepMC version **/
-    switch (fVersion) {
-    case 2:
-      fStream.close();
-      fReader = new HepMC::ReaderAsciiHepMC2(fFileName);
-      break;
-    case 3:
-      fReader = new HepMC::ReaderAscii(fStream);
-      break;
-    default:
-      LOG(ERROR) << "Unsupported HepMC version: " << fVersion << std::endl;
-      return kFALSE;
+    /** shared-memory ring written by an external process **/
+    if (fFormat == kFormatSharedMemory)
+      fReader = new ReaderSharedMemory(fFileName);
+
+    /** file, the type is detected from the content **/
+    else {
+      fFile = new HepMCFile();
+      fReader = fFile->CreateReader(fFileName, fVersion);
+      if (!fReader) return kFALSE;
     }
+    if (fReader->failed()) return kFALSE;
+
+    /** event selection **/
+    if (!InitSelection()) return kFALSE;
 
+    /** read ahead in a dedicated thread, the queue owns the events.
+	only regular files, the thread could block forever on a fifo **/
+    if (fReadAhead > 0 && !IsRegularFile()) {
+      LOG(WARNING) << "Read-ahead disabled for \"" << GetName() << "\" generator, input is not a regular file: " << fFileName << std::endl;
+      fReadAhead = 0;
+    }
+    if (fReadAhead > 0) {
+      fQueue = new ReaderQueue(fReader, fReadAhead);
+      LOG(INFO) << "Started read-ahead for \"" << GetName() << "\" generator: depth = " << fReadAhead << std::endl;
+      return fQueue->Start();
+    }
+    
     /** create event **/
     fEvent = new HepMC::GenEvent();
 
     /** success **/
-    return !fReader->failed();
+    return kTRUE;
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  GeneratorHepMC::IsRegularFile() const
+  {
+    /** is regular file, not a fifo nor a shared-memory ring **/
+
+    struct stat info;
+    return fFormat != kFormatSharedMemory && stat(fFileName.c_str(), &info) == 0 && S_ISREG(info.st_mode);
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  GeneratorHepMC::InitSelection()
+  {
+    /** init selection, plain HepMC3 ascii files are read through the
+	event index, the other inputs are read through in order **/
+
+    if (fFirstEvent == 0 && fSkipEvents == 0 && fStride == 1 && !fRandom) return kTRUE;
+    auto selection = new ReaderSelection(fReader, fFirstEvent, fSkipEvents, fStride);
+    fReader = fSelection = selection;
+    auto stream = fFile ? fFile->GetAsciiStream() : NULL;
+    if (stream) {
+      fIndex = new EventIndex();
+      if (!fIndex->Init(fFileName)) return kFALSE;
+      selection->SetIndex(stream, fIndex);
+    }
+    if (fRandom && !selection->SetRandom(fRandomSeed)) return kFALSE;
+    LOG(INFO) << "Selecting events of \"" << GetName() << "\" generator:"
+	      << " first event = " << fFirstEvent
+	      << " | skip = " << fSkipEvents
+	      << " | stride = " << fStride
+	      << " | random = " << (fRandom ? "true" : "false")
+	      << " | indexed = " << (fIndex ? "true" : "false")
+	      << std::endl;
+
+    /** success **/
+    return kTRUE;
+  }
+
+  /*****************************************************************/
+
+  void
+  GeneratorHepMC::PrintCounters() const
+  {
+    /** print counters **/
+
+    if (fQueue)
+      LOG(INFO) << "Read-ahead counters for \"" << GetName() << "\" generator:"
+		<< " depth = " << fQueue->GetDepth()
+		<< " | events = " << fQueue->GetEvents()
+		<< " | average fill level = " << fQueue->GetFillLevel()
+		<< " | stalls = " << fQueue->GetStalls()
+		<< " | stall time = " << fQueue->GetStallTime() << " s"
+		<< " | read time = " << fQueue->GetReadTime() << " s"
+		<< std::endl;
+    auto buffer = fFile ? fFile->GetBuffer() : NULL;
+    if (buffer && buffer->GetBytesIn() > 0)
+      LOG(INFO) << "Decompression counters for \"" << GetName() << "\" generator:"
+		<< " compressed = " << buffer->GetBytesIn() << " bytes"
+		<< " | uncompressed = " << buffer->GetBytesOut() << " bytes"
+		<< " | ratio = " << (Double_t)buffer->GetBytesOut() / buffer->GetBytesIn()
+		<< std::endl;
+    Generator::PrintCounters();
   }
 
   /*****************************************************************/
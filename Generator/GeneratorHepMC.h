@@ -15,7 +15,7 @@
 #define ALICEO2_EVENTGEN_GENERATORHEPMC_H_
 
 #include "Generator.h"
-#include <fstream>
+#include <string>
 
 namespace HepMC {
   class Reader;
@@ -28,14 +28,29 @@ namespace o2
 namespace eventgen
 {
 
+  class HepMCFile;
+  class ReaderQueue;
+  class EventIndex;
+  class ReaderSelection;
+  
   /*****************************************************************/
   /*****************************************************************/
     
+  /** HepMC event input from a file, HepMC2/3 ascii, HepMC3 ROOT
+      tree or native columnar, or from a shared-memory ring. the events
+      can be read ahead by a dedicated thread through a bounded queue,
+      and a selection of them can be read through an event index **/
+  
   class GeneratorHepMC : public Generator
   {
     
   public:
 
+    enum EFormat_t {
+      kFormatAscii,
+      kFormatSharedMemory
+    };
+    
     /** default constructor **/
     GeneratorHepMC();
     /** constructor **/
@@ -46,9 +61,16 @@ namespace eventgen
     /** Initialize the generator if needed **/
     virtual Bool_t Init() override;
 
+    /** methods **/
+    void PrintCounters() const override;
+
     /** setters **/
     void SetVersion(Int_t val) {fVersion = val;};
     void SetFileName(std::string val) {fFileName = val;};
+    void SetFormat(EFormat_t val) {fFormat = val;};
+    void SetReadAhead(Int_t val) {fReadAhead = val;};
+    void SetSelection(Long64_t first, Long64_t skip, Long64_t stride) {fFirstEvent = first; fSkipEvents = skip; fStride = stride;};
+    void SetRandom(Bool_t val, UInt_t seed = 0) {fRandom = val; fRandomSeed = seed;};
 
   protected:
 
@@ -59,22 +81,40 @@ namespace eventgen
 
     /** methods to override **/
     Bool_t GenerateEvent() override;
-    Bool_t BoostEvent(Double_t boost) override;
     Bool_t TriggerFired(Trigger *trigger) const override;
-    Bool_t AddTracks(FairPrimaryGenerator *primGen) const override;
-    
+    Bool_t FillParticles(ParticleBuffer &buffer) const override;
+    Bool_t FillHeader(GeneratorHeader *header) const override;
+    Bool_t SaveGeneratorState(TDirectory *dir) const override;
+    Bool_t LoadGeneratorState(TDirectory *dir, Long64_t events) override;
+
     /** methods **/
-    Bool_t AddHeader(PrimaryGenerator *primGen) const override;
-    const HepMC::FourVector GetBoostedVector(const HepMC::FourVector &vector, Double_t boost);
+    Bool_t ReadHepMCEvent();
+    Bool_t InitSelection();
+    Bool_t IsRegularFile() const;
 
     /** HepMC interface **/
-    std::ifstream fStream;
     std::string fFileName;
     Int_t fVersion;
+    EFormat_t fFormat;
     HepMC::Reader *fReader;
     HepMC::GenEvent *fEvent;
+
+    /** input file and read-ahead queue, the events
+	are owned by the queue when reading ahead **/
+    HepMCFile *fFile;              //!
+    Int_t fReadAhead;
+    ReaderQueue *fQueue;           //!
+
+    /** event selection, first_event + (skip + i) * stride **/
+    Long64_t fFirstEvent;
+    Long64_t fSkipEvents;
+    Long64_t fStride;
+    Bool_t fRandom;
+    UInt_t fRandomSeed;
+    EventIndex *fIndex;            //!
+    ReaderSelection *fSelection;   //! the reader, if selecting
     
-    ClassDefOverride(GeneratorHepMC, 1);
+    ClassDefOverride(GeneratorHepMC, 2);
     
   }; /** class GeneratorHepMC **/
   
@@ -28,6 +28,13 @@ namespace eventgen
   {
     
   public:
+
+    /** type ids, one fixed slot per type in the generator header **/
+    enum EInfoType_t {
+      kCrossSectionInfo,
+      kHeavyIonInfo,
+      kNInfoTypes
+    };
     
     /** default constructor **/
     GeneratorInfo();
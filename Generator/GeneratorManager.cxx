@@ -12,10 +12,15 @@
 
 #include "GeneratorManager.h"
 #include "PrimaryGenerator.h"
+#include "Generator.h"
 #include "MCEventHeader.h"
 #include "Core/GeneratorManagerDelegate.h"
+#include "Core/Profiler.h"
 #include "FairRunSim.h"
 #include "FairPrimaryGenerator.h"
+#include "TDirectory.h"
+#include <algorithm>
+#include <cmath>
 
 namespace o2sim
 {
@@ -24,19 +29,51 @@ namespace o2sim
   /*****************************************************************/
 
   GeneratorManager::GeneratorManager() :
-    RunManagerDelegate()
+    RunManagerDelegate(),
+    fBatchSize(1),
+    fCheckpointing(kFALSE)
   {
     /** deafult constructor **/
 
     /** register values **/
     RegisterValue("diamond_xyz", "0., 0., 0.");
     RegisterValue("diamond_sigma_xyz", "0., 0., 0.");
-    RegisterValue("embed_into");
+    RegisterPath("embed_into");
+    RegisterValue("embed_index", "on");
+    RegisterValue("embed_policy", "sequential");
+    RegisterValue("embed_reuse", "1");
+    RegisterValue("prefetch", "0");
+    RegisterValue("pileup_mu", "0.");
+    RegisterValue("pileup_bunches", "3564");
+    RegisterValue("pileup_spacing", "25.");
+    RegisterValue("pileup_filling");
+    RegisterValue("pileup_skip_empty", "off");
     
   }
   
   /*****************************************************************/
   
+  Bool_t
+  GeneratorManager::UsesThreads() const
+  {
+    /** uses threads, the prefetch also turned on by pileup and the
+	embedding prefetching the next background file. the embedding
+	files are only expanded at init, any embedding counts **/
+
+    Int_t prefetch = 0;
+    Double_t mu = 0.;
+    if (GetValue("prefetch", prefetch) && prefetch > 0) return kTRUE;
+    if (GetValue("pileup_mu", mu) && mu > 0.) return kTRUE;
+    if (!IsNull("embed_into")) return kTRUE;
+    for (auto const &x : DelegateMap()) {
+      auto delegate = dynamic_cast<GeneratorManagerDelegate *>(x.second);
+      if (delegate && delegate->IsActive() && delegate->UsesThreads()) return kTRUE;
+    }
+    return kFALSE;
+  }
+
+  /*****************************************************************/
+  
   Bool_t
   GeneratorManager::Init() const
   {
@@ -51,20 +88,62 @@ namespace o2sim
 
     /** create primary generator **/
     o2eg::PrimaryGenerator *primGen = new o2eg::PrimaryGenerator();
+    primGen->InitProfiling();
 
     /** create MC event header **/
     o2eg::MCEventHeader *eventHeader = new o2eg::MCEventHeader();
+
+    /** prefetch depth **/
+    Int_t prefetch;
+    if (!GetValue("prefetch", prefetch) || prefetch < 0) {
+      LOG(FATAL) << "Cannot parse \"" << "prefetch" << "\": " << GetValue("prefetch") << std::endl;
+      return kFALSE;
+    }
+
+    /** pileup, the collisions are generated in parallel
+	ahead of the event unless a prefetch depth is given **/
+    if (!SetupPileup(primGen)) return kFALSE;
+    if (primGen->IsPileup() && prefetch == 0)
+      prefetch = std::min(1024, (Int_t)std::ceil(primGen->GetPileupMean()));
+
+    /** batch size, set from the simulation manager **/
+    if (fBatchSize > 1 && primGen->IsPileup()) {
+      LOG(FATAL) << "Batching is not supported with pileup" << std::endl;
+      return kFALSE;
+    }
+    primGen->SetBatchSize(fBatchSize);
+
+    /** events generated ahead cannot be checkpointed, refused
+	here rather than at the first checkpoint **/
+    if (fCheckpointing && prefetch > 0) {
+      LOG(FATAL) << "Checkpointing is not supported with prefetch"
+		 << (primGen->IsPileup() ? ", which is turned on by pileup" : "") << std::endl;
+      return kFALSE;
+    }
     
     /** loop over all delegates **/
     for (auto const &x : DelegateMap()) {
       auto delegate = dynamic_cast<GeneratorManagerDelegate *>(x.second);
       if (!delegate || !delegate->IsActive()) continue;
       LOG(INFO) << "Initialising \"" << x.first << "\" manager (" << GetDelegateClassName(x.first) << ")" << std::endl;
+      auto start = Profiler::Now();
       auto generator = delegate->Init();      
       if (!generator) {
 	LOG(ERROR) << "Failed initialising \"" << x.first << "\" manager" << std::endl;
 	return kFALSE;
       }
+      auto entry = Profiler::Instance().GetEntry(std::string("init.generator.") + x.first.Data());
+      if (entry) entry->Add(1, Profiler::Now() - start);
+      /** setup prefetch and profiling **/
+      auto o2generator = dynamic_cast<o2eg::Generator *>(generator);
+      if (o2generator) {
+	o2generator->SetPrefetchDepth(prefetch);
+	o2generator->InitProfiling();
+	if (fCheckpointing && !o2generator->IsCheckpointable()) {
+	  LOG(FATAL) << "Checkpointing is not supported with instances: \"" << x.first << "\" manager" << std::endl;
+	  return kFALSE;
+	}
+      }
       /** add generator **/
       primGen->AddGenerator(generator);
       LOG(INFO) << "Added generator from \"" << x.first << "\" delegate" << std::endl;
@@ -96,6 +175,17 @@ namespace o2sim
       return kFALSE;
     }
 
+    /** print generator counters **/
+    auto primGen = runsim->GetPrimaryGenerator();
+    auto o2primGen = dynamic_cast<o2eg::PrimaryGenerator *>(primGen);
+    if (o2primGen) o2primGen->FinishProfiling();
+    if (primGen && primGen->GetListOfGenerators()) {
+      for (auto const &x : *primGen->GetListOfGenerators()) {
+	auto generator = dynamic_cast<o2eg::Generator *>(x);
+	if (generator) generator->PrintCounters();
+      }
+    }
+    
     /** loop over all delegates **/
     for (auto const &x : DelegateMap()) {
       auto delegate = dynamic_cast<GeneratorManagerDelegate *>(x.second);
@@ -112,6 +202,77 @@ namespace o2sim
   
   /*****************************************************************/
 
+  void
+  GeneratorManager::SetWorker(Int_t worker, Int_t nworkers)
+  {
+    /** set worker, passed on to the generator delegates **/
+
+    for (auto const &x : DelegateMap()) {
+      auto delegate = dynamic_cast<GeneratorManagerDelegate *>(x.second);
+      if (delegate) delegate->SetWorker(worker, nworkers);
+    }
+  }
+  
+  /*****************************************************************/
+
+  Bool_t
+  GeneratorManager::SaveState(TDirectory *dir) const
+  {
+    /** save state **/
+
+    /** primary generator **/
+    auto runsim = FairRunSim::Instance();
+    auto primGen = dynamic_cast<o2eg::PrimaryGenerator *>(runsim ? runsim->GetPrimaryGenerator() : nullptr);
+    if (!primGen || !primGen->SaveState(dir)) {
+      LOG(ERROR) << "Failed saving state of primary generator" << std::endl;
+      return kFALSE;
+    }
+
+    /** generators, the others only depend on gRandom **/
+    Int_t igenerator = 0;
+    for (auto const &x : *primGen->GetListOfGenerators()) {
+      auto generator = dynamic_cast<o2eg::Generator *>(x);
+      auto subdir = dir->mkdir(Form("generator%d", igenerator++));
+      if (generator && !generator->SaveState(subdir)) return kFALSE;
+    }
+    
+    /** success **/
+    return kTRUE;
+  }
+  
+  /*****************************************************************/
+
+  Bool_t
+  GeneratorManager::LoadState(TDirectory *dir) const
+  {
+    /** load state **/
+
+    /** primary generator **/
+    auto runsim = FairRunSim::Instance();
+    auto primGen = dynamic_cast<o2eg::PrimaryGenerator *>(runsim ? runsim->GetPrimaryGenerator() : nullptr);
+    if (!primGen || !primGen->LoadState(dir)) {
+      LOG(ERROR) << "Failed loading state of primary generator" << std::endl;
+      return kFALSE;
+    }
+
+    /** generators **/
+    Int_t igenerator = 0;
+    for (auto const &x : *primGen->GetListOfGenerators()) {
+      auto generator = dynamic_cast<o2eg::Generator *>(x);
+      auto subdir = dir->GetDirectory(Form("generator%d", igenerator++));
+      if (!generator) continue;
+      if (!subdir || !generator->LoadState(subdir)) {
+	LOG(ERROR) << "Failed loading state of \"" << generator->GetName() << "\" generator" << std::endl;
+	return kFALSE;
+      }
+    }
+    
+    /** success **/
+    return kTRUE;
+  }
+  
+  /*****************************************************************/
+
   Bool_t
   GeneratorManager::ConfigurePrimaryGenerator(o2eg::PrimaryGenerator *primGen) const
   {
@@ -122,12 +283,27 @@ namespace o2sim
 
     /** check embed into **/
     if (!IsNull("embed_into")) {
+      if (primGen->IsPileup() || primGen->GetBatchSize() > 1) {
+	LOG(FATAL) << "Embedding is not supported with pileup or batching" << std::endl;
+	return kFALSE;
+      }
       TString embed_into = GetValue("embed_into");
-      if (gSystem->ExpandPathName(embed_into)) {
-	LOG(FATAL) << "Cannot expand \"" << "embed_into" << "\": " << embed_into << std::endl;
+      /** access policy **/
+      if (IsValue("embed_policy", "sequential")) primGen->SetEmbedPolicy(o2eg::PrimaryGenerator::kEmbedSequential);
+      else if (IsValue("embed_policy", "shuffled")) primGen->SetEmbedPolicy(o2eg::PrimaryGenerator::kEmbedShuffled);
+      else if (IsValue("embed_policy", "random")) primGen->SetEmbedPolicy(o2eg::PrimaryGenerator::kEmbedRandom);
+      else {
+	LOG(FATAL) << "Invalid embed_policy: " << GetValue("embed_policy") << std::endl;
+	return kFALSE;
+      }
+      Int_t reuse;
+      if (!GetValue("embed_reuse", reuse) || reuse < 1) {
+	LOG(FATAL) << "Cannot parse \"" << "embed_reuse" << "\": " << GetValue("embed_reuse") << std::endl;
 	return kFALSE;
       }
-      if (!primGen->EmbedInto(embed_into)) {
+      primGen->SetEmbedReuse(reuse);
+      /** files are expanded by the primary generator **/
+      if (!primGen->EmbedInto(embed_into, !IsValue("embed_index", "off"))) {
 	LOG(FATAL) << "Cannot embed into " << embed_into << std::endl;
 	return kFALSE;
       }
@@ -164,6 +340,39 @@ namespace o2sim
     return kTRUE;
   }
 
+  /*****************************************************************/
+
+  Bool_t
+  GeneratorManager::SetupPileup(o2eg::PrimaryGenerator *primGen) const
+  {
+    /** setup pileup **/
+
+    Double_t mu, spacing;
+    Int_t nbunches;
+    if (!GetValue("pileup_mu", mu) || mu < 0.) {
+      LOG(FATAL) << "Cannot parse \"" << "pileup_mu" << "\": " << GetValue("pileup_mu") << std::endl;
+      return kFALSE;
+    }
+    if (mu == 0.) return kTRUE;
+    if (!GetValue("pileup_bunches", nbunches)) {
+      LOG(FATAL) << "Cannot parse \"" << "pileup_bunches" << "\": " << GetValue("pileup_bunches") << std::endl;
+      return kFALSE;
+    }
+    if (!GetValue("pileup_spacing", spacing)) {
+      LOG(FATAL) << "Cannot parse \"" << "pileup_spacing" << "\": " << GetValue("pileup_spacing") << std::endl;
+      return kFALSE;
+    }
+    /** spacing is given in [ns] **/
+    if (!primGen->SetPileup(mu, nbunches, spacing * 1.e-9, GetValue("pileup_filling"))) {
+      LOG(FATAL) << "Cannot setup pileup" << std::endl;
+      return kFALSE;
+    }
+    primGen->SetPileupSkipEmpty(IsValue("pileup_skip_empty", "on"));
+
+    /** success **/
+    return kTRUE;
+  }
+
   /*****************************************************************/
   /*****************************************************************/
   
@@ -39,11 +39,21 @@ namespace o2sim {
     /** methods **/
     Bool_t Init() const override;
     Bool_t Terminate() const override;
+    Bool_t SaveState(TDirectory *dir) const override;
+    Bool_t LoadState(TDirectory *dir) const override;
+    void SetBatchSize(Int_t val) override {fBatchSize = val;};
+    void SetWorker(Int_t worker, Int_t nworkers) override;
+    void SetCheckpointing(Bool_t val) override {fCheckpointing = val;};
+    Bool_t UsesThreads() const override;
     
   private:
 
     Bool_t ConfigurePrimaryGenerator(o2eg::PrimaryGenerator *primGen) const;
     Bool_t SetupInteractionDiamond(o2eg::PrimaryGenerator *primGen) const;
+    Bool_t SetupPileup(o2eg::PrimaryGenerator *primGen) const;
+
+    Int_t fBatchSize;        //!
+    Bool_t fCheckpointing;   //!
     
     ClassDefOverride(GeneratorManager, 1)
       
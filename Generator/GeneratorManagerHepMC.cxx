@@ -0,0 +1,139 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See https://alice-o2.web.cern.ch/ for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \author R+Preghenella - September 2017
+
+#include "GeneratorManagerHepMC.h"
+#include "GeneratorHepMC.h"
+#include "HepMCFile.h"
+#include "FairLogger.h"
+
+namespace o2sim
+{
+
+  /*****************************************************************/
+  /*****************************************************************/
+  
+  GeneratorManagerHepMC::GeneratorManagerHepMC() :
+    GeneratorManagerDelegate()
+  {
+    /** deafult constructor **/
+
+    /** register values **/
+    RegisterPath("file_name");
+    RegisterValue("version", "3");
+    RegisterValue("read_ahead", "32");
+    RegisterValue("first_event", "0");
+    RegisterValue("skip", "0");
+    RegisterValue("stride", "1");
+    RegisterValue("random", "false");
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  GeneratorManagerHepMC::UsesThreads() const
+  {
+    /** uses threads, the read-ahead thread reads
+	ROOT objects only from a HepMC3 ROOT tree **/
+
+    Int_t read_ahead = 0;
+    TString file_name;
+    if (!GetValue("read_ahead", read_ahead) || read_ahead == 0) return kFALSE;
+    if (!GetPath("file_name", file_name)) return kFALSE;
+    return o2::eventgen::HepMCFile::DetectFileType(file_name.Data()) == o2::eventgen::HepMCFile::kFileRootTree;
+  }
+
+  /*****************************************************************/
+
+  FairGenerator *
+  GeneratorManagerHepMC::Init() const
+  {
+    /** init **/
+
+    Int_t version, read_ahead, stride;
+    UInt_t seed;
+    
+    /** file name **/
+    if (IsNull("file_name")) {
+      LOG(ERROR) << "Missing HepMC file name" << std::endl;
+      return NULL;
+    }
+    TString file_name;
+    if (!GetPath("file_name", file_name)) {
+      LOG(ERROR) << "Cannot expand HepMC file name: " << GetValue("file_name") << std::endl;
+      return NULL;
+    }
+    /** version, used for ascii input without detectable header **/
+    if (!GetValue("version", version) || (version != 2 && version != 3)) {
+      LOG(ERROR) << "Invalid HepMC version: " << GetValue("version") << std::endl;
+      return NULL;
+    }
+    /** read-ahead depth, 0 reads in the calling thread **/
+    if (!GetValue("read_ahead", read_ahead) || read_ahead < 0) {
+      LOG(ERROR) << "Invalid read-ahead depth: " << GetValue("read_ahead") << std::endl;
+      return NULL;
+    }
+
+    /** event selection, parallel jobs read disjoint slices
+	of one input with different first events or skips **/
+    TString first_event = GetValue("first_event");
+    if (!first_event.IsDigit()) {
+      LOG(ERROR) << "Invalid first event: " << first_event << std::endl;
+      return NULL;
+    }
+    TString skip = GetValue("skip");
+    if (!skip.IsDigit()) {
+      LOG(ERROR) << "Invalid number of events to skip: " << skip << std::endl;
+      return NULL;
+    }
+    if (!GetValue("stride", stride) || stride < 1) {
+      LOG(ERROR) << "Invalid stride: " << GetValue("stride") << std::endl;
+      return NULL;
+    }
+    if (!GetSeed(seed)) return NULL;
+
+    /** forked workers read interleaved slices of the selection,
+	the skipped events are taken before the slicing **/
+    Long64_t first = first_event.Atoll(), nskip = skip.Atoll(), nstride = stride;
+    if (fNWorkers > 1) {
+      first += (nskip + fWorker) * nstride;
+      nskip = 0;
+      nstride *= fNWorkers;
+      LOG(INFO) << "HepMC input of worker " << fWorker << ": first event = " << first << " | stride = " << nstride << std::endl;
+    }
+
+    /** create generator **/
+    auto generator = new o2::eventgen::GeneratorHepMC(GetValue("name"));
+    generator->SetFileName(file_name.Data());
+    generator->SetVersion(version);
+    generator->SetReadAhead(read_ahead);
+    generator->SetSelection(first, nskip, nstride);
+    generator->SetRandom(IsValue("random", "true"), seed);
+    
+    /** success **/
+    return generator;
+  }
+  
+  /*****************************************************************/
+
+  Bool_t
+  GeneratorManagerHepMC::Terminate() const
+  {
+    /** terminate **/
+
+    /** success **/
+    return kTRUE;
+  }
+
+  /*****************************************************************/
+  /*****************************************************************/
+
+} /** namespace o2sim **/
@@ -0,0 +1,49 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See https://alice-o2.web.cern.ch/ for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \author R+Preghenella - September 2017
+
+#ifndef ALICEO2SIM_GENERATORMANAGERHEPMC_H_
+#define ALICEO2SIM_GENERATORMANAGERHEPMC_H_
+
+#include "Core/GeneratorManagerDelegate.h"
+
+namespace o2sim {
+
+  /*****************************************************************/
+  /*****************************************************************/
+
+  /** pre-generated events from a HepMC file, plain or compressed **/
+  
+  class GeneratorManagerHepMC : public GeneratorManagerDelegate
+  {
+
+  public:
+    
+    /** default constructor **/
+    GeneratorManagerHepMC();
+
+    /** methods **/
+    FairGenerator *Init() const override;
+    Bool_t Terminate() const override;
+    Bool_t UsesThreads() const override;
+    
+  private:
+
+    ClassDefOverride(GeneratorManagerHepMC, 1)
+      
+  }; /** class GeneratorManagerHepMC **/
+
+  /*****************************************************************/
+  /*****************************************************************/
+  
+} /** namespace o2sim **/
+
+#endif /* ALICEO2SIM_GENERATORMANAGERHEPMC_H_ */
@@ -12,6 +12,13 @@
 
 #include "GeneratorManagerHijing.h"
 #include "GeneratorTGenerator.h"
+#include "GeneratorHepMC.h"
+#include "GeneratorDaemon.h"
+#include "Trigger/Trigger.h"
+#include <vector>
+#include <sstream>
+#include <iomanip>
+#include <unistd.h>
 #include "THijing.h"
 #include "TSystem.h"
 
@@ -28,6 +35,8 @@ namespace o2sim
 
     /** register values **/
     RegisterValue("b_range", "0.0, 20.0");
+    RegisterValue("interface_mode", "inprocess");
+    RegisterValue("shm_size", "256"); // [MB]
 
     /** default commands **/
     ProcessCommand("decay_table $O2SIM_ROOT/data/hijingdecaytable.dat");
@@ -40,75 +49,220 @@ namespace o2sim
   {
     /** init **/
 
-    /** decay table environment variable **/
-    TString decay_table = GetValue("decay_table");
-    if (gSystem->ExpandPathName(decay_table)) {
-      LOG(FATAL) << "Cannot expand \"" << "decay_table" << "\": " << decay_table << std::endl;
+    /** get rapidity **/
+    Double_t rapidity;
+    if (!GetCMSRapidity(rapidity)) return NULL;
+
+    /** configuration, the same text drives the in-process
+	generator and identifies it in the generator server **/
+    std::ostringstream config;
+    if (!ConfigureCollision(config)) {
+      LOG(ERROR) << "Failed to configure generator collision system" << std::endl;
+      return NULL;
+    }
+    if (!ConfigureBaseline(config)) {
+      LOG(ERROR) << "Failed to configure generator baseline" << std::endl;
       return NULL;
     }
-    gSystem->Setenv("HIJING_DECAY_TABLE", decay_table);
     
-    /** get energy **/
-    Double_t energy;
-    if (!GetCMSEnergy(energy)) return NULL;
-    /** get projectile/target (A, Z) **/
-    Int_t projectileA, projectileZ, targetA, targetZ;
-    if (!GetBeamAZ("projectile", projectileA, projectileZ)) return NULL;
-    if (!GetBeamAZ("target", targetA, targetZ)) return NULL;
+    /** create generator, in-process or from the generator server **/
+    o2::eventgen::Generator *generator = NULL;
+    if (IsValue("interface_mode", "inprocess")) {
+      /** libTHijing comes in with this delegate library **/
+      THijing *hij = CreateHijing(config.str());
+      if (!hij) {
+	LOG(ERROR) << "Failed to initialise in-process generator" << std::endl;
+	return NULL;
+      }
+      auto tgenerator = new o2::eventgen::GeneratorTGenerator(GetValue("name"));
+      tgenerator->SetGenerator(hij);
+      tgenerator->SetPositionUnit(0.1); // [mm -> cm]
+      tgenerator->SetTimeUnit(3.33564095198152022e-12); // [mm/c -> s]
+      generator = tgenerator;
+    }
+    else if (IsValue("interface_mode", "daemon")) {
+      generator = InitDaemon(config.str());
+      if (!generator) {
+	LOG(ERROR) << "Failed to initialise generator server interface" << std::endl;
+	return NULL;
+      }
+    }
+    else {
+      LOG(ERROR) << "Unknown interface_mode: " << GetValue("interface_mode") << std::endl;
+      return NULL;
+    }
+    generator->SetBoost(rapidity);
+
+    /** init trigger **/
+    UInt_t seed;
+    if (!GetSeed(seed)) return NULL;
+    std::vector<o2::eventgen::Trigger *> triggers;
+    if (!InitTrigger(triggers, seed) ||
+	!generator->InitTrigger(triggers, GetValue("trigger_mode"), GetValue("trigger_expression"), seed + triggers.size())) {
+      LOG(ERROR) << "Failed to initialise generator trigger" << std::endl;
+      return NULL;
+    }
     
-    /** parse impact parameter range **/
-    Double_t b[2];
-    TString name = "b_range";
-    if (!GetValue(name, b, 2)) {
-      LOG(FATAL) << "Cannot parse \"" << name << "\": " << GetValue(name) << std::endl;
+    /** success **/
+    return generator;
+  }
+  
+  /*****************************************************************/
+
+  o2::eventgen::Generator *
+  GeneratorManagerHijing::InitDaemon(const std::string &config) const
+  {
+    /** init daemon, the events of an already initialised generator
+	with the same configuration are streamed by the server **/
+
+    UInt_t seed;
+    if (!GetSeed(seed)) return NULL;
+    Int_t size;
+    if (!GetValue("shm_size", size) || size <= 0) {
+      LOG(ERROR) << "Invalid shm_size: " << GetValue("shm_size") << std::endl;
       return NULL;
     }
+    std::string shmName = "/o2sim." + std::to_string(getpid()) + ".hijing." + std::string(GetValue("name").Data());
+    if (!o2::eventgen::GeneratorDaemon::Request("hijing", config, seed, shmName, (ULong64_t)size * 1024 * 1024))
+      return NULL;
+    
+    /** create generator **/
+    auto generator = new o2::eventgen::GeneratorHepMC(GetValue("name"));
+    generator->SetFormat(o2::eventgen::GeneratorHepMC::kFormatSharedMemory);
+    generator->SetFileName(shmName);
+
+    /** success **/
+    return generator;
+  }
+  
+  /*****************************************************************/
+
+  THijing *
+  GeneratorManagerHijing::CreateHijing(const std::string &config)
+  {
+    /** create hijing from the configuration text, one
+	"key values" setting per line **/
+
+    Double_t energy = 0., b[2] = {0., 20.};
+    Int_t projectileA = 0, projectileZ = 0, targetA = 0, targetZ = 0;
+    std::vector<std::pair<Int_t, Int_t>> ihpr2;
+    std::vector<std::pair<Int_t, Double_t>> hipr1;
+    std::istringstream lines(config);
+    std::string line;
+    while (std::getline(lines, line)) {
+      std::istringstream fields(line);
+      std::string key;
+      if (!(fields >> key)) continue;
+      Bool_t ok = kTRUE;
+      if (key == "energy") ok = (Bool_t)(fields >> energy);
+      else if (key == "projectile") ok = (Bool_t)(fields >> projectileA >> projectileZ);
+      else if (key == "target") ok = (Bool_t)(fields >> targetA >> targetZ);
+      else if (key == "b_range") ok = (Bool_t)(fields >> b[0] >> b[1]);
+      else if (key == "decay_table") {
+	std::string decay_table;
+	ok = (Bool_t)(fields >> decay_table);
+	if (ok) gSystem->Setenv("HIJING_DECAY_TABLE", decay_table.c_str());
+      }
+      else if (key == "IHPR2") {
+	Int_t i, val;
+	ok = (Bool_t)(fields >> i >> val);
+	if (ok) ihpr2.push_back({i, val});
+      }
+      else if (key == "HIPR1") {
+	Int_t i;
+	Double_t val;
+	ok = (Bool_t)(fields >> i >> val);
+	if (ok) hipr1.push_back({i, val});
+      }
+      else ok = kFALSE;
+      if (!ok) {
+	LOG(ERROR) << "Invalid Hijing configuration line: " << line << std::endl;
+	return NULL;
+      }
+    }
 
     /** configure and initialise hijing interface **/
-    gSystem->Load("libTHijing");
     THijing *hij = new THijing(energy, "CMS     ", "A       ", "A       ",
 			       projectileA, projectileZ,
 			       targetA, targetZ,
 			       b[0], b[1]);
-    ConfigureBaseline(hij);
+    for (auto const &x : ihpr2) hij->SetIHPR2(x.first, x.second);
+    for (auto const &x : hipr1) hij->SetHIPR1(x.first, x.second);
     hij->Initialize();
+
+    /** success **/
+    return hij;
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  GeneratorManagerHijing::ConfigureCollision(std::ostream &config) const
+  {
+    /** configure collision **/
+
+    /** decay table **/
+    TString decay_table;
+    if (!GetPath("decay_table", decay_table)) {
+      LOG(FATAL) << "Cannot expand \"" << "decay_table" << "\": " << decay_table << std::endl;
+      return kFALSE;
+    }
     
-    /** create generator **/ 
-    auto generator = new o2::eventgen::GeneratorTGenerator(GetValue("name"));
+    /** get energy **/
+    Double_t energy;
+    if (!GetCMSEnergy(energy)) return kFALSE;
+    /** get projectile/target (A, Z) **/
+    Int_t projectileA, projectileZ, targetA, targetZ;
+    if (!GetBeamAZ("projectile", projectileA, projectileZ)) return kFALSE;
+    if (!GetBeamAZ("target", targetA, targetZ)) return kFALSE;
+    
+    /** parse impact parameter range **/
+    Double_t b[2];
+    TString name = "b_range";
+    if (!GetValue(name, b, 2)) {
+      LOG(FATAL) << "Cannot parse \"" << name << "\": " << GetValue(name) << std::endl;
+      return kFALSE;
+    }
 
-    /** configure generator **/
-    generator->SetGenerator(hij);
+    /** configure **/
+    config << std::setprecision(12);
+    config << "decay_table " << decay_table << std::endl;
+    config << "energy " << energy << std::endl;
+    config << "projectile " << projectileA << " " << projectileZ << std::endl;
+    config << "target " << targetA << " " << targetZ << std::endl;
+    config << "b_range " << b[0] << " " << b[1] << std::endl;
 
     /** success **/
-    return generator;
+    return kTRUE;
   }
-  
+
   /*****************************************************************/
 
   Bool_t
-  GeneratorManagerHijing::ConfigureBaseline(THijing *hij) const
+  GeneratorManagerHijing::ConfigureBaseline(std::ostream &config) const
   {
     /** configure baseline **/
 
-    hij->SetIHPR2(2, 3);
-    hij->SetIHPR2(2, 0);
-    hij->SetIHPR2(6, 1);
-    hij->SetIHPR2(12, 3);
-    hij->SetIHPR2(21, 0);
-    hij->SetHIPR1(8, 2.0);
-    hij->SetHIPR1(9, -1.);
-    hij->SetHIPR1(10, -2.5);
-    hij->SetHIPR1(50, kFALSE);
-    hij->SetIHPR2(50, 0);
-    hij->SetIHPR2(4,  1);
-    hij->SetIHPR2(49, 0);
-    hij->SetIHPR2(31, 1);
+    config << "IHPR2 2 3" << std::endl;
+    config << "IHPR2 2 0" << std::endl;
+    config << "IHPR2 6 1" << std::endl;
+    config << "IHPR2 12 3" << std::endl;
+    config << "IHPR2 21 0" << std::endl;
+    config << "HIPR1 8 2.0" << std::endl;
+    config << "HIPR1 9 -1." << std::endl;
+    config << "HIPR1 10 -2.5" << std::endl;
+    config << "HIPR1 50 0" << std::endl;
+    config << "IHPR2 50 0" << std::endl;
+    config << "IHPR2 4 1" << std::endl;
+    config << "IHPR2 49 0" << std::endl;
+    config << "IHPR2 31 1" << std::endl;
 
     /** success **/
     return kTRUE;
   }
 
   /*****************************************************************/
+
   /*****************************************************************/
 
 } /** namespace o2sim **/
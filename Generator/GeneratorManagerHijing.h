@@ -14,9 +14,17 @@
 #define ALICEO2SIM_GENERATORMANAGERHIJING_H_
 
 #include "Core/GeneratorManagerDelegate.h"
+#include <string>
+#include <ostream>
 
 class THijing;
 
+namespace o2 {
+  namespace eventgen {
+    class Generator;
+  }
+}
+
 namespace o2sim {
 
   /*****************************************************************/
@@ -33,10 +41,16 @@ namespace o2sim {
     /** methods **/
     FairGenerator *Init() const override;
     Bool_t Terminate() const override {return kTRUE;};
+
+    /** create and initialise hijing from a configuration text,
+	shared with the generator server **/
+    static THijing *CreateHijing(const std::string &config);
     
   private:
 
-    Bool_t ConfigureBaseline(THijing *hij) const;
+    Bool_t ConfigureCollision(std::ostream &config) const;
+    Bool_t ConfigureBaseline(std::ostream &config) const;
+    o2::eventgen::Generator *InitDaemon(const std::string &config) const;
 
     ClassDefOverride(GeneratorManagerHijing, 1)
       
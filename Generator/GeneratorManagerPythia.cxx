@@ -12,12 +12,24 @@
 
 #include "GeneratorManagerPythia.h"
 #include "GeneratorHepMC.h"
-#include "Core/TriggerManagerDelegate.h"
+#include "GeneratorTGenerator.h"
+#include "GeneratorDaemon.h"
+#include "TPythia8.h"
+#include "Pythia8/Pythia.h"
+#include "Trigger/Trigger.h"
 #include "TSystem.h"
+#include "TRandom.h"
+#include "TDirectory.h"
+#include "TArrayC.h"
 #include <unistd.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <cstdio>
+#include <vector>
+#include <chrono>
+#include <sstream>
+#include <iterator>
+#include <memory>
 
 namespace o2sim
 {
@@ -42,6 +54,9 @@ namespace o2sim
     RegisterValue("decay_radius", "1.");
     RegisterValue("decay_ctau0");
     RegisterValue("decay_ctau");
+    RegisterValue("instances", "1");
+    RegisterValue("interface_mode", "fifo");
+    RegisterValue("shm_size", "64"); // [MB]
   }
 
   /*****************************************************************/
@@ -57,49 +72,120 @@ namespace o2sim
     /** get rapidity **/
     Double_t rapidity;
     if (!GetCMSRapidity(rapidity)) return NULL;
+
+    /** number of instances **/
+    Int_t ninstances;
+    if (!GetValue("instances", ninstances) || ninstances < 1) {
+      LOG(ERROR) << "Invalid number of instances: " << GetValue("instances") << std::endl;
+      return NULL;
+    }
+    if (ninstances > 1 && IsValue("interface_mode", "inprocess")) {
+      LOG(ERROR) << "Multiple instances not supported with in-process interface" << std::endl;
+      return NULL;
+    }
+
+    /** instances need distinct seeds, draw a base seed if not given **/
+    UInt_t seed;
+    if (!GetSeed(seed)) return NULL;
+    if (seed == 0 && ninstances > 1) seed = 1 + gRandom->Integer(800000000);
+    
+    /** create generator instances, the first one is the main generator **/
+    o2::eventgen::Generator *generator = NULL;
+    for (Int_t iinstance = 0; iinstance < ninstances; iinstance++) {
+      auto instance = CreateGenerator(iinstance, seed == 0 ? 0 : seed + iinstance);
+      if (!instance) return NULL;
+      if (!generator) generator = instance;
+      else generator->AddInstance(instance);
+    }
+    
+    /** success **/
+    return generator;
+  }
+  
+  /*****************************************************************/
+
+  o2::eventgen::Generator *
+  GeneratorManagerPythia::CreateGenerator(Int_t instance, UInt_t seed) const
+  {
+    /** create generator **/
+
+    /** startup time **/
+    auto start = std::chrono::steady_clock::now();
+
+    /** get rapidity **/
+    Double_t rapidity;
+    if (!GetCMSRapidity(rapidity)) return NULL;
     
     /** create config **/
-    std::string configFileName = std::string(GetValue("version").Data()) + "." + std::string(GetValue("name").Data()) + ".param";
+    std::string baseName = std::string(GetValue("version").Data()) + "." + std::string(GetValue("name").Data());
+    if (instance > 0) baseName += "." + std::to_string(instance);
+    std::string configFileName = baseName + ".param";
     std::ofstream config(configFileName, std::ofstream::out);
-    if (!ConfigureCollision(config)) {
+    if (!ConfigureRandom(config, seed)) {
+      LOG(ERROR) << "Failed to configure generator random seed" << std::endl;
+      return NULL;
+    }
+    /** the rest of the configuration does not depend on the seed,
+	it is what identifies the generator in the server **/
+    std::ostringstream body;
+    if (!ConfigureCollision(body)) {
       LOG(ERROR) << "Failed to configure generator collision system" << std::endl;
       return NULL;
     }
-    if (!ConfigureBaseline(config)) {
+    if (!ConfigureBaseline(body)) {
       LOG(ERROR) << "Failed to configure generator baseline" << std::endl;
       return NULL;
     }
-    if (!ConfigureTune(config)) {
+    if (!ConfigureTune(body)) {
       LOG(ERROR) << "Failed to configure generator tune" << std::endl;
       return NULL;
     }
-    if (!ConfigureProcess(config)) {
+    if (!ConfigureProcess(body)) {
       LOG(ERROR) << "Failed to configure generator process" << std::endl;
       return NULL;
     }
     /** close config **/
+    config << body.str();
     config.close();
     
-    /** number of events **/
-    Int_t nevents;
-    if (!GetNumberOfEvents(nevents)) return NULL;
-
-    /** create generator **/
-    auto generator = new o2::eventgen::GeneratorHepMC(GetValue("name"));
+    /** create generator, in-process or reading from an interface process **/
+    o2::eventgen::Generator *generator = NULL;
+    if (IsValue("interface_mode", "inprocess")) {
+      generator = CreateInProcess(configFileName);
+      if (!generator) {
+	LOG(ERROR) << "Failed to initialise in-process generator" << std::endl;
+	return NULL;
+      }
+    }
+    else generator = new o2::eventgen::GeneratorHepMC(GetValue("name"));
     generator->SetBoost(rapidity);
     
     /** init trigger **/
-    if (!InitTrigger(generator)) {
+    std::vector<o2::eventgen::Trigger *> triggers;
+    if (!InitTrigger(triggers, seed) ||
+	!generator->InitTrigger(triggers, GetValue("trigger_mode"), GetValue("trigger_expression"), seed + triggers.size())) {
       LOG(ERROR) << "Failed to initialise generator trigger" << std::endl;
       return NULL;
     }
     
-    /** init interface **/
+    /** init interface, from the generator server or a new process **/
+    auto hepmc = dynamic_cast<o2::eventgen::GeneratorHepMC *>(generator);
     Int_t pid;
-    if (!InitInterface(generator, configFileName, pid)) {
+    if (hepmc && IsValue("interface_mode", "daemon")) {
+      if (!InitDaemon(hepmc, baseName, body.str(), seed)) {
+	LOG(ERROR) << "Failed to initialise generator server interface" << std::endl;
+	return NULL;
+      }
+    }
+    else if (hepmc && !InitInterface(hepmc, baseName, pid)) {
       LOG(ERROR) << "Failed to initialise generator interface" << std::endl;
       return NULL;
     }
+
+    /** startup time, the interface process startup shows up in the first event **/
+    auto elapsed = std::chrono::duration<Double_t>(std::chrono::steady_clock::now() - start).count();
+    LOG(INFO) << "Generator " << baseName << " created with " << GetValue("interface_mode")
+	      << " interface in " << elapsed << " s" << std::endl;
     
     /** success **/
     return generator;
@@ -107,6 +193,97 @@ namespace o2sim
   
   /*****************************************************************/
 
+  o2::eventgen::GeneratorTGenerator *
+  GeneratorManagerPythia::CreateInProcess(const std::string &configFileName) const
+  {
+    /** create in-process **/
+
+    if (!IsValue("version", "pythia8")) {
+      LOG(ERROR) << "In-process interface only supported for Pythia8" << std::endl;
+      return NULL;
+    }
+    
+    /** configure and initialise pythia8 interface, the
+	beams are set by the collision section of the file **/
+    std::unique_ptr<TPythia8> py8(new TPythia8());
+    if (!py8->ReadConfigFile(configFileName.c_str())) {
+      LOG(ERROR) << "Cannot read Pythia8 configuration: " << configFileName << std::endl;
+      return NULL;
+    }
+    if (!py8->Pythia8()->init()) {
+      LOG(ERROR) << "Cannot initialise Pythia8" << std::endl;
+      return NULL;
+    }
+
+    /** create generator **/
+    auto generator = new o2::eventgen::GeneratorTGenerator(GetValue("name"));
+    
+    /** configure generator, the interface is only handed over on success **/
+    auto pythia = py8.release();
+    generator->SetGenerator(pythia);
+    generator->SetPositionUnit(0.1); // [mm -> cm]
+    generator->SetTimeUnit(3.33564095198152022e-12); // [mm/c -> s]
+    generator->SetStateHooks([pythia](TDirectory *dir) {return SaveRandomState(pythia, dir);},
+			     [pythia](TDirectory *dir) {return LoadRandomState(pythia, dir);});
+
+    /** success **/
+    return generator;
+  }
+  
+  /*****************************************************************/
+
+  Bool_t
+  GeneratorManagerPythia::SaveRandomState(TPythia8 *py8, TDirectory *dir)
+  {
+    /** save random state, the engine state is only dumped to a file **/
+
+    TString filename = Form("%s/o2sim.rndm.%d", gSystem->TempDirectory(), gSystem->GetPid());
+    if (!py8->Pythia8()->rndm.dumpState(filename.Data())) {
+      LOG(ERROR) << "Failed dumping Pythia8 random state" << std::endl;
+      return kFALSE;
+    }
+    std::ifstream fin(filename.Data(), std::ios::binary);
+    std::vector<Char_t> buffer((std::istreambuf_iterator<Char_t>(fin)), std::istreambuf_iterator<Char_t>());
+    fin.close();
+    gSystem->Unlink(filename);
+    TArrayC state(buffer.size(), buffer.data());
+    if (dir->WriteObject(&state, "pythia8.rndm") <= 0) return kFALSE;
+
+    /** success **/
+    return kTRUE;
+  }
+  
+  /*****************************************************************/
+
+  Bool_t
+  GeneratorManagerPythia::LoadRandomState(TPythia8 *py8, TDirectory *dir)
+  {
+    /** load random state **/
+
+    TArrayC *state = nullptr;
+    dir->GetObject("pythia8.rndm", state);
+    if (!state) {
+      LOG(ERROR) << "Cannot find Pythia8 random state" << std::endl;
+      return kFALSE;
+    }
+    TString filename = Form("%s/o2sim.rndm.%d", gSystem->TempDirectory(), gSystem->GetPid());
+    std::ofstream fout(filename.Data(), std::ios::binary);
+    fout.write(state->GetArray(), state->GetSize());
+    fout.close();
+    delete state;
+    Bool_t retval = py8->Pythia8()->rndm.readState(filename.Data());
+    gSystem->Unlink(filename);
+    if (!retval) {
+      LOG(ERROR) << "Failed reading Pythia8 random state" << std::endl;
+      return kFALSE;
+    }
+    
+    /** success **/
+    return kTRUE;
+  }
+  
+  /*****************************************************************/
+
   Bool_t
   GeneratorManagerPythia::ConfigureCollision(std::ostream &config) const
   {
@@ -141,6 +318,32 @@ namespace o2sim
 
   /*****************************************************************/
 
+  Bool_t
+  GeneratorManagerPythia::ConfigureRandom(std::ostream &config, UInt_t seed) const
+  {
+    /** configure random **/
+
+    /** keep the generator default **/
+    if (seed == 0) return kTRUE;
+    
+    /** pythia6 **/
+    if (IsValue("version", "pythia6")) {
+      config << "MRPY(1) = " << seed << std::endl;
+    }
+    /** pythia8 **/
+    else if (IsValue("version", "pythia8")) {
+      config << "Random:setSeed on" << std::endl;
+      config << "Random:seed " << seed << std::endl;
+    }
+    /** unknown **/
+    else return kFALSE;
+
+    /** success **/
+    return kTRUE;
+  }
+
+  /*****************************************************************/
+
   Bool_t
   GeneratorManagerPythia::ConfigureBaseline(std::ostream &config) const
   {
@@ -546,71 +749,65 @@ namespace o2sim
   /*****************************************************************/
 
   Bool_t
-  GeneratorManagerPythia::InitTrigger(o2::eventgen::GeneratorHepMC *generator) const
+  GeneratorManagerPythia::InitInterface(o2::eventgen::GeneratorHepMC *generator, const std::string &baseName, Int_t &pid) const
   {
-    /** init trigger **/
+    /** init interface **/
 
-    /** check trigger mode **/
-    o2::eventgen::GeneratorHepMC::ETriggerMode_t triggerMode;
-    if (IsNull("trigger_mode") || IsValue("trigger_mode", "OFF")) return kTRUE;
-    else if (IsValue("trigger_mode", "OR")) triggerMode = o2::eventgen::GeneratorHepMC::kTriggerOR;
-    else if (IsValue("trigger_mode", "AND")) triggerMode = o2::eventgen::GeneratorHepMC::kTriggerAND;
-    else {
-      LOG(ERROR) << "Invalid trigger_mode: " << GetValue("trigger_mode") << std::endl;
-      return kFALSE;
-    }
-    generator->SetTriggerMode(triggerMode);
-    
-    /** loop over all delegates **/
-    for (auto const &x : DelegateMap()) {
-      auto delegate = dynamic_cast<TriggerManagerDelegate *>(x.second);
-      if (!delegate || !delegate->IsActive()) continue;
-      LOG(INFO) << "Initialising \"" << x.first << "\" manager (" << GetDelegateClassName(x.first) << ")" << std::endl;
-      auto trigger = delegate->Init();      
-      if (!trigger) {
-	LOG(ERROR) << "Failed initialising \"" << x.first << "\" manager" << std::endl;
+    /** select the event channel **/
+    std::string exe, cmd;
+    std::string param = baseName + ".param";
+    std::string log = baseName + ".log";
+    std::string path = getenv("O2SIM_ROOT");
+    std::vector<std::string> args;
+
+    /** fifo, HepMC2 ascii written by a wrapper script **/
+    if (IsValue("interface_mode", "fifo")) {
+      /** create fifo **/
+      Char_t tmpname[1024];
+      strncpy(tmpname, GetValue("name"), 1024);
+      std::string fifoName = std::tmpnam(tmpname);
+      if (mkfifo(fifoName.c_str(), 0666) < 0) {
+	LOG(ERROR) << "Could not create fifo: " << fifoName << std::endl;
 	return kFALSE;
       }
-      /** add trigger **/
-      generator->AddTrigger(trigger);
-      LOG(INFO) << "Added trigger from \"" << x.first << "\" delegate" << std::endl;
+      /** configure generator **/
+      generator->SetVersion(2);
+      generator->SetFileName(fifoName);
+      /** preparation **/
+      if (IsValue("version", "Pythia6")) exe = "agile-pythia6.sh";
+      else if (IsValue("version", "Pythia8")) exe = "sacrifice-pythia8.sh";
+      else return kFALSE;
+      cmd = path + "/scripts/" + exe;
+      args = {exe, param, fifoName};
     }
 
-    /** success **/
-    return kTRUE;
-  }
-
-  /*****************************************************************/
-
-  Bool_t
-  GeneratorManagerPythia::InitInterface(o2::eventgen::GeneratorHepMC *generator, std::string &configFileName, Int_t &pid) const
-  {
-    /** init interface **/
+    /** shared memory, packed binary events written by ro2sim-pythia8 **/
+    else if (IsValue("interface_mode", "shm")) {
+      if (!IsValue("version", "pythia8")) {
+	LOG(ERROR) << "Shared-memory interface only supported for Pythia8" << std::endl;
+	return kFALSE;
+      }
+      Int_t size;
+      if (!GetValue("shm_size", size) || size <= 0) {
+	LOG(ERROR) << "Invalid shm_size: " << GetValue("shm_size") << std::endl;
+	return kFALSE;
+      }
+      std::string shmName = "/o2sim." + std::to_string(getpid()) + "." + baseName;
+      /** configure generator **/
+      generator->SetFormat(o2::eventgen::GeneratorHepMC::kFormatSharedMemory);
+      generator->SetFileName(shmName);
+      /** preparation **/
+      exe = "ro2sim-pythia8";
+      cmd = path + "/bin/" + exe;
+      args = {exe, param, shmName, std::to_string(size)};
+    }
 
-    /** create fifo **/
-    Char_t tmpname[1024];
-    strncpy(tmpname, GetValue("name"), 1024);
-    std::string fifoName = std::tmpnam(tmpname);
-    if (mkfifo(fifoName.c_str(), 0666) < 0) {
-      LOG(ERROR) << "Could not create fifo: " << fifoName << std::endl;
+    /** unknown **/
+    else {
+      LOG(ERROR) << "Unknown interface_mode: " << GetValue("interface_mode") << std::endl;
       return kFALSE;
     }
 
-    /** configure generator **/
-    generator->SetVersion(2);
-    generator->SetFileName(fifoName);
-    
-    /** preparation **/
-    std::string exe;
-    if (IsValue("version", "Pythia6")) exe = "agile-pythia6.sh";
-    else if (IsValue("version", "Pythia8")) exe = "sacrifice-pythia8.sh";
-    else return kFALSE;
-    std::string path = getenv("O2SIM_ROOT");
-    std::string cmd = path + "/scripts/" + exe;
-    std::string param = configFileName;
-    std::string out = fifoName;
-    std::string log = std::string(GetValue("version").Data()) + "." +  std::string(GetValue("name").Data()) + ".log";
-
     /** fork **/
     pid = fork();
     if (pid == 0) {
@@ -620,9 +817,12 @@ namespace o2sim
       dup2(fd, STDERR_FILENO);
       close(fd);
       /** execute **/
-      Int_t ret = execl(cmd.c_str(), exe.c_str(), param.c_str(), out.c_str(), NULL);
+      std::vector<Char_t *> argv;
+      for (auto &arg : args) argv.push_back(&arg[0]);
+      argv.push_back(NULL);
+      Int_t ret = execv(cmd.c_str(), argv.data());
       /** should not go here **/
-      std::cout << "Unexpected return from execl: " << ret << std::endl;
+      std::cout << "Unexpected return from execv: " << ret << std::endl;
       exit(1);
     }
     LOG(INFO) << "Interface process " << exe << " started: " << pid << std::endl; 
@@ -633,6 +833,36 @@ namespace o2sim
   
   /*****************************************************************/
 
+  Bool_t
+  GeneratorManagerPythia::InitDaemon(o2::eventgen::GeneratorHepMC *generator, const std::string &baseName,
+				     const std::string &config, UInt_t seed) const
+  {
+    /** init daemon, the events of an already initialised generator
+	with the same configuration are streamed by the server **/
+
+    if (!IsValue("version", "pythia8")) {
+      LOG(ERROR) << "Generator server interface only supported for Pythia8" << std::endl;
+      return kFALSE;
+    }
+    Int_t size;
+    if (!GetValue("shm_size", size) || size <= 0) {
+      LOG(ERROR) << "Invalid shm_size: " << GetValue("shm_size") << std::endl;
+      return kFALSE;
+    }
+    std::string shmName = "/o2sim." + std::to_string(getpid()) + "." + baseName;
+    if (!o2::eventgen::GeneratorDaemon::Request("pythia8", config, seed, shmName, (ULong64_t)size * 1024 * 1024))
+      return kFALSE;
+    
+    /** configure generator **/
+    generator->SetFormat(o2::eventgen::GeneratorHepMC::kFormatSharedMemory);
+    generator->SetFileName(shmName);
+
+    /** success **/
+    return kTRUE;
+  }
+  
+  /*****************************************************************/
+
   Bool_t
   GeneratorManagerPythia::Terminate() const
   {
@@ -16,9 +16,14 @@
 #include "Core/GeneratorManagerDelegate.h"
 #include <fstream>
 
+class TPythia8;
+class TDirectory;
+
 namespace o2 {
   namespace eventgen {
+    class Generator;
     class GeneratorHepMC;
+    class GeneratorTGenerator;
   }
 }
 
@@ -42,11 +47,15 @@ namespace o2sim {
   private:
 
     /** init methods **/
-    Bool_t InitTrigger(o2::eventgen::GeneratorHepMC *generator) const;
-    Bool_t InitInterface(o2::eventgen::GeneratorHepMC *generator, std::string &configFileName, Int_t &pid) const;
+    o2::eventgen::Generator *CreateGenerator(Int_t instance, UInt_t seed) const;
+    o2::eventgen::GeneratorTGenerator *CreateInProcess(const std::string &configFileName) const;
+    Bool_t InitInterface(o2::eventgen::GeneratorHepMC *generator, const std::string &baseName, Int_t &pid) const;
+    Bool_t InitDaemon(o2::eventgen::GeneratorHepMC *generator, const std::string &baseName,
+		      const std::string &config, UInt_t seed) const;
     
     /** configuration methods **/
     Bool_t ConfigureCollision(std::ostream &config) const;
+    Bool_t ConfigureRandom(std::ostream &config, UInt_t seed) const;
     Bool_t ConfigureBaseline(std::ostream &config) const;
     Bool_t ConfigureTune(std::ostream &config) const; 
     Bool_t ConfigureProcess(std::ostream &config) const;
@@ -54,6 +63,11 @@ namespace o2sim {
     /** get methods **/
     Bool_t GetPtHat(Double_t &min, Double_t &max) const;
 
+    /** checkpoint hooks of the in-process generator, Pythia8
+	has its own random engine that is not restored with gRandom **/
+    static Bool_t SaveRandomState(TPythia8 *py8, TDirectory *dir);
+    static Bool_t LoadRandomState(TPythia8 *py8, TDirectory *dir);
+
     ClassDefOverride(GeneratorManagerPythia, 1)
       
   }; /** class GeneratorManagerPythia **/
@@ -16,7 +16,6 @@
 #include "TGenerator.h"
 #include "TClonesArray.h"
 #include "TParticle.h"
-#include "THijing.h"
 
 namespace o2
 {
@@ -29,7 +28,11 @@ namespace eventgen
   GeneratorTGenerator::GeneratorTGenerator() :
     Generator("ALICEo2", "ALICEo2 TGenerator Generator"),
     fGenerator(NULL),
-    fParticles(NULL)
+    fParticles(NULL),
+    fPositionUnit(1.),
+    fTimeUnit(1.),
+    fSaveState(),
+    fLoadState()
   {
     /** default constructor **/
 
@@ -40,7 +43,11 @@ namespace eventgen
   GeneratorTGenerator::GeneratorTGenerator(const Char_t *name, const Char_t *title) :
     Generator(name, title),
     fGenerator(NULL),
-    fParticles(NULL)
+    fParticles(NULL),
+    fPositionUnit(1.),
+    fTimeUnit(1.),
+    fSaveState(),
+    fLoadState()
   {
     /** constructor **/
 
@@ -71,17 +78,6 @@ namespace eventgen
 
   /*****************************************************************/
 
-  Bool_t
-  GeneratorTGenerator::BoostEvent(Double_t boost)
-  {
-    /** boost event **/
-
-    LOG(WARNING) << "Boost not implemented yet" << std::endl;
-    return kTRUE;
-  }
-
-  /*****************************************************************/
-
   Bool_t
   GeneratorTGenerator::TriggerFired(Trigger *trigger) const
   {
@@ -99,24 +95,27 @@ namespace eventgen
   /*****************************************************************/
   
   Bool_t
-  GeneratorTGenerator::AddTracks(FairPrimaryGenerator *primGen) const
+  GeneratorTGenerator::FillParticles(ParticleBuffer &buffer) const
   {
-    /** add tracks **/
+    /** fill particles **/
     
     /* loop over particles */
     Int_t nParticles = fParticles->GetEntries();
     TParticle *particle = NULL;
     for (Int_t iparticle = 0; iparticle < nParticles; iparticle++) {
-      particle = (TParticle *)fParticles->At(iparticle);
+      particle = (TParticle *)fParticles->UncheckedAt(iparticle);
       if (!particle) continue;
-      primGen->AddTrack(particle->GetPdgCode(),
-			particle->Px(), particle->Py(), particle->Pz(),
-			particle->Vx(), particle->Vy(), particle->Vz(),
-			particle->GetMother(0),
-			particle->GetStatusCode() == 1,
-			particle->Energy(),
-			particle->T(),
-			particle->GetWeight());
+      buffer.AddParticle(particle->GetPdgCode(),
+			 particle->GetStatusCode(),
+			 particle->Px(), particle->Py(), particle->Pz(),
+			 particle->Energy(),
+			 particle->Vx() * fPositionUnit,
+			 particle->Vy() * fPositionUnit,
+			 particle->Vz() * fPositionUnit,
+			 particle->T() * fTimeUnit,
+			 particle->GetMother(0),
+			 particle->GetStatusCode() == 1,
+			 particle->GetWeight());
     }
     
     /** success **/
@@ -126,12 +125,21 @@ namespace eventgen
   /*****************************************************************/
 
   Bool_t
-  GeneratorTGenerator::AddHeader(PrimaryGenerator *primGen) const
+  GeneratorTGenerator::SaveGeneratorState(TDirectory *dir) const
   {
-    /** add header **/
+    /** save generator state **/
 
-    /** success **/
-    return Generator::AddHeader(primGen);
+    return fSaveState ? fSaveState(dir) : kTRUE;
+  }
+  
+  /*****************************************************************/
+
+  Bool_t
+  GeneratorTGenerator::LoadGeneratorState(TDirectory *dir, Long64_t events)
+  {
+    /** load generator state **/
+
+    return fLoadState ? fLoadState(dir) : kTRUE;
   }
   
   /*****************************************************************/
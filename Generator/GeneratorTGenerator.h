@@ -14,6 +14,7 @@
 #define ALICEO2_EVENTGEN_GENERATORTGENERATOR_H_
 
 #include "Generator.h"
+#include <functional>
 
 class TGenerator;
 class TClonesArray;
@@ -40,6 +41,13 @@ namespace eventgen
 
     /** setters **/
     void SetGenerator(TGenerator *val) {fGenerator = val;};
+    void SetPositionUnit(Double_t val) {fPositionUnit = val;};
+    void SetTimeUnit(Double_t val) {fTimeUnit = val;};
+
+    /** generator-specific state, saved and loaded with the
+	checkpoints, for engines not restored with gRandom **/
+    typedef std::function<Bool_t(TDirectory *)> state_hook_t;
+    void SetStateHooks(const state_hook_t &save, const state_hook_t &load) {fSaveState = save; fLoadState = load;};
 
     /** Initialize the generator if needed **/
     virtual Bool_t Init() override;
@@ -55,16 +63,18 @@ namespace eventgen
 
     /** methods to override **/
     Bool_t GenerateEvent() override;
-    Bool_t BoostEvent(Double_t boost) override;
     Bool_t TriggerFired(Trigger *trigger) const override;
-    Bool_t AddTracks(FairPrimaryGenerator *primGen) const override;
-
-    /** methods **/
-    Bool_t AddHeader(PrimaryGenerator *primGen) const override;
+    Bool_t FillParticles(ParticleBuffer &buffer) const override;
+    Bool_t SaveGeneratorState(TDirectory *dir) const override;
+    Bool_t LoadGeneratorState(TDirectory *dir, Long64_t events) override;
 
     /** TGenerator interface **/
     TGenerator *fGenerator;
     TClonesArray *fParticles;
+    Double_t fPositionUnit; // conversion to [cm]
+    Double_t fTimeUnit;     // conversion to [s]
+    state_hook_t fSaveState;  //!
+    state_hook_t fLoadState;  //!
 
     ClassDefOverride(GeneratorTGenerator, 1);
     
@@ -70,6 +70,7 @@ namespace eventgen
     
     /** statics **/
     static std::string KeyName() {return "heavy-ion";};
+    static constexpr Int_t kTypeId = kHeavyIonInfo;
     
   protected:
 
@@ -0,0 +1,163 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See https://alice-o2.web.cern.ch/ for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \author R+Preghenella - September 2017
+
+#include "HepMCFile.h"
+#include "DecompressionBuffer.h"
+#include "ReaderNative.h"
+#include "FairLogger.h"
+#include "HepMC/ReaderAscii.h"
+#include "HepMC/ReaderAsciiHepMC2.h"
+#ifdef O2SIM_WITH_HEPMC3_ROOTIO
+#include "HepMC/ReaderRootTree.h"
+#endif
+#include <sys/stat.h>
+
+namespace o2
+{
+namespace eventgen
+{
+
+  /*****************************************************************/
+  /*****************************************************************/
+
+  HepMCFile::HepMCFile() :
+    fFileType(kFileUnknown),
+    fFile(),
+    fBuffer(NULL),
+    fInput(NULL)
+  {
+    /** default constructor **/
+
+  }
+
+  /*****************************************************************/
+
+  HepMCFile::~HepMCFile()
+  {
+    /** default destructor **/
+
+    if (fFile.is_open()) fFile.close();
+    if (fInput) delete fInput;
+    if (fBuffer) delete fBuffer;
+  }
+
+  /*****************************************************************/
+
+  HepMCFile::EFileType_t
+  HepMCFile::DetectFileType(const std::string &filename)
+  {
+    /** detect file type from the first bytes of the content,
+	only regular files are looked at to leave fifos untouched **/
+
+    struct stat info;
+    if (stat(filename.c_str(), &info) != 0 || !S_ISREG(info.st_mode)) return kFileUnknown;
+    DecompressionBuffer buffer;
+    if (!buffer.Open(filename)) return kFileUnknown;
+    std::istream input(&buffer);
+    Char_t head[256];
+    input.read(head, sizeof(head));
+    std::string content(head, input.gcount());
+
+    /** binary formats **/
+    if (content.compare(0, 4, "root") == 0) return kFileRootTree;
+    if (content.compare(0, 4, ReaderNative::GetMagic()) == 0) return kFileNative;
+
+    /** ascii formats, the header may follow empty lines **/
+    auto pos = content.find("HepMC::Version ");
+    if (pos != std::string::npos && pos + 15 < content.size()) {
+      if (content[pos + 15] == '2') return kFileAscii2;
+      if (content[pos + 15] == '3') return kFileAscii3;
+    }
+    if (content.find("HepMC::IO_GenEvent") != std::string::npos) return kFileAscii2;
+    if (content.find("HepMC::Asciiv3") != std::string::npos) return kFileAscii3;
+    return kFileUnknown;
+  }
+
+  /*****************************************************************/
+
+  const Char_t *
+  HepMCFile::GetFileTypeName(EFileType_t type)
+  {
+    /** get file type name **/
+
+    switch (type) {
+    case kFileAscii2: return "HepMC2 ascii";
+    case kFileAscii3: return "HepMC3 ascii";
+    case kFileRootTree: return "HepMC3 ROOT tree";
+    case kFileNative: return "native";
+    default: return "unknown";
+    }
+  }
+
+  /*****************************************************************/
+
+  HepMC::Reader *
+  HepMCFile::CreateReader(const std::string &filename, Int_t version)
+  {
+    /** create reader **/
+
+    /** file type, fifos and files without header go by the version **/
+    fFileType = DetectFileType(filename);
+    if (fFileType == kFileUnknown) {
+      switch (version) {
+      case 2: fFileType = kFileAscii2; break;
+      case 3: fFileType = kFileAscii3; break;
+      default:
+	LOG(ERROR) << "Unsupported HepMC version: " << version << std::endl;
+	return NULL;
+      }
+    }
+    auto compression = DecompressionBuffer::Detect(filename);
+    LOG(INFO) << "Reading " << GetFileTypeName(fFileType) << " input ("
+	      << DecompressionBuffer::GetCompressionName(compression) << " compression): " << filename << std::endl;
+
+    /** readers that open the file by name **/
+    if (fFileType == kFileRootTree) {
+#ifdef O2SIM_WITH_HEPMC3_ROOTIO
+      return new HepMC::ReaderRootTree(filename);
+#else
+      LOG(ERROR) << "Cannot read HepMC3 ROOT tree input, built without HepMC3 ROOT I/O: " << filename << std::endl;
+      return NULL;
+#endif
+    }
+    if (fFileType == kFileAscii2) {
+      if (compression != DecompressionBuffer::kCompressionNone) {
+	LOG(ERROR) << "Compressed input not supported for HepMC2 ascii: " << filename << std::endl;
+	return NULL;
+      }
+      return new HepMC::ReaderAsciiHepMC2(filename);
+    }
+
+    /** readers on a stream, compressed files are decompressed on the fly **/
+    std::istream *stream = &fFile;
+    if (compression != DecompressionBuffer::kCompressionNone) {
+      fBuffer = new DecompressionBuffer();
+      if (!fBuffer->Open(filename)) return NULL;
+      fInput = new std::istream(fBuffer);
+      stream = fInput;
+    }
+    else {
+      fFile.open(filename, std::ios::in | std::ios::binary);
+      if (!fFile.is_open()) {
+	LOG(ERROR) << "Cannot open input file: " << filename << std::endl;
+	return NULL;
+      }
+    }
+    if (fFileType == kFileNative) return new ReaderNative(*stream);
+    return new HepMC::ReaderAscii(*stream);
+  }
+
+  /*****************************************************************/
+  /*****************************************************************/
+
+} /* namespace eventgen */
+} /* namespace o2 */
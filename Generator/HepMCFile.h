@@ -0,0 +1,92 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See https://alice-o2.web.cern.ch/ for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \author R+Preghenella - September 2017
+
+#ifndef ALICEO2_EVENTGEN_HEPMCFILE_H_
+#define ALICEO2_EVENTGEN_HEPMCFILE_H_
+
+#include "Rtypes.h"
+#include <fstream>
+#include <string>
+
+namespace HepMC {
+  class Reader;
+}
+
+namespace o2
+{
+namespace eventgen
+{
+
+  class DecompressionBuffer;
+
+  /*****************************************************************/
+  /*****************************************************************/
+
+  /** HepMC event file, the file type is detected from the magic
+      bytes of the content: HepMC2/3 ascii, HepMC3 ROOT tree or the
+      native columnar format. ascii and native files can be gzip,
+      zstd or xz compressed. the input streams are held here and
+      have to outlive the reader that is created on them **/
+
+  class HepMCFile
+  {
+
+  public:
+
+    enum EFileType_t {
+      kFileUnknown,
+      kFileAscii2,
+      kFileAscii3,
+      kFileRootTree,
+      kFileNative
+    };
+
+    /** default constructor **/
+    HepMCFile();
+    /** destructor **/
+    virtual ~HepMCFile();
+
+    /** methods, the reader is owned by the caller. the version
+	is used for the ascii inputs that cannot be detected **/
+    HepMC::Reader *CreateReader(const std::string &filename, Int_t version = 3);
+
+    /** getters **/
+    EFileType_t GetFileType() const {return fFileType;};
+    const DecompressionBuffer *GetBuffer() const {return fBuffer;};
+    std::istream *GetAsciiStream() {return fFileType == kFileAscii3 && fFile.is_open() ? &fFile : NULL;};
+
+    /** static methods **/
+    static EFileType_t DetectFileType(const std::string &filename);
+    static const Char_t *GetFileTypeName(EFileType_t type);
+
+  protected:
+
+    /** copy constructor **/
+    HepMCFile(const HepMCFile &);
+    /** operator= **/
+    HepMCFile &operator=(const HepMCFile &);
+
+    /** data members **/
+    EFileType_t fFileType;
+    std::ifstream fFile;
+    DecompressionBuffer *fBuffer;
+    std::istream *fInput;
+
+  }; /** class HepMCFile **/
+
+  /*****************************************************************/
+  /*****************************************************************/
+
+} /** namespace eventgen **/
+} /** namespace o2 **/
+
+#endif /* ALICEO2_EVENTGEN_HEPMCFILE_H_ */
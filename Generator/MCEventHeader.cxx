@@ -13,6 +13,9 @@
 #include "MCEventHeader.h"
 #include "FairRootManager.h"
 #include "GeneratorHeader.h"
+#include "CrossSectionInfo.h"
+#include "HeavyIonInfo.h"
+#include <algorithm>
 
 namespace o2
 {
@@ -24,9 +27,12 @@ namespace eventgen
 
   MCEventHeader::MCEventHeader() :
     FairMCEventHeader(),
-    fGeneratorHeaders(),
+    fGeneratorRecords(),
+    fSubEventRecords(),
+    fGeneratorNames(),
     fEmbeddingFileName(),
-    fEmbeddingEventCounter(-1)
+    fEmbeddingEventCounter(-1),
+    fHeaderView()
   {
     /** default constructor **/
 
@@ -36,11 +42,14 @@ namespace eventgen
 
   MCEventHeader::MCEventHeader(const MCEventHeader &rhs) :
     FairMCEventHeader(rhs),
-    fGeneratorHeaders(rhs.fGeneratorHeaders),
+    fGeneratorRecords(rhs.fGeneratorRecords),
+    fSubEventRecords(rhs.fSubEventRecords),
+    fGeneratorNames(rhs.fGeneratorNames),
     fEmbeddingFileName(rhs.fEmbeddingFileName),
-    fEmbeddingEventCounter(rhs.fEmbeddingEventCounter)
+    fEmbeddingEventCounter(rhs.fEmbeddingEventCounter),
+    fHeaderView()
   {
-    /** copy constructor **/
+    /** copy constructor, the view is not shared **/
 
   }
 
@@ -53,7 +62,9 @@ namespace eventgen
 
     if (this == &rhs) return *this;
     FairMCEventHeader::operator=(rhs);
-    fGeneratorHeaders = rhs.fGeneratorHeaders;
+    fGeneratorRecords = rhs.fGeneratorRecords;
+    fSubEventRecords = rhs.fSubEventRecords;
+    fGeneratorNames = rhs.fGeneratorNames;
     fEmbeddingFileName = rhs.fEmbeddingFileName;
     fEmbeddingEventCounter = rhs.fEmbeddingEventCounter;
     return *this;
@@ -65,6 +76,8 @@ namespace eventgen
   {
     /** default destructor **/
 
+    for (auto &header : fHeaderView)
+      delete header;
   }
 
   /*****************************************************************/
@@ -74,7 +87,10 @@ namespace eventgen
   {
     /** reset **/
 
-    fGeneratorHeaders.clear();
+    /** the records keep their capacity, the names
+	are kept as the same generators fill every event **/
+    fGeneratorRecords.clear();
+    fSubEventRecords.clear();
     fEmbeddingFileName = "";
     fEmbeddingEventCounter = -1;
     FairMCEventHeader::Reset();
@@ -91,8 +107,9 @@ namespace eventgen
     std::cout << "> event-id: " << eventId
 	      << " | xyz: (" << GetX() << ", " << GetY() << ", " << GetZ() << ")"
 	      << " | N.primaries: " << GetNPrim()
+	      << " | N.sub-events: " << GetNumberOfSubEvents()
 	      << std::endl;
-    for (auto const &header : fGeneratorHeaders) 
+    for (auto const &header : GeneratorHeaders()) 
       header->Print();
   }
 
@@ -101,9 +118,149 @@ namespace eventgen
   void
   MCEventHeader::AddHeader(GeneratorHeader *header)
   {
-    /** add header **/
+    /** add header, copied into a flat record **/
 
-    fGeneratorHeaders.push_back(new GeneratorHeader(*header));
+    /** look up the name, a new generator is appended **/
+    const Char_t *name = header->GetName();
+    Int_t nameIndex = 0;
+    while (nameIndex < (Int_t)fGeneratorNames.size() && fGeneratorNames[nameIndex] != name)
+      nameIndex++;
+    if (nameIndex == (Int_t)fGeneratorNames.size())
+      fGeneratorNames.emplace_back(name);
+
+    fGeneratorRecords.emplace_back();
+    auto &record = fGeneratorRecords.back();
+    record.nameIndex = nameIndex;
+    record.trackOffset = header->GetTrackOffset();
+    record.numberOfTracks = header->GetNumberOfTracks();
+    record.numberOfAttempts = header->GetNumberOfAttempts();
+    record.timeOffset = header->GetTimeOffset();
+    record.subEvent = header->GetSubEvent();
+    record.info = 0;
+    
+    /** cross-section info **/
+    auto crossSection = header->GetCrossSectionInfo();
+    if (crossSection) {
+      record.info |= GeneratorRecord_t::kCrossSection;
+      record.crossSection = crossSection->GetCrossSection();
+      record.crossSectionError = crossSection->GetCrossSectionError();
+      record.acceptedEvents = crossSection->GetAcceptedEvents();
+      record.attemptedEvents = crossSection->GetAttemptedEvents();
+    }
+
+    /** heavy-ion info **/
+    auto heavyIon = header->GetHeavyIonInfo();
+    if (heavyIon) {
+      record.info |= GeneratorRecord_t::kHeavyIon;
+      record.ncollHard = heavyIon->GetNcollHard();
+      record.npartProj = heavyIon->GetNpartProj();
+      record.npartTarg = heavyIon->GetNpartTarg();
+      record.ncoll = heavyIon->GetNcoll();
+      record.nspecNeut = heavyIon->GetNspecNeut();
+      record.nspecProt = heavyIon->GetNspecProt();
+      record.impactParameter = heavyIon->GetImpactParameter();
+      record.eventPlaneAngle = heavyIon->GetEventPlaneAngle();
+      record.eccentricity = heavyIon->GetEccentricity();
+      record.sigmaNN = heavyIon->GetSigmaNN();
+      record.centrality = heavyIon->GetCentrality();
+    }
+  }
+  
+  /*****************************************************************/
+
+  void
+  MCEventHeader::AddSubEvent(Int_t trackOffset, Int_t numberOfTracks, Double_t timeOffset)
+  {
+    /** add sub-event **/
+
+    fSubEventRecords.emplace_back();
+    auto &record = fSubEventRecords.back();
+    record.trackOffset = trackOffset;
+    record.numberOfTracks = numberOfTracks;
+    record.timeOffset = timeOffset;
+  }
+  
+  /*****************************************************************/
+
+  Int_t
+  MCEventHeader::GetNumberOfSubEvents() const
+  {
+    /** number of generator events in the transport event,
+	from the generator records in version 1 files **/
+
+    if (!fSubEventRecords.empty()) return fSubEventRecords.size();
+    Int_t nsubevents = fGeneratorRecords.empty() ? 0 : 1;
+    for (auto const &record : fGeneratorRecords)
+      nsubevents = std::max(nsubevents, record.subEvent + 1);
+    return nsubevents;
+  }
+  
+  /*****************************************************************/
+
+  const Char_t *
+  MCEventHeader::GetGeneratorName(const GeneratorRecord_t &record) const
+  {
+    /** generator name of the record **/
+
+    if (record.nameIndex < 0 || record.nameIndex >= (Int_t)fGeneratorNames.size())
+      return "";
+    return fGeneratorNames[record.nameIndex].c_str();
+  }
+  
+  /*****************************************************************/
+
+  const std::vector<GeneratorHeader *> &
+  MCEventHeader::GeneratorHeaders() const
+  {
+    /** generator headers, filled from the records **/
+
+    /** headers are only allocated when the number of generators grows **/
+    while (fHeaderView.size() < fGeneratorRecords.size())
+      fHeaderView.push_back(new GeneratorHeader());
+    while (fHeaderView.size() > fGeneratorRecords.size()) {
+      delete fHeaderView.back();
+      fHeaderView.pop_back();
+    }
+    
+    /** fill headers **/
+    for (Int_t irecord = 0; irecord < (Int_t)fGeneratorRecords.size(); irecord++) {
+      auto const &record = fGeneratorRecords[irecord];
+      auto header = fHeaderView[irecord];
+      header->Reset();
+      header->SetName(GetGeneratorName(record));
+      header->SetTrackOffset(record.trackOffset);
+      header->SetNumberOfTracks(record.numberOfTracks);
+      header->SetNumberOfAttempts(record.numberOfAttempts);
+      header->SetTimeOffset(record.timeOffset);
+      header->SetSubEvent(record.subEvent);
+      /** cross-section info **/
+      if (record.info & GeneratorRecord_t::kCrossSection) {
+	auto crossSection = header->AddCrossSectionInfo();
+	crossSection->SetCrossSection(record.crossSection);
+	crossSection->SetCrossSectionError(record.crossSectionError);
+	crossSection->SetAcceptedEvents(record.acceptedEvents);
+	crossSection->SetAttemptedEvents(record.attemptedEvents);
+      }
+      else header->RemoveCrossSectionInfo();
+      /** heavy-ion info **/
+      if (record.info & GeneratorRecord_t::kHeavyIon) {
+	auto heavyIon = header->AddHeavyIonInfo();
+	heavyIon->SetNcollHard(record.ncollHard);
+	heavyIon->SetNpartProj(record.npartProj);
+	heavyIon->SetNpartTarg(record.npartTarg);
+	heavyIon->SetNcoll(record.ncoll);
+	heavyIon->SetNspecNeut(record.nspecNeut);
+	heavyIon->SetNspecProt(record.nspecProt);
+	heavyIon->SetImpactParameter(record.impactParameter);
+	heavyIon->SetEventPlaneAngle(record.eventPlaneAngle);
+	heavyIon->SetEccentricity(record.eccentricity);
+	heavyIon->SetSigmaNN(record.sigmaNN);
+	heavyIon->SetCentrality(record.centrality);
+      }
+      else header->RemoveHeavyIonInfo();
+    }
+    
+    return fHeaderView;
   }
   
   /*****************************************************************/
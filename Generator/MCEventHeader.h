@@ -16,6 +16,7 @@
 
 #include "FairMCEventHeader.h"
 #include <vector>
+#include <string>
 
 namespace o2
 {
@@ -32,6 +33,48 @@ namespace eventgen
     
   public:
 
+    /** flat record of a generator header, the records are
+	written as per-field columns of the split branch.
+	the name is an index in the table of generator names **/
+    struct GeneratorRecord_t {
+      enum EInfo_t {
+	kCrossSection = 0x1,
+	kHeavyIon = 0x2
+      };
+      Int_t nameIndex = -1;
+      Int_t trackOffset = 0;
+      Int_t numberOfTracks = 0;
+      Int_t numberOfAttempts = 0;
+      Double_t timeOffset = 0.;  // [s]
+      Int_t subEvent = 0;
+      Int_t info = 0;
+      /** cross-section info **/
+      Double_t crossSection = 0.;
+      Double_t crossSectionError = 0.;
+      Long64_t acceptedEvents = 0;
+      Long64_t attemptedEvents = 0;
+      /** heavy-ion info **/
+      Int_t ncollHard = 0;
+      Int_t npartProj = 0;
+      Int_t npartTarg = 0;
+      Int_t ncoll = 0;
+      Int_t nspecNeut = 0;
+      Int_t nspecProt = 0;
+      Double_t impactParameter = 0.;
+      Double_t eventPlaneAngle = 0.;
+      Double_t eccentricity = 0.;
+      Double_t sigmaNN = 0.;
+      Double_t centrality = 0.;
+    };
+
+    /** track range and time of a sub-event, recorded by the
+	primary generator whatever generators fill it **/
+    struct SubEventRecord_t {
+      Int_t trackOffset = 0;
+      Int_t numberOfTracks = 0;
+      Double_t timeOffset = 0.;  // [s]
+    };
+    
     /** default constructor **/
     MCEventHeader();
     /** copy constructor **/
@@ -41,8 +84,13 @@ namespace eventgen
     /** destructor **/
     virtual ~MCEventHeader();
 
-    /** getters **/
-    const std::vector<GeneratorHeader *> &GeneratorHeaders() const {return fGeneratorHeaders;};
+    /** getters, the generator headers are a view built
+	from the records into objects reused across events **/
+    const std::vector<GeneratorRecord_t> &GeneratorRecords() const {return fGeneratorRecords;};
+    const Char_t *GetGeneratorName(const GeneratorRecord_t &record) const;
+    const std::vector<SubEventRecord_t> &SubEventRecords() const {return fSubEventRecords;};
+    const std::vector<GeneratorHeader *> &GeneratorHeaders() const;
+    Int_t GetNumberOfSubEvents() const;
 
     /** setters **/
     void SetEmbeddingFileName(TString value) {fEmbeddingFileName = value;};
@@ -52,14 +100,21 @@ namespace eventgen
     virtual void Print(Option_t *opt = "") const override;
     virtual void Reset();
     virtual void AddHeader(GeneratorHeader *header);
+    void AddSubEvent(Int_t trackOffset, Int_t numberOfTracks, Double_t timeOffset);
     
   protected:
 
-    std::vector<GeneratorHeader *> fGeneratorHeaders;
+    std::vector<GeneratorRecord_t> fGeneratorRecords;
+    std::vector<SubEventRecord_t> fSubEventRecords;
+    std::vector<std::string> fGeneratorNames;  // kept across events, names are not reallocated
     TString fEmbeddingFileName;
     Int_t   fEmbeddingEventCounter;
+
+    mutable std::vector<GeneratorHeader *> fHeaderView;  //! view of the records
     
-    ClassDefOverride(MCEventHeader, 1);
+    /** version 1 stored the generator headers as objects, they
+	are converted into records by the read rule in the LinkDef **/
+    ClassDefOverride(MCEventHeader, 2);
 
   }; /** class MCEventHeader **/
   
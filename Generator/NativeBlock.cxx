@@ -0,0 +1,212 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See https://alice-o2.web.cern.ch/ for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \author R+Preghenella - September 2017
+
+#include "NativeBlock.h"
+#include "FairLogger.h"
+
+namespace o2
+{
+namespace eventgen
+{
+
+  /*****************************************************************/
+  /*****************************************************************/
+
+  NativeBlock::NativeBlock()
+  {
+    /** default constructor **/
+
+  }
+
+  /*****************************************************************/
+
+  NativeBlock::~NativeBlock()
+  {
+    /** default destructor **/
+
+  }
+
+  /*****************************************************************/
+
+  void
+  NativeBlock::Clear()
+  {
+    /** clear, the columns keep their capacity **/
+
+    for (auto column : {&number, &acceptedEvents, &attemptedEvents})
+      column->clear();
+    for (auto column : {&nParticles, &flags, &nCollHard, &nPartProj, &nPartTarg, &nColl, &nSpecNeut, &nSpecProt, &pdg, &status, &mother})
+      column->clear();
+    for (auto column : {&crossSection, &crossSectionError, &impactParameter, &eventPlaneAngle, &eccentricity, &sigmaNN, &centrality,
+	  &px, &py, &pz, &e, &vx, &vy, &vz, &vt})
+      column->clear();
+  }
+
+  /*****************************************************************/
+
+  template <typename T>
+  Bool_t
+  NativeBlock::ReadColumn(std::istream &stream, std::vector<T> &column, UInt_t n)
+  {
+    /** read column, grown chunk by chunk not to allocate
+	more than a truncated input holds **/
+
+    column.clear();
+    for (UInt_t offset = 0; offset < n;) {
+      UInt_t chunk = n - offset < fgChunkSize ? n - offset : fgChunkSize;
+      column.resize(offset + chunk);
+      stream.read(reinterpret_cast<Char_t *>(column.data() + offset), chunk * sizeof(T));
+      if ((size_t)stream.gcount() != chunk * sizeof(T)) return kFALSE;
+      offset += chunk;
+    }
+
+    /** success **/
+    return kTRUE;
+  }
+
+  /*****************************************************************/
+
+  template <typename T>
+  Bool_t
+  NativeBlock::WriteColumn(std::ostream &stream, const std::vector<T> &column)
+  {
+    /** write column **/
+
+    stream.write(reinterpret_cast<const Char_t *>(column.data()), column.size() * sizeof(T));
+    return stream.good();
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  NativeBlock::Read(std::istream &stream)
+  {
+    /** read, kFALSE at the end of the input or on error **/
+
+    UInt_t nevents = 0, nparticles = 0;
+    stream.read(reinterpret_cast<Char_t *>(&nevents), sizeof(nevents));
+    if (stream.gcount() == 0) return kFALSE;
+    stream.read(reinterpret_cast<Char_t *>(&nparticles), sizeof(nparticles));
+    if (stream.good() && (nevents > fgMaxEvents || nparticles > fgMaxParticles)) {
+      LOG(ERROR) << "Invalid block size in native event input: " << nevents << " events, " << nparticles << " particles" << std::endl;
+      return kFALSE;
+    }
+    Bool_t retval = stream.good() &&
+      ReadColumn(stream, number, nevents) &&
+      ReadColumn(stream, nParticles, nevents) &&
+      ReadColumn(stream, flags, nevents) &&
+      ReadColumn(stream, crossSection, nevents) &&
+      ReadColumn(stream, crossSectionError, nevents) &&
+      ReadColumn(stream, acceptedEvents, nevents) &&
+      ReadColumn(stream, attemptedEvents, nevents) &&
+      ReadColumn(stream, nCollHard, nevents) &&
+      ReadColumn(stream, nPartProj, nevents) &&
+      ReadColumn(stream, nPartTarg, nevents) &&
+      ReadColumn(stream, nColl, nevents) &&
+      ReadColumn(stream, nSpecNeut, nevents) &&
+      ReadColumn(stream, nSpecProt, nevents) &&
+      ReadColumn(stream, impactParameter, nevents) &&
+      ReadColumn(stream, eventPlaneAngle, nevents) &&
+      ReadColumn(stream, eccentricity, nevents) &&
+      ReadColumn(stream, sigmaNN, nevents) &&
+      ReadColumn(stream, centrality, nevents) &&
+      ReadColumn(stream, pdg, nparticles) &&
+      ReadColumn(stream, status, nparticles) &&
+      ReadColumn(stream, mother, nparticles) &&
+      ReadColumn(stream, px, nparticles) &&
+      ReadColumn(stream, py, nparticles) &&
+      ReadColumn(stream, pz, nparticles) &&
+      ReadColumn(stream, e, nparticles) &&
+      ReadColumn(stream, vx, nparticles) &&
+      ReadColumn(stream, vy, nparticles) &&
+      ReadColumn(stream, vz, nparticles) &&
+      ReadColumn(stream, vt, nparticles);
+    if (!retval) {
+      LOG(ERROR) << "Truncated block in native event input" << std::endl;
+      return kFALSE;
+    }
+
+    /** the particles of the events add up to those of the block **/
+    return CheckCounts(nparticles);
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  NativeBlock::CheckCounts(UInt_t nparticles) const
+  {
+    /** check counts **/
+
+    Long64_t sum = 0;
+    for (auto n : nParticles) {
+      if (n < 0) {
+	LOG(ERROR) << "Negative number of particles in native event input: " << n << std::endl;
+	return kFALSE;
+      }
+      sum += n;
+    }
+    if (sum != nparticles) {
+      LOG(ERROR) << "Inconsistent block in native event input: " << sum << " particles in the events, " << nparticles << " in the block" << std::endl;
+      return kFALSE;
+    }
+
+    /** success **/
+    return kTRUE;
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  NativeBlock::Write(std::ostream &stream) const
+  {
+    /** write **/
+
+    UInt_t nevents = GetNumberOfEvents(), nparticles = GetNumberOfParticles();
+    stream.write(reinterpret_cast<const Char_t *>(&nevents), sizeof(nevents));
+    stream.write(reinterpret_cast<const Char_t *>(&nparticles), sizeof(nparticles));
+    return stream.good() &&
+      WriteColumn(stream, number) &&
+      WriteColumn(stream, nParticles) &&
+      WriteColumn(stream, flags) &&
+      WriteColumn(stream, crossSection) &&
+      WriteColumn(stream, crossSectionError) &&
+      WriteColumn(stream, acceptedEvents) &&
+      WriteColumn(stream, attemptedEvents) &&
+      WriteColumn(stream, nCollHard) &&
+      WriteColumn(stream, nPartProj) &&
+      WriteColumn(stream, nPartTarg) &&
+      WriteColumn(stream, nColl) &&
+      WriteColumn(stream, nSpecNeut) &&
+      WriteColumn(stream, nSpecProt) &&
+      WriteColumn(stream, impactParameter) &&
+      WriteColumn(stream, eventPlaneAngle) &&
+      WriteColumn(stream, eccentricity) &&
+      WriteColumn(stream, sigmaNN) &&
+      WriteColumn(stream, centrality) &&
+      WriteColumn(stream, pdg) &&
+      WriteColumn(stream, status) &&
+      WriteColumn(stream, mother) &&
+      WriteColumn(stream, px) &&
+      WriteColumn(stream, py) &&
+      WriteColumn(stream, pz) &&
+      WriteColumn(stream, e) &&
+      WriteColumn(stream, vx) &&
+      WriteColumn(stream, vy) &&
+      WriteColumn(stream, vz) &&
+      WriteColumn(stream, vt);
+  }
+
+  /*****************************************************************/
+  /*****************************************************************/
+
+} /* namespace eventgen */
+} /* namespace o2 */
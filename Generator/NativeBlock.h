@@ -0,0 +1,104 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See https://alice-o2.web.cern.ch/ for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \author R+Preghenella - September 2017
+
+#ifndef ALICEO2_EVENTGEN_NATIVEBLOCK_H_
+#define ALICEO2_EVENTGEN_NATIVEBLOCK_H_
+
+#include "Rtypes.h"
+#include <istream>
+#include <ostream>
+#include <vector>
+
+namespace o2
+{
+namespace eventgen
+{
+
+  /*****************************************************************/
+  /*****************************************************************/
+
+  /** block of events of the native columnar format. a file is the
+      "o2ev" magic and the format version followed by blocks, each
+      with the number of events and particles and then one column
+      per event and per particle quantity, in the order below.
+      units are GeV, mm and the mother is the index in the event **/
+
+  class NativeBlock
+  {
+
+  public:
+
+    enum EEventFlags_t {
+      kCrossSection = 0x1,
+      kHeavyIon     = 0x2
+    };
+
+    /** default constructor **/
+    NativeBlock();
+    /** destructor **/
+    virtual ~NativeBlock();
+
+    /** methods **/
+    void Clear();
+    Bool_t Read(std::istream &stream);
+    Bool_t Write(std::ostream &stream) const;
+    UInt_t GetNumberOfEvents() const {return number.size();};
+    UInt_t GetNumberOfParticles() const {return pdg.size();};
+
+    /** event columns **/
+    std::vector<Long64_t> number;
+    std::vector<Int_t>    nParticles;
+    std::vector<Int_t>    flags;
+    std::vector<Double_t> crossSection;       // [pb]
+    std::vector<Double_t> crossSectionError;  // [pb]
+    std::vector<Long64_t> acceptedEvents;
+    std::vector<Long64_t> attemptedEvents;
+    std::vector<Int_t>    nCollHard;
+    std::vector<Int_t>    nPartProj;
+    std::vector<Int_t>    nPartTarg;
+    std::vector<Int_t>    nColl;
+    std::vector<Int_t>    nSpecNeut;
+    std::vector<Int_t>    nSpecProt;
+    std::vector<Double_t> impactParameter;    // [fm]
+    std::vector<Double_t> eventPlaneAngle;
+    std::vector<Double_t> eccentricity;
+    std::vector<Double_t> sigmaNN;            // [mb]
+    std::vector<Double_t> centrality;
+
+    /** particle columns **/
+    std::vector<Int_t>    pdg;
+    std::vector<Int_t>    status;
+    std::vector<Int_t>    mother;
+    std::vector<Double_t> px, py, pz, e;      // [GeV]
+    std::vector<Double_t> vx, vy, vz, vt;     // [mm], [mm/c]
+
+  protected:
+
+    /** methods **/
+    template <typename T> static Bool_t ReadColumn(std::istream &stream, std::vector<T> &column, UInt_t n);
+    template <typename T> static Bool_t WriteColumn(std::ostream &stream, const std::vector<T> &column);
+    Bool_t CheckCounts(UInt_t nparticles) const;
+
+    /** limits of a block, columns are read in chunks **/
+    static const UInt_t fgMaxEvents = 1 << 24;
+    static const UInt_t fgMaxParticles = 1 << 30;
+    static const UInt_t fgChunkSize = 1 << 16;
+
+  }; /** class NativeBlock **/
+
+  /*****************************************************************/
+  /*****************************************************************/
+
+} /** namespace eventgen **/
+} /** namespace o2 **/
+
+#endif /* ALICEO2_EVENTGEN_NATIVEBLOCK_H_ */
@@ -17,8 +17,22 @@
 #include "MCEventHeader.h"
 #include "FairLogger.h"
 #include "GeneratorHeader.h"
+#include "Core/CheckpointHook.h"
 #include "TFile.h"
 #include "TTree.h"
+#include "TRandom.h"
+#include "TParameter.h"
+#include "TArrayI.h"
+#include "TVirtualMC.h"
+#include <fstream>
+#include <algorithm>
+#include <cctype>
+#include <wordexp.h>
+#include <cstdio>
+#include <climits>
+#include <string>
+#include <unistd.h>
+#include <sys/stat.h>
 
 namespace o2
 {
@@ -50,35 +64,184 @@ namespace eventgen
   {
     /** generate event **/
 
+    /** checkpoint between transport events, a failure stops the run after this event **/
+    if (!o2sim::CheckpointHook::Instance().BeginEvent() && TVirtualMC::GetMC())
+      TVirtualMC::GetMC()->StopRun();
+    
+    /** without profiling **/
+    if (!mProfilePrimaries) return GeneratePrimaries(pStack);
+
+    /** there is transport only with a VMC engine, none in generator-only mode **/
+    if (!mProfileTransport && TVirtualMC::GetMC())
+      mProfileTransport = o2sim::Profiler::Instance().GetEntry("simulation.transport");
+    
+    /** close transport of the previous event and time the generation **/
+    auto start = o2sim::Profiler::Now();
+    if (mProfileTransport && mProfileLast > 0) mProfileTransport->Add(1, start - mProfileLast);
+    auto retval = GeneratePrimaries(pStack);
+    mProfileLast = o2sim::Profiler::Now();
+    mProfilePrimaries->Add(1, mProfileLast - start);
+    return retval;
+  }
+    
+  /*****************************************************************/
+
+  Bool_t
+  PrimaryGenerator::GeneratePrimaries(FairGenericStack *pStack)
+  {
+    /** generate primaries **/
+
+    /** pileup of the collisions in a timeframe **/
+    if (IsPileup()) return GeneratePileup(pStack);
+
+    /** batch of generator events **/
+    if (mBatchSize > 1) return GenerateBatch(pStack);
+    
     /** normal generation if no embedding **/
-    if (!mEmbedTree) return FairPrimaryGenerator::GenerateEvent(pStack);
+    if (mEmbedFileNames.empty()) {
+      if (!FairPrimaryGenerator::GenerateEvent(pStack)) return kFALSE;
+      AddSubEvent(0);
+      return kTRUE;
+    }
 
     /** this is for embedding **/
     
-    /** setup interaction diamond **/
-    mEmbedTree->GetEntry(mEmbedCounter);
-    SetInteractionDiamond(mEmbedEvent);
+    /** setup interaction diamond from the vertex cache **/
+    if (!NextEmbedEvent()) return kFALSE;
+    Double_t sigmaxyz[3] = {0., 0., 0.};
+    SetInteractionDiamond(&mEmbedCache.vertex[3 * mEmbedEvent], sigmaxyz, kFALSE);
 
     /** generate event **/
     if (!FairPrimaryGenerator::GenerateEvent(pStack)) return kFALSE;
+    AddSubEvent(0);
 
     /** add embedding info to event header **/
     auto o2event = dynamic_cast<MCEventHeader *>(fEvent);
     if (o2event) {
-      o2event->SetEmbeddingFileName(mEmbedFile->GetName());
-      o2event->SetEmbeddingEventCounter(mEmbedCounter);
+      o2event->SetEmbeddingFileName(mEmbedCache.fileName);
+      o2event->SetEmbeddingEventCounter(mEmbedEvent);
     }
     
-    /** increment embedding counter **/
-    mEmbedCounter++;
-    mEmbedCounter %= mEmbedEntries;
-
     /** success **/
     return kTRUE;
   }
     
   /*****************************************************************/
 
+  Bool_t
+  PrimaryGenerator::GeneratePileup(FairGenericStack *pStack)
+  {
+    /** generate pileup **/
+
+    /** number of collisions, redrawn for an empty timeframe
+	only if they are skipped **/
+    Int_t ncollisions = gRandom->Poisson(GetPileupMean());
+    while (ncollisions == 0 && mPileupSkipEmpty) ncollisions = gRandom->Poisson(GetPileupMean());
+
+    /** an empty timeframe is an event without primaries **/
+    if (ncollisions == 0) {
+      fNTracks = 0;
+      fEvent->Reset();
+      fEvent->SetEventID(++fEventNr);
+      fEvent->SetNPrim(0);
+      return kTRUE;
+    }
+    
+    /** collision times **/
+    mPileupTimes.resize(ncollisions);
+    for (auto &time : mPileupTimes)
+      time = mPileupBunches[gRandom->Integer(mPileupBunches.size())] * mPileupSpacing;
+    std::sort(mPileupTimes.begin(), mPileupTimes.end());
+
+    /** the first collision sets up the event **/
+    mPileupTime = mPileupTimes[0];
+    mSubEvent = 0;
+    Bool_t retval = FairPrimaryGenerator::GenerateEvent(pStack);
+    if (retval) AddSubEvent(0);
+
+    /** the others are added as sub-events **/
+    for (mSubEvent = 1; mSubEvent < ncollisions && retval; mSubEvent++) {
+      mPileupTime = mPileupTimes[mSubEvent];
+      retval = GenerateSubEvent();
+    }
+    fEvent->SetNPrim(fNTracks);
+    mPileupTime = 0.;
+    mSubEvent = 0;
+    return retval;
+  }
+  
+  /*****************************************************************/
+
+  Bool_t
+  PrimaryGenerator::GenerateBatch(FairGenericStack *pStack)
+  {
+    /** generate batch, independent generator events are stacked
+	into one transport event and tagged by their sub-event **/
+
+    mSubEvent = 0;
+    Bool_t retval = FairPrimaryGenerator::GenerateEvent(pStack);
+    if (retval) AddSubEvent(0);
+    for (mSubEvent = 1; mSubEvent < mBatchSize && retval; mSubEvent++)
+      retval = GenerateSubEvent();
+    fEvent->SetNPrim(fNTracks);
+    mSubEvent = 0;
+    return retval;
+  }
+  
+  /*****************************************************************/
+
+  Bool_t
+  PrimaryGenerator::GenerateSubEvent()
+  {
+    /** generate sub-event, added to the current event with its own vertex **/
+
+    Int_t trackOffset = fNTracks;
+    MakeVertex();
+    for (auto const &x : *GetListOfGenerators()) {
+      auto generator = dynamic_cast<FairGenerator *>(x);
+      if (!generator) continue;
+      fMCIndexOffset = fNTracks;
+      if (!generator->ReadEvent(this)) {
+	LOG(ERROR) << "Failed generating sub-event " << mSubEvent << " with \"" << generator->GetName() << "\" generator" << std::endl;
+	return kFALSE;
+      }
+    }
+    AddSubEvent(trackOffset);
+
+    /** success **/
+    return kTRUE;
+  }
+  
+  /*****************************************************************/
+
+  void
+  PrimaryGenerator::AddSubEvent(Int_t trackOffset)
+  {
+    /** add sub-event, the tracks from the offset on, whatever
+	generators added them and whether they add a header **/
+
+    auto o2event = dynamic_cast<MCEventHeader *>(fEvent);
+    if (!o2event) return;
+    o2event->AddSubEvent(trackOffset, fNTracks - trackOffset, mPileupTime);
+  }
+  
+  /*****************************************************************/
+
+  void
+  PrimaryGenerator::AddTrack(Int_t pdgid, Double_t px, Double_t py, Double_t pz,
+			     Double_t vx, Double_t vy, Double_t vz,
+			     Int_t parent, Bool_t wanttracking,
+			     Double_t e, Double_t tof,
+			     Double_t weight, TMCProcess proc)
+  {
+    /** add track, shifted to the collision time **/
+
+    FairPrimaryGenerator::AddTrack(pdgid, px, py, pz, vx, vy, vz, parent, wanttracking,
+				   e, tof + mPileupTime, weight, proc);
+  }
+  
+  /*****************************************************************/
+
   void
   PrimaryGenerator::AddHeader(GeneratorHeader *header)
   {
@@ -87,6 +250,8 @@ namespace eventgen
     /** setup header **/
     header->SetTrackOffset(fMCIndexOffset);
     header->SetNumberOfTracks(fNTracks - fMCIndexOffset);
+    header->SetTimeOffset(mPileupTime);
+    header->SetSubEvent(mSubEvent);
 
     /** check o2 event header **/
     auto o2event = dynamic_cast<MCEventHeader *>(fEvent);
@@ -97,6 +262,30 @@ namespace eventgen
   
   /*****************************************************************/
 
+  void
+  PrimaryGenerator::InitProfiling()
+  {
+    /** init profiling, the transport entry is taken at
+	the first event once the VMC engine exists **/
+
+    auto &profiler = o2sim::Profiler::Instance();
+    mProfilePrimaries = profiler.GetEntry("simulation.primaries");
+  }
+  
+  /*****************************************************************/
+
+  void
+  PrimaryGenerator::FinishProfiling()
+  {
+    /** finish profiling **/
+
+    if (!mProfileTransport || mProfileLast == 0) return;
+    mProfileTransport->Add(1, o2sim::Profiler::Now() - mProfileLast);
+    mProfileLast = 0;
+  }
+  
+  /*****************************************************************/
+
   void
   PrimaryGenerator::SetInteractionDiamond(const Double_t *xyz, const Double_t *sigmaxyz, Bool_t smear)
   {
@@ -126,44 +315,522 @@ namespace eventgen
   /*****************************************************************/
 
   Bool_t
-  PrimaryGenerator::EmbedInto(TString fname)
+  PrimaryGenerator::SaveState(TDirectory *dir) const
+  {
+    /** save state **/
+
+    TParameter<Int_t> eventNumber("event_number", fEventNr);
+    if (dir->WriteTObject(&eventNumber) <= 0) return kFALSE;
+    if (mEmbedFileNames.empty()) return kTRUE;
+
+    /** embedding position, the orders are random unless sequential **/
+    TArrayI fileOrder(mEmbedFileOrder.size(), mEmbedFileOrder.data());
+    TArrayI eventOrder(mEmbedEventOrder.size(), mEmbedEventOrder.data());
+    TParameter<Int_t> fileCounter("embed_file_counter", mEmbedFileCounter);
+    TParameter<Int_t> eventCounter("embed_counter", mEmbedCounter);
+    if (dir->WriteObject(&fileOrder, "embed_file_order") <= 0) return kFALSE;
+    if (dir->WriteObject(&eventOrder, "embed_event_order") <= 0) return kFALSE;
+    if (dir->WriteTObject(&fileCounter) <= 0) return kFALSE;
+    if (dir->WriteTObject(&eventCounter) <= 0) return kFALSE;
+
+    /** success **/
+    return kTRUE;
+  }
+  
+  /*****************************************************************/
+
+  Bool_t
+  PrimaryGenerator::LoadState(TDirectory *dir)
+  {
+    /** load state **/
+
+    auto eventNumber = dynamic_cast<TParameter<Int_t> *>(dir->Get("event_number"));
+    if (!eventNumber) {
+      LOG(ERROR) << "Cannot find state of primary generator" << std::endl;
+      return kFALSE;
+    }
+    fEventNr = eventNumber->GetVal();
+    delete eventNumber;
+    if (mEmbedFileNames.empty()) return kTRUE;
+
+    /** embedding position **/
+    TArrayI *fileOrder = nullptr, *eventOrder = nullptr;
+    dir->GetObject("embed_file_order", fileOrder);
+    dir->GetObject("embed_event_order", eventOrder);
+    auto fileCounter = dynamic_cast<TParameter<Int_t> *>(dir->Get("embed_file_counter"));
+    auto eventCounter = dynamic_cast<TParameter<Int_t> *>(dir->Get("embed_counter"));
+    Int_t nvisits = mEmbedPolicy == kEmbedRandom ? mEmbedReuse : 1;
+    if (!fileOrder || !eventOrder || !fileCounter || !eventCounter ||
+	fileOrder->GetSize() != (Int_t)mEmbedFileNames.size() * nvisits ||
+	fileCounter->GetVal() < 0 || fileCounter->GetVal() >= fileOrder->GetSize()) {
+      LOG(ERROR) << "Cannot find embedding state matching the background files" << std::endl;
+      return kFALSE;
+    }
+    mEmbedFileOrder.assign(fileOrder->GetArray(), fileOrder->GetArray() + fileOrder->GetSize());
+    mEmbedEventOrder.assign(eventOrder->GetArray(), eventOrder->GetArray() + eventOrder->GetSize());
+    mEmbedFileCounter = fileCounter->GetVal();
+    mEmbedCounter = eventCounter->GetVal();
+    delete fileOrder;
+    delete eventOrder;
+    delete fileCounter;
+    delete eventCounter;
+    
+    /** reload the current file, dropping the prefetch of the first one **/
+    auto fname = mEmbedFileNames[mEmbedFileOrder[mEmbedFileCounter]];
+    if (mEmbedNext.valid()) mEmbedNext.get();
+    if (mEmbedCache.fileName != fname || mEmbedCache.entries <= 0)
+      LoadEmbedCache(fname, mEmbedUseIndex, mEmbedCache);
+    LogEmbedCache(mEmbedCache);
+    if (mEmbedCache.entries <= 0) {
+      LOG(ERROR) << "Cannot load background file for embedding: " << fname << std::endl;
+      return kFALSE;
+    }
+    PrefetchEmbedFile();
+    
+    /** success **/
+    return kTRUE;
+  }
+  
+  /*****************************************************************/
+
+  Bool_t
+  PrimaryGenerator::SetPileup(Double_t mu, Int_t nbunches, Double_t spacing, TString filling)
+  {
+    /** set pileup, the filling scheme is a sequence of filled (b)
+	and empty (e) bunch counts, e.g. "72b8e72b30e", repeated over
+	the timeframe. all bunches are filled if there is none,
+	a scheme without filled bunches is an error **/
+
+    if (mu <= 0. || nbunches < 1 || spacing <= 0.) {
+      LOG(ERROR) << "Invalid pileup: mu = " << mu << " | bunches = " << nbunches << " | spacing = " << spacing << std::endl;
+      return kFALSE;
+    }
+
+    /** parse filling scheme **/
+    std::vector<Bool_t> pattern;
+    TString count;
+    Bool_t scheme = kFALSE;
+    for (Int_t i = 0; i < filling.Length(); i++) {
+      auto c = filling[i];
+      if (std::isspace(c)) continue;
+      scheme = kTRUE;
+      if (std::isdigit(c)) {
+	count += c;
+	continue;
+      }
+      if ((c != 'b' && c != 'e') || count.IsNull()) {
+	LOG(ERROR) << "Invalid bunch filling scheme: " << filling << std::endl;
+	return kFALSE;
+      }
+      pattern.insert(pattern.end(), count.Atoi(), c == 'b');
+      count = "";
+    }
+    if (!count.IsNull()) {
+      LOG(ERROR) << "Invalid bunch filling scheme: " << filling << std::endl;
+      return kFALSE;
+    }
+    if (!scheme) pattern.push_back(kTRUE);
+    if (std::find(pattern.begin(), pattern.end(), kTRUE) == pattern.end()) {
+      LOG(ERROR) << "No filled bunches in filling scheme: " << filling << std::endl;
+      return kFALSE;
+    }
+
+    /** filled bunch crossings in the timeframe **/
+    mPileupBunches.clear();
+    for (Int_t ibunch = 0; ibunch < nbunches; ibunch++)
+      if (pattern[ibunch % pattern.size()]) mPileupBunches.push_back(ibunch);
+    if (mPileupBunches.empty()) {
+      LOG(ERROR) << "No filled bunches in filling scheme: " << filling << std::endl;
+      return kFALSE;
+    }
+    mPileupMu = mu;
+    mPileupSpacing = spacing;
+    LOG(INFO) << "Pileup: mu = " << mu << " | filled bunches: " << mPileupBunches.size() << "/" << nbunches
+	      << " | collisions per timeframe: " << GetPileupMean() << std::endl;
+    
+    /** success **/
+    return kTRUE;
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  PrimaryGenerator::EmbedInto(TString fnames, Bool_t useIndex)
   {
     /** embed into **/
 
-    /** check if a file is already open **/
-    if (mEmbedFile && mEmbedFile->IsOpen()) {
-      LOG(ERROR) << "Another embedding file is currently open" << std::endl;
+    /** check if a background is already in use **/
+    if (!mEmbedFileNames.empty()) {
+      LOG(ERROR) << "Another embedding background is currently open" << std::endl;
+      return kFALSE;
+    }
+
+    /** expand the list of background files **/
+    if (!ExpandEmbedFiles(fnames)) return kFALSE;
+    if (mEmbedFileNames.empty()) {
+      LOG(ERROR) << "No background files found for embedding: " << fnames << std::endl;
+      return kFALSE;
+    }
+    if (mEmbedPolicy == kEmbedRandom && mEmbedReuse < 1) {
+      LOG(ERROR) << "Invalid embedding reuse budget: " << mEmbedReuse << std::endl;
+      return kFALSE;
+    }
+    mEmbedUseIndex = useIndex;
+    LOG(INFO) << "Embedding into " << mEmbedFileNames.size() << " background files" << std::endl;
+    
+    /** the file order of the first pass **/
+    BuildEmbedFileOrder();
+
+    /** load the first file **/
+    mEmbedFileCounter = -1;
+    if (!NextEmbedFile()) {
+      mEmbedFileNames.clear();
       return kFALSE;
     }
     
+    /** success **/
+    return kTRUE;
+  }
+  
+  /*****************************************************************/
+
+  Bool_t
+  PrimaryGenerator::ExpandEmbedFiles(TString fnames)
+  {
+    /** expand embedding files, shell-like expansion of
+	variables and globs without command substitution **/
+
+    wordexp_t words;
+    if (wordexp(fnames.Data(), &words, WRDE_NOCMD) != 0) {
+      LOG(ERROR) << "Cannot expand embedding files: " << fnames << std::endl;
+      return kFALSE;
+    }
+    for (size_t iword = 0; iword < words.we_wordc; iword++) {
+      TString fname = words.we_wordv[iword];
+      /** manifest **/
+      if (fname.EndsWith(".txt") || fname.EndsWith(".list")) {
+	std::ifstream fin(fname.Data());
+	if (!fin.is_open()) {
+	  LOG(ERROR) << "Cannot open embedding manifest: " << fname << std::endl;
+	  wordfree(&words);
+	  return kFALSE;
+	}
+	std::string line;
+	while (std::getline(fin, line)) {
+	  TString entry = line;
+	  entry = entry.Strip(TString::kBoth);
+	  if (entry.IsNull() || entry.BeginsWith("#")) continue;
+	  mEmbedFileNames.push_back(entry);
+	}
+	continue;
+      }
+      /** file **/
+      mEmbedFileNames.push_back(fname);
+    }
+    wordfree(&words);
+    
+    /** success **/
+    return kTRUE;
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  PrimaryGenerator::NextEmbedEvent()
+  {
+    /** next embedding event **/
+
+    if (mEmbedCounter >= (Int_t)mEmbedEventOrder.size() && !NextEmbedFile()) return kFALSE;
+    mEmbedEvent = mEmbedEventOrder[mEmbedCounter];
+    mEmbedCounter++;
+    return kTRUE;
+  }
+  
+  /*****************************************************************/
+
+  Bool_t
+  PrimaryGenerator::NextEmbedFile()
+  {
+    /** next embedding file **/
+
+    /** end of the pass over the files, the next one starts over **/
+    mEmbedFileCounter++;
+    if (mEmbedFileCounter >= (Int_t)mEmbedFileOrder.size()) {
+      if (mEmbedPolicy == kEmbedRandom)
+	LOG(INFO) << "Embedding background used " << mEmbedReuse << " times, starting over" << std::endl;
+      mEmbedFileCounter = 0;
+      if (mEmbedPolicy != kEmbedSequential) BuildEmbedFileOrder();
+    }
+    
+    /** take the prefetched file, or load it if there is none **/
+    auto fname = mEmbedFileNames[mEmbedFileOrder[mEmbedFileCounter]];
+    if (mEmbedNext.valid()) mEmbedCache = mEmbedNext.get();
+    if (mEmbedCache.fileName != fname || mEmbedCache.entries <= 0)
+      LoadEmbedCache(fname, mEmbedUseIndex, mEmbedCache);
+    LogEmbedCache(mEmbedCache);
+    if (mEmbedCache.entries <= 0) {
+      LOG(ERROR) << "Cannot load background file for embedding: " << fname << std::endl;
+      return kFALSE;
+    }
+    
+    /** event order, each event once per visit of the file **/
+    mEmbedEventOrder.resize(mEmbedCache.entries);
+    for (Int_t ievent = 0; ievent < (Int_t)mEmbedEventOrder.size(); ievent++)
+      mEmbedEventOrder[ievent] = ievent;
+    if (mEmbedPolicy != kEmbedSequential) ShuffleEmbed(mEmbedEventOrder);
+    mEmbedCounter = 0;
+
+    /** prefetch the following one **/
+    PrefetchEmbedFile();
+    
+    /** success **/
+    return kTRUE;
+  }
+
+  /*****************************************************************/
+
+  void
+  PrimaryGenerator::BuildEmbedFileOrder()
+  {
+    /** build embedding file order, each file is visited once per
+	round and the random policy makes reuse rounds. the rounds
+	are shuffled unless sequential, and a file never follows
+	itself across two rounds when there are others **/
+
+    Int_t nfiles = mEmbedFileNames.size();
+    Int_t nrounds = mEmbedPolicy == kEmbedRandom ? mEmbedReuse : 1;
+    std::vector<Int_t> round(nfiles);
+    mEmbedFileOrder.clear();
+    for (Int_t iround = 0; iround < nrounds; iround++) {
+      for (Int_t ifile = 0; ifile < nfiles; ifile++)
+	round[ifile] = ifile;
+      if (mEmbedPolicy != kEmbedSequential) ShuffleEmbed(round);
+      if (nfiles > 1 && !mEmbedFileOrder.empty() && round[0] == mEmbedFileOrder.back())
+	std::swap(round[0], round[1 + gRandom->Integer(nfiles - 1)]);
+      mEmbedFileOrder.insert(mEmbedFileOrder.end(), round.begin(), round.end());
+    }
+  }
+  
+  /*****************************************************************/
+
+  void
+  PrimaryGenerator::PrefetchEmbedFile()
+  {
+    /** prefetch embedding file in the background **/
+
+    if (mEmbedFileNames.size() <= 1) return;
+    auto ifile = mEmbedFileCounter + 1;
+    if (ifile >= (Int_t)mEmbedFileOrder.size()) {
+      /** the next pass is reshuffled, nothing to prefetch **/
+      if (mEmbedPolicy != kEmbedSequential) return;
+      ifile = 0;
+    }
+    auto fname = mEmbedFileNames[mEmbedFileOrder[ifile]];
+    /** the same file again is already in the cache **/
+    if (fname == mEmbedCache.fileName) return;
+    auto useIndex = mEmbedUseIndex;
+    mEmbedNext = std::async(std::launch::async, [fname, useIndex] {
+	EmbedCache_t cache;
+	LoadEmbedCache(fname, useIndex, cache);
+	return cache;
+      });
+  }
+  
+  /*****************************************************************/
+
+  void
+  PrimaryGenerator::LogEmbedCache(EmbedCache_t &cache) const
+  {
+    /** log embedding cache messages, collected while loading
+	so that loading in the background does not log **/
+
+    for (auto const &message : cache.messages) {
+      if (message.first == kEmbedError) LOG(ERROR) << message.second << std::endl;
+      else if (message.first == kEmbedWarning) LOG(WARNING) << message.second << std::endl;
+      else LOG(INFO) << message.second << std::endl;
+    }
+    cache.messages.clear();
+  }
+  
+  /*****************************************************************/
+
+  void
+  PrimaryGenerator::ShuffleEmbed(std::vector<Int_t> &order) const
+  {
+    /** shuffle embedding order, from the job random generator
+	so that jobs with different seeds spread over the sample **/
+
+    for (Int_t i = (Int_t)order.size() - 1; i > 0; i--)
+      std::swap(order[i], order[gRandom->Integer(i + 1)]);
+  }
+  
+  /*****************************************************************/
+
+  Bool_t
+  PrimaryGenerator::LoadEmbedCache(TString fname, Bool_t useIndex, EmbedCache_t &cache)
+  {
+    /** load embedding cache, from the index if up to date,
+	otherwise it is built from the file and the index updated **/
+
+    cache.fileName = fname;
+    cache.entries = 0;
+    if (useIndex && ReadEmbedIndex(fname, cache)) return kTRUE;
+    if (!BuildEmbedCache(fname, cache)) return kFALSE;
+    if (useIndex) WriteEmbedIndex(fname, cache);
+    return kTRUE;
+  }
+  
+  /*****************************************************************/
+
+  Bool_t
+  PrimaryGenerator::BuildEmbedCache(TString fname, EmbedCache_t &cache)
+  {
+    /** build embedding vertex cache **/
+
     /** open file **/
-    mEmbedFile = TFile::Open(fname);
-    if (!mEmbedFile || !mEmbedFile->IsOpen()) {
-      LOG(ERROR) << "Cannot open file for embedding: " << fname << std::endl;
+    auto file = TFile::Open(fname);
+    if (!file || !file->IsOpen()) {
+      cache.messages.emplace_back(kEmbedError, "Cannot open file for embedding: " + fname);
       return kFALSE;
     }
 
     /** get tree **/
-    mEmbedTree = (TTree *)mEmbedFile->Get("o2sim");
-    if (!mEmbedTree) { 
-      LOG(ERROR) << "Cannot find \"o2sim\" tree for embedding in " << fname << std::endl;
+    auto tree = (TTree *)file->Get("o2sim");
+    if (!tree) { 
+      cache.messages.emplace_back(kEmbedError, "Cannot find \"o2sim\" tree for embedding in " + fname);
+      delete file;
       return kFALSE;
-   }
+    }
 
     /** get entries **/
-    mEmbedEntries = mEmbedTree->GetEntries();
-    if (mEmbedEntries <= 0) {
-      LOG(ERROR) << "Invalid number of entries found in tree for embedding: " << mEmbedEntries << std::endl;
+    auto entries = tree->GetEntries();
+    if (entries <= 0 || entries > INT_MAX) {
+      cache.messages.emplace_back(kEmbedError, TString::Format("Invalid number of entries found in tree for embedding: %lld", entries));
+      delete file;
       return kFALSE;
     }
 
     /** connect MC event header **/
-    TBranch *theBranch = mEmbedTree->GetBranch("MCEventHeader.");
-    TClass *theClass = new TClass();
+    auto branch = tree->GetBranch("MCEventHeader.");
+    if (!branch) {
+      cache.messages.emplace_back(kEmbedError, "Cannot find \"MCEventHeader.\" branch for embedding in " + fname);
+      delete file;
+      return kFALSE;
+    }
+    TClass *theClass = nullptr;
     EDataType theType;
-    theBranch->GetExpectedType(theClass, theType);
-    mEmbedEvent = (FairMCEventHeader *)theClass->New();
-    mEmbedTree->SetBranchAddress("MCEventHeader.", &mEmbedEvent);
+    branch->GetExpectedType(theClass, theType);
+    if (!theClass) {
+      cache.messages.emplace_back(kEmbedError, "Cannot determine MC event header class for embedding in " + fname);
+      delete file;
+      return kFALSE;
+    }
+    auto event = (FairMCEventHeader *)theClass->New();
+    tree->SetBranchAddress("MCEventHeader.", &event);
+
+    /** read only the vertex when the header branch is split **/
+    if (tree->GetBranch("MCEventHeader.fX")) {
+      tree->SetBranchStatus("*", 0);
+      tree->SetBranchStatus("MCEventHeader.fX", 1);
+      tree->SetBranchStatus("MCEventHeader.fY", 1);
+      tree->SetBranchStatus("MCEventHeader.fZ", 1);
+    }
+
+    /** fill cache **/
+    cache.vertex.resize(3 * entries);
+    for (Long64_t ientry = 0; ientry < entries; ientry++) {
+      tree->GetEntry(ientry);
+      cache.vertex[3 * ientry] = event->GetX();
+      cache.vertex[3 * ientry + 1] = event->GetY();
+      cache.vertex[3 * ientry + 2] = event->GetZ();
+    }
+    cache.entries = entries;
+
+    /** close file **/
+    tree->ResetBranchAddresses();
+    theClass->Destructor(event);
+    file->Close();
+    delete file;
+    
+    cache.messages.emplace_back(kEmbedInfo, TString::Format("Cached %d background vertices from %s", cache.entries, fname.Data()));
+    
+    /** success **/
+    return kTRUE;
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  PrimaryGenerator::ReadEmbedIndex(TString fname, EmbedCache_t &cache)
+  {
+    /** read embedding index, valid only if the background
+	file did not change since the index was written **/
+
+    struct stat info, indexInfo;
+    if (fname.Contains("://") || ::stat(fname.Data(), &info) != 0) return kFALSE;
+    if (::stat(GetEmbedIndexFileName(fname).Data(), &indexInfo) != 0) return kFALSE;
+    std::ifstream fin(GetEmbedIndexFileName(fname).Data(), std::ios::binary);
+    if (!fin.is_open()) return kFALSE;
+    
+    EmbedIndexHeader_t header;
+    if (!fin.read((char *)&header, sizeof(header)) ||
+	header.magic != fgEmbedIndexMagic || header.version != fgEmbedIndexVersion ||
+	header.fileSize != info.st_size || header.fileTime != info.st_mtime) {
+      cache.messages.emplace_back(kEmbedWarning, "Ignoring outdated embedding index: " + GetEmbedIndexFileName(fname));
+      return kFALSE;
+    }
+
+    /** the entries must fill the rest of the index exactly,
+	checked before anything is allocated **/
+    Long64_t payload = (Long64_t)indexInfo.st_size - (Long64_t)sizeof(header);
+    if (header.entries <= 0 || header.entries > INT_MAX ||
+	payload != header.entries * 3 * (Long64_t)sizeof(Double_t)) {
+      cache.messages.emplace_back(kEmbedWarning, "Ignoring corrupt embedding index: " + GetEmbedIndexFileName(fname));
+      return kFALSE;
+    }
+    cache.vertex.resize(3 * header.entries);
+    if (!fin.read((char *)cache.vertex.data(), cache.vertex.size() * sizeof(Double_t))) {
+      cache.messages.emplace_back(kEmbedWarning, "Ignoring truncated embedding index: " + GetEmbedIndexFileName(fname));
+      cache.vertex.clear();
+      return kFALSE;
+    }
+    cache.entries = header.entries;
+    
+    cache.messages.emplace_back(kEmbedInfo, TString::Format("Read %d background vertices from %s", cache.entries, GetEmbedIndexFileName(fname).Data()));
+    
+    /** success **/
+    return kTRUE;
+  }
+  
+  /*****************************************************************/
+
+  Bool_t
+  PrimaryGenerator::WriteEmbedIndex(TString fname, EmbedCache_t &cache)
+  {
+    /** write embedding index, written to a temporary file and
+	renamed so that concurrent jobs never see a partial index **/
+
+    struct stat info;
+    if (fname.Contains("://") || ::stat(fname.Data(), &info) != 0) return kFALSE;
+    TString indexName = GetEmbedIndexFileName(fname);
+    TString tmpName = indexName + "." + std::to_string(getpid()).c_str();
+    std::ofstream fout(tmpName.Data(), std::ios::binary);
+    if (!fout.is_open()) {
+      cache.messages.emplace_back(kEmbedWarning, "Cannot write embedding index: " + indexName);
+      return kFALSE;
+    }
+    
+    EmbedIndexHeader_t header = {fgEmbedIndexMagic, fgEmbedIndexVersion, info.st_size, info.st_mtime, cache.entries};
+    fout.write((const char *)&header, sizeof(header));
+    fout.write((const char *)cache.vertex.data(), cache.vertex.size() * sizeof(Double_t));
+    fout.close();
+    if (!fout || std::rename(tmpName.Data(), indexName.Data()) != 0) {
+      cache.messages.emplace_back(kEmbedWarning, "Cannot write embedding index: " + indexName);
+      std::remove(tmpName.Data());
+      return kFALSE;
+    }
+
+    cache.messages.emplace_back(kEmbedInfo, "Written embedding index: " + indexName);
     
     /** success **/
     return kTRUE;
@@ -14,11 +14,15 @@
 #define ALICEO2_EVENTGEN_PRIMARYGENERATOR_H_
 
 #include "FairPrimaryGenerator.h"
+#include "Core/Profiler.h"
+#include "TString.h"
+#include "TMCProcess.h"
+#include <vector>
+#include <future>
+#include <utility>
 
-class TFile;
-class TTree;
-class TString;
 class FairMCEventHeader;
+class TDirectory;
 
 namespace o2
 {
@@ -34,6 +38,13 @@ namespace eventgen
   {
     
   public:
+
+    /** access policies to the background events **/
+    enum EEmbedPolicy_t {
+      kEmbedSequential,  // files and events in order, wrapping around
+      kEmbedShuffled,    // files and events in random order, wrapping around
+      kEmbedRandom       // as shuffled, each file visited reuse times per pass, interleaved
+    };
     
     /** default constructor **/
     PrimaryGenerator();
@@ -48,6 +59,16 @@ namespace eventgen
 	*@return kTRUE if successful, kFALSE if not
 	**/
     Bool_t GenerateEvent(FairGenericStack *pStack) override;
+
+    /** Public method AddTrack
+	Adding a track to the stack, the time is shifted by the
+	time of the current collision in the pileup mode.
+    **/
+    void AddTrack(Int_t pdgid, Double_t px, Double_t py, Double_t pz,
+		  Double_t vx, Double_t vy, Double_t vz,
+		  Int_t parent = -1, Bool_t wanttracking = true,
+		  Double_t e = -9e9, Double_t tof = 0.,
+		  Double_t weight = 0., TMCProcess proc = kPPrimary) override;
     
     /** Public method AddHeader
 	Adding a generator header to the MC event header.
@@ -59,8 +80,41 @@ namespace eventgen
     void SetInteractionDiamond(const Double_t *xyz, const Double_t *sigmaxyz, Bool_t smear = kTRUE);
     void SetInteractionDiamond(const FairMCEventHeader *event);
 
-    /** Public embedding methods **/
-    Bool_t EmbedInto(TString fname);
+    /** Public embedding methods, the background is a list of files,
+	globs or manifests (.txt, .list) with one file per line. the
+	vertices are cached one file at a time, the next file being
+	prefetched, and optionally kept in a sidecar index **/
+    Bool_t EmbedInto(TString fnames, Bool_t useIndex = kTRUE);
+    void SetEmbedPolicy(EEmbedPolicy_t val) {mEmbedPolicy = val;};
+    void SetEmbedReuse(Int_t val) {mEmbedReuse = val;};
+
+    /** Public pileup methods, the collisions of a timeframe of
+	bunch crossings are stacked into one event with their own
+	vertex and time. the number of collisions in each filled
+	bunch crossing is Poisson with mean mu, a timeframe without
+	collisions is an event without primaries. skipping the empty
+	timeframes draws the number of collisions again, which biases
+	it towards larger values when the mean is small **/
+    Bool_t SetPileup(Double_t mu, Int_t nbunches, Double_t spacing, TString filling = "");
+    void SetPileupSkipEmpty(Bool_t val) {mPileupSkipEmpty = val;};
+    Bool_t IsPileup() const {return !mPileupBunches.empty();};
+    Double_t GetPileupMean() const {return mPileupMu * mPileupBunches.size();};
+
+    /** Public batching methods, a number of generator events are
+	stacked into one transport event, each with its own vertex **/
+    void SetBatchSize(Int_t val) {mBatchSize = val;};
+    Int_t GetBatchSize() const {return mBatchSize;};
+
+    /** Public profiling methods, the transport time of an event
+	is measured from the end of its generation to the start
+	of the next one, or to the finish for the last event **/
+    void InitProfiling();
+    void FinishProfiling();
+
+    /** Public checkpoint methods, the event number and the
+	position in the embedding background **/
+    Bool_t SaveState(TDirectory *dir) const;
+    Bool_t LoadState(TDirectory *dir);
     
   protected:
     
@@ -69,14 +123,79 @@ namespace eventgen
     /** operator= **/
     PrimaryGenerator &operator=(const PrimaryGenerator &);
 
+    /** methods **/
+    Bool_t GeneratePrimaries(FairGenericStack *pStack);
+    Bool_t GeneratePileup(FairGenericStack *pStack);
+    Bool_t GenerateBatch(FairGenericStack *pStack);
+    Bool_t GenerateSubEvent();
+    void AddSubEvent(Int_t trackOffset);
+
+    /** vertex cache of a background file, the messages of
+	the loading are logged later from the main thread **/
+    enum EEmbedMessage_t {kEmbedInfo, kEmbedWarning, kEmbedError};
+    struct EmbedCache_t {
+      TString fileName;
+      std::vector<Double_t> vertex;  // x, y, z of the background events
+      Int_t entries = 0;
+      std::vector<std::pair<Int_t, TString>> messages;
+    };
+    
+    /** embedding methods **/
+    Bool_t ExpandEmbedFiles(TString fnames);
+    Bool_t NextEmbedEvent();
+    Bool_t NextEmbedFile();
+    void BuildEmbedFileOrder();
+    void PrefetchEmbedFile();
+    void LogEmbedCache(EmbedCache_t &cache) const;
+    void ShuffleEmbed(std::vector<Int_t> &order) const;
+    static Bool_t LoadEmbedCache(TString fname, Bool_t useIndex, EmbedCache_t &cache);
+    static Bool_t BuildEmbedCache(TString fname, EmbedCache_t &cache);
+    static Bool_t ReadEmbedIndex(TString fname, EmbedCache_t &cache);
+    static Bool_t WriteEmbedIndex(TString fname, EmbedCache_t &cache);
+    static TString GetEmbedIndexFileName(TString fname) {return fname + ".vtx.idx";};
+
     /** embedding members **/
-    TFile *mEmbedFile = nullptr;
-    TTree *mEmbedTree = nullptr;
-    Int_t mEmbedEntries = 0;
-    Int_t mEmbedCounter = 0;
-    FairMCEventHeader *mEmbedEvent = nullptr;
+    std::vector<TString> mEmbedFileNames;
+    EEmbedPolicy_t mEmbedPolicy = kEmbedSequential;
+    Int_t mEmbedReuse = 1;
+    Bool_t mEmbedUseIndex = kTRUE;
+    std::vector<Int_t> mEmbedFileOrder;     //! order of the file visits in the pass
+    Int_t mEmbedFileCounter = 0;            //! position in the file order
+    EmbedCache_t mEmbedCache;               //! current background file
+    std::vector<Int_t> mEmbedEventOrder;    //! order of the events in the current file
+    Int_t mEmbedCounter = 0;                //! position in the event order
+    Int_t mEmbedEvent = 0;                  //! current background event
+    std::future<EmbedCache_t> mEmbedNext;   //! prefetched next file
+
+    /** sidecar index header **/
+    struct EmbedIndexHeader_t {
+      UInt_t magic;
+      UInt_t version;
+      Long64_t fileSize;  // of the background file
+      Long64_t fileTime;  // modification time of the background file
+      Long64_t entries;
+    };
+    static const UInt_t fgEmbedIndexMagic = 0x6f327678; // "o2vx"
+    static const UInt_t fgEmbedIndexVersion = 1;
+
+    /** pileup members **/
+    Double_t mPileupMu = 0.;
+    Double_t mPileupSpacing = 25.e-9;      // [s]
+    std::vector<Int_t> mPileupBunches;     // filled bunch crossings in the timeframe
+    Bool_t mPileupSkipEmpty = kFALSE;      // timeframes without collisions are skipped
+    std::vector<Double_t> mPileupTimes;    //! collision times in the current timeframe [s]
+    Double_t mPileupTime = 0.;             //! time of the current collision [s]
+
+    /** batching members **/
+    Int_t mBatchSize = 1;
+    Int_t mSubEvent = 0;                   //! current sub-event in the transport event
+
+    /** profiling members **/
+    o2sim::Profiler::Entry *mProfilePrimaries = nullptr;  //!
+    o2sim::Profiler::Entry *mProfileTransport = nullptr;  //!
+    Long64_t mProfileLast = 0;                            //! end of the last generation [ns]
     
-    ClassDefOverride(PrimaryGenerator, 1);
+    ClassDefOverride(PrimaryGenerator, 2);
 
   }; /** class PrimaryGenerator **/
 
@@ -0,0 +1,152 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See https://alice-o2.web.cern.ch/ for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \author R+Preghenella - September 2017
+
+#include "ReaderNative.h"
+#include "ReaderSharedMemory.h"
+#include "FairLogger.h"
+#include "HepMC/GenEvent.h"
+#include "HepMC/GenCrossSection.h"
+#include "HepMC/GenHeavyIon.h"
+#include <cstring>
+
+namespace o2
+{
+namespace eventgen
+{
+
+  /*****************************************************************/
+  /*****************************************************************/
+
+  ReaderNative::ReaderNative(std::istream &stream) :
+    HepMC::Reader(),
+    fStream(stream),
+    fFailed(kFALSE),
+    fBlock(),
+    fEvent(0),
+    fParticle(0),
+    fRecords(),
+    fParticles()
+  {
+    /** constructor **/
+
+    /** check magic and version **/
+    Char_t magic[4];
+    UInt_t version = 0;
+    fStream.read(magic, sizeof(magic));
+    fStream.read(reinterpret_cast<Char_t *>(&version), sizeof(version));
+    if (!fStream.good() || std::strncmp(magic, GetMagic(), sizeof(magic)) != 0) {
+      LOG(ERROR) << "Not a native event input" << std::endl;
+      fFailed = kTRUE;
+    }
+    else if (version != GetVersion()) {
+      LOG(ERROR) << "Unsupported native event format version: " << version << std::endl;
+      fFailed = kTRUE;
+    }
+  }
+
+  /*****************************************************************/
+
+  ReaderNative::~ReaderNative()
+  {
+    /** default destructor **/
+
+  }
+
+  /*****************************************************************/
+
+  bool
+  ReaderNative::read_event(HepMC::GenEvent &evt)
+  {
+    /** read event **/
+
+    if (fFailed) return false;
+
+    /** next block **/
+    if (fEvent == fBlock.GetNumberOfEvents()) {
+      if (!fBlock.Read(fStream) || fBlock.GetNumberOfEvents() == 0) {
+	fFailed = kTRUE;
+	return false;
+      }
+      fEvent = fParticle = 0;
+    }
+
+    /** pack particle records from the columns, the counts
+	are checked against the block when it is read **/
+    auto nparticles = fBlock.nParticles[fEvent];
+    if (nparticles < 0 || fParticle + nparticles > fBlock.GetNumberOfParticles()) {
+      LOG(ERROR) << "Invalid number of particles in native event input: " << nparticles << std::endl;
+      fFailed = kTRUE;
+      return false;
+    }
+    fRecords.resize(nparticles);
+    for (Int_t ipart = 0; ipart < nparticles; ipart++) {
+      auto &record = fRecords[ipart];
+      auto icol = fParticle + ipart;
+      record.pdg = fBlock.pdg[icol];
+      record.status = fBlock.status[icol];
+      record.mother = fBlock.mother[icol];
+      record.reserved = 0;
+      record.px = fBlock.px[icol];
+      record.py = fBlock.py[icol];
+      record.pz = fBlock.pz[icol];
+      record.e = fBlock.e[icol];
+      record.vx = fBlock.vx[icol];
+      record.vy = fBlock.vy[icol];
+      record.vz = fBlock.vz[icol];
+      record.vt = fBlock.vt[icol];
+    }
+
+    /** setup event **/
+    evt.clear();
+    evt.set_units(HepMC::Units::GEV, HepMC::Units::MM);
+    evt.set_event_number(fBlock.number[fEvent]);
+    ReaderSharedMemory::FillParticles(evt, fRecords, fParticles);
+
+    /** cross-section **/
+    auto flags = fBlock.flags[fEvent];
+    if (flags & NativeBlock::kCrossSection) {
+      auto cs = std::make_shared<HepMC::GenCrossSection>();
+      cs->set_cross_section(fBlock.crossSection[fEvent], fBlock.crossSectionError[fEvent]);
+      cs->accepted_events = fBlock.acceptedEvents[fEvent];
+      cs->attempted_events = fBlock.attemptedEvents[fEvent];
+      evt.set_cross_section(cs);
+    }
+
+    /** heavy-ion **/
+    if (flags & NativeBlock::kHeavyIon) {
+      auto hi = std::make_shared<HepMC::GenHeavyIon>();
+      hi->Ncoll_hard = fBlock.nCollHard[fEvent];
+      hi->Npart_proj = fBlock.nPartProj[fEvent];
+      hi->Npart_targ = fBlock.nPartTarg[fEvent];
+      hi->Ncoll = fBlock.nColl[fEvent];
+      hi->spectator_neutrons = fBlock.nSpecNeut[fEvent];
+      hi->spectator_protons = fBlock.nSpecProt[fEvent];
+      hi->impact_parameter = fBlock.impactParameter[fEvent];
+      hi->event_plane_angle = fBlock.eventPlaneAngle[fEvent];
+      hi->eccentricity = fBlock.eccentricity[fEvent];
+      hi->sigma_inel_NN = fBlock.sigmaNN[fEvent];
+      hi->centrality = fBlock.centrality[fEvent];
+      evt.set_heavy_ion(hi);
+    }
+
+    fParticle += nparticles;
+    fEvent++;
+
+    /** success **/
+    return true;
+  }
+
+  /*****************************************************************/
+  /*****************************************************************/
+
+} /* namespace eventgen */
+} /* namespace o2 */
@@ -0,0 +1,70 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See https://alice-o2.web.cern.ch/ for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \author R+Preghenella - September 2017
+
+#ifndef ALICEO2_EVENTGEN_READERNATIVE_H_
+#define ALICEO2_EVENTGEN_READERNATIVE_H_
+
+#include "NativeBlock.h"
+#include "SharedMemoryRing.h"
+#include "HepMC/Reader.h"
+
+namespace o2
+{
+namespace eventgen
+{
+
+  /*****************************************************************/
+  /*****************************************************************/
+
+  /** HepMC reader of the native columnar format written by
+      ro2sim-hepmc-convert, the events are rebuilt from the
+      packed particle records as for the shared-memory ring **/
+
+  class ReaderNative : public HepMC::Reader
+  {
+
+  public:
+
+    /** constructor **/
+    ReaderNative(std::istream &stream);
+    /** destructor **/
+    ~ReaderNative();
+
+    /** HepMC::Reader interface **/
+    bool read_event(HepMC::GenEvent &evt) override;
+    bool failed() override {return fFailed;};
+    void close() override {};
+
+    /** static methods **/
+    static const Char_t *GetMagic() {return "o2ev";};
+    static UInt_t GetVersion() {return 1;};
+
+  protected:
+
+    /** data members **/
+    std::istream &fStream;
+    Bool_t fFailed;
+    NativeBlock fBlock;
+    UInt_t fEvent;      // next event in the block
+    UInt_t fParticle;   // first particle of the next event
+    std::vector<SharedMemoryRing::ParticleRecord_t> fRecords;
+    std::vector<HepMC::GenParticlePtr> fParticles;
+
+  }; /** class ReaderNative **/
+
+  /*****************************************************************/
+  /*****************************************************************/
+
+} /** namespace eventgen **/
+} /** namespace o2 **/
+
+#endif /* ALICEO2_EVENTGEN_READERNATIVE_H_ */
@@ -0,0 +1,165 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See https://alice-o2.web.cern.ch/ for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \author R+Preghenella - September 2017
+
+#include "ReaderQueue.h"
+#include "HepMC/Reader.h"
+#include "HepMC/GenEvent.h"
+#include <chrono>
+
+namespace o2
+{
+namespace eventgen
+{
+
+  /*****************************************************************/
+  /*****************************************************************/
+
+  ReaderQueue::ReaderQueue(HepMC::Reader *reader, Int_t depth) :
+    fReader(reader),
+    fDepth(depth < 1 ? 1 : depth),
+    fSlots(),
+    fFree(),
+    fReady(),
+    fThread(),
+    fMutex(),
+    fCondition(),
+    fStop(kFALSE),
+    fEnd(kFALSE),
+    fEvents(0),
+    fFillSum(0.),
+    fStalls(0),
+    fStallTime(0.),
+    fReadTime(0.)
+  {
+    /** constructor **/
+
+  }
+
+  /*****************************************************************/
+
+  ReaderQueue::~ReaderQueue()
+  {
+    /** default destructor **/
+
+    Stop();
+    for (auto &event : fSlots)
+      delete event;
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  ReaderQueue::Start()
+  {
+    /** start, one event more than the depth is held by the consumer **/
+
+    if (fThread.joinable()) return kTRUE;
+    for (Int_t islot = 0; islot < fDepth + 1; islot++) {
+      fSlots.push_back(new HepMC::GenEvent());
+      fFree.push_back(fSlots.back());
+    }
+    fStop = fEnd = kFALSE;
+    fThread = std::thread(&ReaderQueue::ReadLoop, this);
+
+    /** success **/
+    return kTRUE;
+  }
+
+  /*****************************************************************/
+
+  void
+  ReaderQueue::Stop()
+  {
+    /** stop, the reader thread finishes the event it is reading **/
+
+    if (!fThread.joinable()) return;
+    {
+      std::lock_guard<std::mutex> lock(fMutex);
+      fStop = kTRUE;
+    }
+    fCondition.notify_all();
+    fThread.join();
+  }
+
+  /*****************************************************************/
+
+  HepMC::GenEvent *
+  ReaderQueue::Next(HepMC::GenEvent *done)
+  {
+    /** next event, the previous one is given back to the queue.
+	NULL at the end of the input or on failure **/
+
+    std::unique_lock<std::mutex> lock(fMutex);
+    if (done) {
+      fFree.push_back(done);
+      fCondition.notify_all();
+    }
+
+    /** wait for a ready event **/
+    fFillSum += fReady.size();
+    if (fReady.empty() && !fEnd && !fStop) {
+      auto start = std::chrono::steady_clock::now();
+      fCondition.wait(lock, [this] {return fEnd || fStop || !fReady.empty();});
+      std::chrono::duration<Double_t> stall = std::chrono::steady_clock::now() - start;
+      fStallTime += stall.count();
+      fStalls++;
+    }
+    if (fReady.empty()) return NULL;
+    auto event = fReady.front();
+    fReady.pop_front();
+    fEvents++;
+    return event;
+  }
+
+  /*****************************************************************/
+
+  void
+  ReaderQueue::ReadLoop()
+  {
+    /** read loop, runs in the reader thread **/
+
+    while (kTRUE) {
+
+      /** wait for a free event **/
+      std::unique_lock<std::mutex> lock(fMutex);
+      fCondition.wait(lock, [this] {return fStop || !fFree.empty();});
+      if (fStop) return;
+      auto event = fFree.front();
+      fFree.pop_front();
+      lock.unlock();
+
+      /** read event **/
+      auto start = std::chrono::steady_clock::now();
+      event->clear();
+      fReader->read_event(*event);
+      Bool_t status = !fReader->failed();
+      std::chrono::duration<Double_t> elapsed = std::chrono::steady_clock::now() - start;
+
+      /** hand the event over, the end of the input stops the thread **/
+      lock.lock();
+      fReadTime += elapsed.count();
+      if (status) fReady.push_back(event);
+      else {
+	fFree.push_back(event);
+	fEnd = kTRUE;
+      }
+      lock.unlock();
+      fCondition.notify_all();
+      if (!status) return;
+    }
+  }
+
+  /*****************************************************************/
+  /*****************************************************************/
+
+} /* namespace eventgen */
+} /* namespace o2 */
@@ -0,0 +1,102 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See https://alice-o2.web.cern.ch/ for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \author R+Preghenella - September 2017
+
+#ifndef ALICEO2_EVENTGEN_READERQUEUE_H_
+#define ALICEO2_EVENTGEN_READERQUEUE_H_
+
+#include "Rtypes.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+
+namespace HepMC {
+  class Reader;
+  class GenEvent;
+}
+
+namespace o2
+{
+namespace eventgen
+{
+
+  /*****************************************************************/
+  /*****************************************************************/
+
+  /** bounded queue of HepMC events filled by a dedicated reader
+      thread, decompression and parsing overlap with the consumer.
+      the events are owned by the queue and cycled between the
+      free and ready lists, the reader is not owned. to be used on
+      regular files only, Stop waits for the read in progress **/
+
+  class ReaderQueue
+  {
+
+  public:
+
+    /** constructor **/
+    ReaderQueue(HepMC::Reader *reader, Int_t depth);
+    /** destructor **/
+    virtual ~ReaderQueue();
+
+    /** methods **/
+    Bool_t Start();
+    void Stop();
+    HepMC::GenEvent *Next(HepMC::GenEvent *done);
+
+    /** getters **/
+    Int_t GetDepth() const {return fDepth;};
+    Long64_t GetEvents() const {return fEvents;};
+    Double_t GetFillLevel() const {return fEvents > 0 ? fFillSum / fEvents : 0.;};
+    Long64_t GetStalls() const {return fStalls;};
+    Double_t GetStallTime() const {return fStallTime;};
+    Double_t GetReadTime() const {return fReadTime;};
+
+  protected:
+
+    /** copy constructor **/
+    ReaderQueue(const ReaderQueue &);
+    /** operator= **/
+    ReaderQueue &operator=(const ReaderQueue &);
+
+    /** methods **/
+    void ReadLoop();
+
+    /** data members **/
+    HepMC::Reader *fReader;
+    Int_t fDepth;
+    std::vector<HepMC::GenEvent *> fSlots;
+    std::deque<HepMC::GenEvent *> fFree;
+    std::deque<HepMC::GenEvent *> fReady;
+    std::thread fThread;
+    std::mutex fMutex;
+    std::condition_variable fCondition;
+    Bool_t fStop;
+    Bool_t fEnd;
+
+    /** counters **/
+    Long64_t fEvents;     // events delivered from the queue
+    Double_t fFillSum;    // sum of ready events seen at delivery
+    Long64_t fStalls;     // deliveries that had to wait
+    Double_t fStallTime;  // total waiting time [s]
+    Double_t fReadTime;   // total reading time in the reader thread [s]
+
+  }; /** class ReaderQueue **/
+
+  /*****************************************************************/
+  /*****************************************************************/
+
+} /** namespace eventgen **/
+} /** namespace o2 **/
+
+#endif /* ALICEO2_EVENTGEN_READERQUEUE_H_ */
@@ -0,0 +1,191 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See https://alice-o2.web.cern.ch/ for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \author R+Preghenella - September 2017
+
+#include "ReaderSelection.h"
+#include "EventIndex.h"
+#include "FairLogger.h"
+#include "HepMC/GenEvent.h"
+
+namespace o2
+{
+namespace eventgen
+{
+
+  /*****************************************************************/
+  /*****************************************************************/
+
+  ReaderSelection::ReaderSelection(HepMC::Reader *reader, Long64_t first, Long64_t skip, Long64_t stride) :
+    HepMC::Reader(),
+    fReader(reader),
+    fFirst(first),
+    fSkip(skip),
+    fStride(stride < 1 ? 1 : stride),
+    fNext(0),
+    fPosition(0),
+    fStream(NULL),
+    fIndex(NULL),
+    fRandom(kFALSE),
+    fEngine(),
+    fSeed(0),
+    fFailed(kFALSE)
+  {
+    /** constructor **/
+
+    fNext = fFirst + skip * fStride;
+  }
+
+  /*****************************************************************/
+
+  ReaderSelection::~ReaderSelection()
+  {
+    /** default destructor **/
+
+    delete fReader;
+  }
+
+  /*****************************************************************/
+
+  void
+  ReaderSelection::SetIndex(std::istream *stream, const EventIndex *index)
+  {
+    /** set index, the stream is the input of the reader **/
+
+    fStream = stream;
+    fIndex = index;
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  ReaderSelection::SetRandom(UInt_t seed)
+  {
+    /** set random, the events are drawn with replacement.
+	a seed of 0 draws a seed from the system **/
+
+    if (!fIndex) {
+      LOG(ERROR) << "Random event selection requires an event index" << std::endl;
+      return kFALSE;
+    }
+    fRandom = kTRUE;
+    fSeed = seed == 0 ? std::random_device()() : seed;
+    fEngine.seed(fSeed);
+
+    /** success **/
+    return kTRUE;
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  ReaderSelection::Restart(Long64_t events)
+  {
+    /** restart after the first events of the selection, as if they
+	had been read. the random draws are repeated from the seed **/
+
+    if (!fIndex) {
+      LOG(ERROR) << "Restarting the event selection requires an event index" << std::endl;
+      return kFALSE;
+    }
+    fFailed = kFALSE;
+    if (!fRandom) {
+      fNext = fFirst + (fSkip + events) * fStride;
+      return kTRUE;
+    }
+    fEngine.seed(fSeed);
+    auto nselected = (fIndex->GetNumberOfEvents() - fNext + fStride - 1) / fStride;
+    for (Long64_t ievent = 0; ievent < events && nselected > 0; ievent++)
+      std::uniform_int_distribution<Long64_t>(0, nselected - 1)(fEngine);
+
+    /** success **/
+    return kTRUE;
+  }
+
+  /*****************************************************************/
+
+  bool
+  ReaderSelection::read_event(HepMC::GenEvent &evt)
+  {
+    /** read event **/
+
+    if (fFailed) return false;
+
+    /** next selected event, in order or drawn among those left **/
+    auto event = fNext;
+    if (fRandom) {
+      auto nselected = (fIndex->GetNumberOfEvents() - fNext + fStride - 1) / fStride;
+      if (nselected <= 0) {
+	LOG(ERROR) << "No events to select from with first event " << fFirst << " and stride " << fStride << std::endl;
+	fFailed = kTRUE;
+	return false;
+      }
+      event += std::uniform_int_distribution<Long64_t>(0, nselected - 1)(fEngine) * fStride;
+    }
+    else fNext += fStride;
+
+    /** read event **/
+    fFailed = fIndex ? !Seek(event, evt) : !Discard(event, evt);
+    return !fFailed;
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  ReaderSelection::Seek(Long64_t event, HepMC::GenEvent &evt)
+  {
+    /** seek, the input stream is positioned on the event **/
+
+    if (event >= fIndex->GetNumberOfEvents()) return kFALSE;
+
+    /** the header of the file is parsed together with the first event **/
+    if (fPosition == 0 && event > 0 && fIndex->GetOffset(0) > 0)
+      fReader->read_event(evt);
+
+    fStream->clear();
+    fStream->seekg(fIndex->GetOffset(event));
+    evt.clear();
+    fReader->read_event(evt);
+    fPosition = event + 1;
+    return !fReader->failed();
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  ReaderSelection::Discard(Long64_t event, HepMC::GenEvent &evt)
+  {
+    /** discard, the events before the selected one are read through **/
+
+    for (; fPosition <= event; fPosition++) {
+      evt.clear();
+      fReader->read_event(evt);
+      if (fReader->failed()) return kFALSE;
+    }
+
+    /** success **/
+    return kTRUE;
+  }
+
+  /*****************************************************************/
+
+  void
+  ReaderSelection::close()
+  {
+    /** close **/
+
+    fReader->close();
+  }
+
+  /*****************************************************************/
+  /*****************************************************************/
+
+} /* namespace eventgen */
+} /* namespace o2 */
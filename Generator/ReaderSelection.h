@@ -0,0 +1,88 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See https://alice-o2.web.cern.ch/ for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \author R+Preghenella - September 2017
+
+#ifndef ALICEO2_EVENTGEN_READERSELECTION_H_
+#define ALICEO2_EVENTGEN_READERSELECTION_H_
+
+#include "HepMC/Reader.h"
+#include "Rtypes.h"
+#include <istream>
+#include <random>
+
+namespace o2
+{
+namespace eventgen
+{
+
+  class EventIndex;
+
+  /*****************************************************************/
+  /*****************************************************************/
+
+  /** HepMC reader of a selection of the events of another reader.
+      the selected events are first_event + (skip + i) * stride,
+      in order or drawn at random. with an event index the input
+      stream is positioned on the selected events, otherwise the
+      events in between are read and discarded. the reader is owned **/
+
+  class ReaderSelection : public HepMC::Reader
+  {
+
+  public:
+
+    /** constructor **/
+    ReaderSelection(HepMC::Reader *reader, Long64_t first, Long64_t skip, Long64_t stride);
+    /** destructor **/
+    ~ReaderSelection();
+
+    /** methods **/
+    void SetIndex(std::istream *stream, const EventIndex *index);
+    Bool_t SetRandom(UInt_t seed);
+    Bool_t Restart(Long64_t events);
+
+    /** getters **/
+    UInt_t GetSeed() const {return fSeed;};
+
+    /** HepMC::Reader interface **/
+    bool read_event(HepMC::GenEvent &evt) override;
+    bool failed() override {return fFailed;};
+    void close() override;
+
+  protected:
+
+    /** methods **/
+    Bool_t Seek(Long64_t event, HepMC::GenEvent &evt);
+    Bool_t Discard(Long64_t event, HepMC::GenEvent &evt);
+
+    /** data members **/
+    HepMC::Reader *fReader;
+    Long64_t fFirst;
+    Long64_t fSkip;
+    Long64_t fStride;
+    Long64_t fNext;       // next selected event
+    Long64_t fPosition;   // next event of the input stream
+    std::istream *fStream;
+    const EventIndex *fIndex;
+    Bool_t fRandom;
+    std::mt19937_64 fEngine;
+    UInt_t fSeed;         // seed of the random draws, drawn if not given
+    Bool_t fFailed;
+
+  }; /** class ReaderSelection **/
+
+  /*****************************************************************/
+  /*****************************************************************/
+
+} /** namespace eventgen **/
+} /** namespace o2 **/
+
+#endif /* ALICEO2_EVENTGEN_READERSELECTION_H_ */
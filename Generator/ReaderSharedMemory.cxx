@@ -0,0 +1,132 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See https://alice-o2.web.cern.ch/ for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \author R+Preghenella - September 2017
+
+#include "ReaderSharedMemory.h"
+#include "HepMC/GenEvent.h"
+#include "HepMC/GenParticle.h"
+#include "HepMC/GenVertex.h"
+#include "HepMC/GenCrossSection.h"
+
+namespace o2
+{
+namespace eventgen
+{
+
+  /*****************************************************************/
+  /*****************************************************************/
+
+  ReaderSharedMemory::ReaderSharedMemory(const std::string &name) :
+    HepMC::Reader(),
+    fRing(),
+    fFailed(kFALSE),
+    fHeader(),
+    fRecords(),
+    fParticles()
+  {
+    /** constructor **/
+
+    fFailed = !fRing.Open(name);
+  }
+
+  /*****************************************************************/
+
+  ReaderSharedMemory::~ReaderSharedMemory()
+  {
+    /** default destructor **/
+
+    close();
+  }
+
+  /*****************************************************************/
+
+  bool
+  ReaderSharedMemory::read_event(HepMC::GenEvent &evt)
+  {
+    /** read event **/
+
+    if (fFailed) return false;
+    if (!fRing.ReadEvent(fHeader, fRecords)) {
+      fFailed = kTRUE;
+      return false;
+    }
+
+    /** setup event **/
+    evt.clear();
+    evt.set_units(HepMC::Units::GEV, HepMC::Units::MM);
+    evt.set_event_number(fHeader.number);
+
+    /** add particles **/
+    FillParticles(evt, fRecords, fParticles);
+
+    /** cross-section **/
+    if (fHeader.flags & SharedMemoryRing::kCrossSection) {
+      auto cs = std::make_shared<HepMC::GenCrossSection>();
+      cs->set_cross_section(fHeader.crossSection, fHeader.crossSectionError);
+      cs->accepted_events = fHeader.acceptedEvents;
+      cs->attempted_events = fHeader.attemptedEvents;
+      evt.set_cross_section(cs);
+    }
+    
+    /** success **/
+    return true;
+  }
+
+  /*****************************************************************/
+
+  void
+  ReaderSharedMemory::FillParticles(HepMC::GenEvent &evt, const std::vector<SharedMemoryRing::ParticleRecord_t> &records,
+				    std::vector<HepMC::GenParticlePtr> &particles)
+  {
+    /** fill particles in record order, daughters are attached 
+	to the end vertex of their mother, which is created 
+	at the production point of the first daughter **/
+    particles.resize(records.size());
+    for (size_t ipart = 0; ipart < records.size(); ipart++) {
+      auto const &record = records[ipart];
+      auto particle = std::make_shared<HepMC::GenParticle>(HepMC::FourVector(record.px, record.py, record.pz, record.e), record.pdg, record.status);
+      evt.add_particle(particle);
+      particles[ipart] = particle;
+      HepMC::FourVector position(record.vx, record.vy, record.vz, record.vt);
+      /** primary particle **/
+      if (record.mother < 0 || record.mother >= (Int_t)ipart) {
+	auto vertex = std::make_shared<HepMC::GenVertex>(position);
+	vertex->add_particle_out(particle);
+	evt.add_vertex(vertex);
+	continue;
+      }
+      /** daughter particle **/
+      auto mother = particles[record.mother];
+      auto vertex = mother->end_vertex();
+      if (!vertex) {
+	vertex = std::make_shared<HepMC::GenVertex>(position);
+	vertex->add_particle_in(mother);
+	evt.add_vertex(vertex);
+      }
+      vertex->add_particle_out(particle);
+    }
+  }
+
+  /*****************************************************************/
+
+  void
+  ReaderSharedMemory::close()
+  {
+    /** close **/
+
+    fRing.Close();
+  }
+
+  /*****************************************************************/
+  /*****************************************************************/
+    
+} /* namespace eventgen */
+} /* namespace o2 */
@@ -0,0 +1,66 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See https://alice-o2.web.cern.ch/ for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \author R+Preghenella - September 2017
+
+#ifndef ALICEO2_EVENTGEN_READERSHAREDMEMORY_H_
+#define ALICEO2_EVENTGEN_READERSHAREDMEMORY_H_
+
+#include "SharedMemoryRing.h"
+#include "HepMC/Reader.h"
+
+namespace o2
+{
+namespace eventgen
+{
+
+  /*****************************************************************/
+  /*****************************************************************/
+
+  /** HepMC reader of the packed events written by an external 
+      generator process into a shared-memory ring **/
+  
+  class ReaderSharedMemory : public HepMC::Reader
+  {
+    
+  public:
+
+    /** constructor **/
+    ReaderSharedMemory(const std::string &name);
+    /** destructor **/
+    ~ReaderSharedMemory();
+
+    /** HepMC::Reader interface **/
+    bool read_event(HepMC::GenEvent &evt) override;
+    bool failed() override {return fFailed;};
+    void close() override;
+
+    /** static methods **/
+    static void FillParticles(HepMC::GenEvent &evt, const std::vector<SharedMemoryRing::ParticleRecord_t> &records,
+			      std::vector<HepMC::GenParticlePtr> &particles);
+    
+  protected:
+
+    /** data members **/
+    SharedMemoryRing fRing;
+    Bool_t fFailed;
+    SharedMemoryRing::EventHeader_t fHeader;
+    std::vector<SharedMemoryRing::ParticleRecord_t> fRecords;
+    std::vector<HepMC::GenParticlePtr> fParticles;
+    
+  }; /** class ReaderSharedMemory **/
+  
+  /*****************************************************************/
+  /*****************************************************************/
+    
+} /** namespace eventgen **/
+} /** namespace o2 **/
+
+#endif /* ALICEO2_EVENTGEN_READERSHAREDMEMORY_H_ */ 
@@ -0,0 +1,328 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See https://alice-o2.web.cern.ch/ for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \author R+Preghenella - September 2017
+
+#include "SharedMemoryRing.h"
+#include "FairLogger.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <algorithm>
+
+namespace o2
+{
+namespace eventgen
+{
+
+  /*****************************************************************/
+  /*****************************************************************/
+
+  SharedMemoryRing::SharedMemoryRing() :
+    fName(),
+    fOwner(kFALSE),
+    fAttachTimeout(0),
+    fCreateTime(0),
+    fSize(0),
+    fControl(NULL),
+    fData(NULL)
+  {
+    /** default constructor **/
+
+  }
+
+  /*****************************************************************/
+
+  SharedMemoryRing::~SharedMemoryRing()
+  {
+    /** default destructor **/
+
+    Close();
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  SharedMemoryRing::Create(const std::string &name, ULong64_t capacity, Int_t attachTimeout)
+  {
+    /** create, to be called by the writer. the segment is
+	removed if no reader attaches within the timeout **/
+
+    /** create segment **/
+    Int_t fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+    if (fd < 0) {
+      LOG(ERROR) << "Cannot create shared memory segment " << name << ": " << strerror(errno) << std::endl;
+      return kFALSE;
+    }
+    ULong64_t size = sizeof(Control_t) + capacity;
+    if (ftruncate(fd, size) < 0) {
+      LOG(ERROR) << "Cannot resize shared memory segment " << name << ": " << strerror(errno) << std::endl;
+      close(fd);
+      shm_unlink(name.c_str());
+      return kFALSE;
+    }
+    fName = name;
+    fOwner = kTRUE;
+    fAttachTimeout = attachTimeout;
+    fCreateTime = time(NULL);
+    if (!Map(fd, size)) return kFALSE;
+
+    /** setup process-shared synchronisation **/
+    pthread_mutexattr_t mutexattr;
+    pthread_mutexattr_init(&mutexattr);
+    pthread_mutexattr_setpshared(&mutexattr, PTHREAD_PROCESS_SHARED);
+    pthread_mutex_init(&fControl->mutex, &mutexattr);
+    pthread_mutexattr_destroy(&mutexattr);
+    pthread_condattr_t condattr;
+    pthread_condattr_init(&condattr);
+    pthread_condattr_setpshared(&condattr, PTHREAD_PROCESS_SHARED);
+    pthread_cond_init(&fControl->notEmpty, &condattr);
+    pthread_cond_init(&fControl->notFull, &condattr);
+    pthread_condattr_destroy(&condattr);
+
+    /** setup control, the magic number is set last **/
+    fControl->version = fgVersion;
+    fControl->capacity = capacity;
+    fControl->head = 0;
+    fControl->tail = 0;
+    fControl->writerPid = getpid();
+    fControl->readerPid = 0;
+    fControl->writerDone = 0;
+    __sync_synchronize();
+    fControl->magic = fgMagic;
+    
+    /** success **/
+    return kTRUE;
+  }
+  
+  /*****************************************************************/
+
+  Bool_t
+  SharedMemoryRing::Open(const std::string &name, Int_t timeout)
+  {
+    /** open, to be called by the reader **/
+
+    /** wait for the writer to create the segment **/
+    for (Int_t itry = 0; itry < 10 * timeout; itry++) {
+      Int_t fd = shm_open(name.c_str(), O_RDWR, 0);
+      struct stat st;
+      if (fd >= 0 && fstat(fd, &st) == 0 && st.st_size > (off_t)sizeof(Control_t)) {
+	fName = name;
+	fOwner = kFALSE;
+	if (!Map(fd, st.st_size)) return kFALSE;
+	__sync_synchronize();
+	if (fControl->magic == fgMagic) break;
+	munmap(fControl, fSize);
+	fControl = NULL;
+	fData = NULL;
+      }
+      else if (fd >= 0) close(fd);
+      usleep(100000);
+    }
+    if (!fControl) {
+      LOG(ERROR) << "Cannot open shared memory segment " << name << std::endl;
+      return kFALSE;
+    }
+    if (fControl->version != fgVersion) {
+      LOG(ERROR) << "Unsupported shared memory ring version: " << fControl->version << std::endl;
+      Close();
+      return kFALSE;
+    }
+    
+    /** attach and remove the name, the mapping stays valid **/
+    fControl->readerPid = getpid();
+    shm_unlink(name.c_str());
+
+    /** success **/
+    return kTRUE;
+  }
+  
+  /*****************************************************************/
+
+  Bool_t
+  SharedMemoryRing::Map(Int_t fd, ULong64_t size)
+  {
+    /** map **/
+
+    void *address = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (address == MAP_FAILED) {
+      LOG(ERROR) << "Cannot map shared memory segment " << fName << ": " << strerror(errno) << std::endl;
+      return kFALSE;
+    }
+    fSize = size;
+    fControl = (Control_t *)address;
+    fData = (Char_t *)address + sizeof(Control_t);
+    return kTRUE;
+  }
+
+  /*****************************************************************/
+
+  void
+  SharedMemoryRing::Close()
+  {
+    /** close **/
+
+    if (!fControl) return;
+    if (fOwner) shm_unlink(fName.c_str());
+    munmap(fControl, fSize);
+    fControl = NULL;
+    fData = NULL;
+    fSize = 0;
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  SharedMemoryRing::WriteEvent(const EventHeader_t &header, const ParticleRecord_t *particles)
+  {
+    /** write event **/
+
+    ULong64_t nbytes = sizeof(EventHeader_t) + header.nParticles * sizeof(ParticleRecord_t);
+    if (nbytes > fControl->capacity) {
+      LOG(ERROR) << "Event does not fit in shared memory ring: " << nbytes << " bytes" << std::endl;
+      return kFALSE;
+    }
+
+    /** wait for space, the attach deadline is checked
+	on every write until the reader is there **/
+    pthread_mutex_lock(&fControl->mutex);
+    while (true) {
+      /** the reader never attached **/
+      if (fControl->readerPid == 0 && fAttachTimeout > 0 && time(NULL) - fCreateTime > fAttachTimeout) {
+	pthread_mutex_unlock(&fControl->mutex);
+	LOG(ERROR) << "No reader attached to shared memory segment " << fName << " within " << fAttachTimeout << " s" << std::endl;
+	shm_unlink(fName.c_str());
+	return kFALSE;
+      }
+      if (fControl->capacity - (fControl->head - fControl->tail) >= nbytes) break;
+      struct timespec deadline;
+      clock_gettime(CLOCK_REALTIME, &deadline);
+      deadline.tv_sec += 1;
+      pthread_cond_timedwait(&fControl->notFull, &fControl->mutex, &deadline);
+      if (fControl->readerPid != 0 && !IsAlive(fControl->readerPid)) {
+	pthread_mutex_unlock(&fControl->mutex);
+	return kFALSE;
+      }
+    }
+    ULong64_t head = fControl->head;
+    pthread_mutex_unlock(&fControl->mutex);
+
+    /** copy, the region is not visible to the reader yet **/
+    CopyIn(head, &header, sizeof(EventHeader_t));
+    CopyIn(head + sizeof(EventHeader_t), particles, nbytes - sizeof(EventHeader_t));
+
+    /** publish **/
+    pthread_mutex_lock(&fControl->mutex);
+    fControl->head += nbytes;
+    pthread_cond_signal(&fControl->notEmpty);
+    pthread_mutex_unlock(&fControl->mutex);
+    
+    /** success **/
+    return kTRUE;
+  }
+  
+  /*****************************************************************/
+
+  Bool_t
+  SharedMemoryRing::ReadEvent(EventHeader_t &header, std::vector<ParticleRecord_t> &particles)
+  {
+    /** read event **/
+
+    /** wait for an event **/
+    pthread_mutex_lock(&fControl->mutex);
+    while (fControl->head == fControl->tail) {
+      if (fControl->writerDone || !IsAlive(fControl->writerPid)) {
+	pthread_mutex_unlock(&fControl->mutex);
+	return kFALSE;
+      }
+      struct timespec deadline;
+      clock_gettime(CLOCK_REALTIME, &deadline);
+      deadline.tv_sec += 1;
+      pthread_cond_timedwait(&fControl->notEmpty, &fControl->mutex, &deadline);
+    }
+    ULong64_t tail = fControl->tail;
+    pthread_mutex_unlock(&fControl->mutex);
+
+    /** copy, events are always published whole **/
+    CopyOut(tail, &header, sizeof(EventHeader_t));
+    particles.resize(header.nParticles);
+    ULong64_t nbytes = sizeof(EventHeader_t) + header.nParticles * sizeof(ParticleRecord_t);
+    CopyOut(tail + sizeof(EventHeader_t), particles.data(), nbytes - sizeof(EventHeader_t));
+
+    /** release **/
+    pthread_mutex_lock(&fControl->mutex);
+    fControl->tail += nbytes;
+    pthread_cond_signal(&fControl->notFull);
+    pthread_mutex_unlock(&fControl->mutex);
+
+    /** success **/
+    return kTRUE;
+  }
+
+  /*****************************************************************/
+
+  void
+  SharedMemoryRing::SetWriterDone()
+  {
+    /** set writer done **/
+
+    pthread_mutex_lock(&fControl->mutex);
+    fControl->writerDone = 1;
+    pthread_cond_broadcast(&fControl->notEmpty);
+    pthread_mutex_unlock(&fControl->mutex);
+  }
+  
+  /*****************************************************************/
+
+  void
+  SharedMemoryRing::CopyIn(ULong64_t position, const void *buffer, ULong64_t size)
+  {
+    /** copy in, wrapping around the end of the data area **/
+
+    ULong64_t offset = position % fControl->capacity;
+    ULong64_t first = std::min(size, fControl->capacity - offset);
+    memcpy(fData + offset, buffer, first);
+    memcpy(fData, (const Char_t *)buffer + first, size - first);
+  }
+
+  /*****************************************************************/
+
+  void
+  SharedMemoryRing::CopyOut(ULong64_t position, void *buffer, ULong64_t size) const
+  {
+    /** copy out, wrapping around the end of the data area **/
+
+    ULong64_t offset = position % fControl->capacity;
+    ULong64_t first = std::min(size, fControl->capacity - offset);
+    memcpy(buffer, fData + offset, first);
+    memcpy((Char_t *)buffer + first, fData, size - first);
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  SharedMemoryRing::IsAlive(Int_t pid) const
+  {
+    /** is alive **/
+
+    return pid > 0 && (kill(pid, 0) == 0 || errno == EPERM);
+  }
+  
+  /*****************************************************************/
+  /*****************************************************************/
+    
+} /* namespace eventgen */
+} /* namespace o2 */
@@ -0,0 +1,122 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See https://alice-o2.web.cern.ch/ for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \author R+Preghenella - September 2017
+
+#ifndef ALICEO2_EVENTGEN_SHAREDMEMORYRING_H_
+#define ALICEO2_EVENTGEN_SHAREDMEMORYRING_H_
+
+#include "Rtypes.h"
+#include <pthread.h>
+#include <string>
+#include <vector>
+#include <ctime>
+
+namespace o2
+{
+namespace eventgen
+{
+
+  /*****************************************************************/
+  /*****************************************************************/
+
+  /** single-producer single-consumer ring buffer of packed events
+      in POSIX shared memory, used as binary event channel between
+      an external generator process and ro2sim. units are GeV, mm **/
+  
+  class SharedMemoryRing
+  {
+    
+  public:
+
+    /** packed records **/
+    struct EventHeader_t {
+      Long64_t number;
+      Int_t    nParticles;
+      Int_t    flags;
+      Double_t crossSection;       // [pb]
+      Double_t crossSectionError;  // [pb]
+      Long64_t acceptedEvents;
+      Long64_t attemptedEvents;
+    };
+    struct ParticleRecord_t {
+      Int_t    pdg;
+      Int_t    status;
+      Int_t    mother;               // index in the event, -1 if none
+      Int_t    reserved;
+      Double_t px, py, pz, e;        // [GeV]
+      Double_t vx, vy, vz, vt;       // [mm], [mm/c]
+    };
+    enum EEventFlags_t {
+      kCrossSection = 0x1
+    };
+    
+    /** default constructor **/
+    SharedMemoryRing();
+    /** destructor **/
+    virtual ~SharedMemoryRing();
+
+    /** methods **/
+    Bool_t Create(const std::string &name, ULong64_t capacity, Int_t attachTimeout = 60);
+    Bool_t Open(const std::string &name, Int_t timeout = 60);
+    void Close();
+    Bool_t WriteEvent(const EventHeader_t &header, const ParticleRecord_t *particles);
+    Bool_t ReadEvent(EventHeader_t &header, std::vector<ParticleRecord_t> &particles);
+    void SetWriterDone();
+    
+  protected:
+
+    /** copy constructor **/
+    SharedMemoryRing(const SharedMemoryRing &);
+    /** operator= **/
+    SharedMemoryRing &operator=(const SharedMemoryRing &);
+
+    /** control block at the beginning of the segment **/
+    struct Control_t {
+      UInt_t          magic;
+      UInt_t          version;
+      ULong64_t       capacity;    // size of the data area
+      ULong64_t       head;        // bytes written so far
+      ULong64_t       tail;        // bytes read so far
+      Int_t           writerPid;
+      Int_t           readerPid;
+      Int_t           writerDone;
+      pthread_mutex_t mutex;
+      pthread_cond_t  notEmpty;
+      pthread_cond_t  notFull;
+    };
+    
+    /** methods **/
+    Bool_t Map(Int_t fd, ULong64_t size);
+    void CopyIn(ULong64_t position, const void *buffer, ULong64_t size);
+    void CopyOut(ULong64_t position, void *buffer, ULong64_t size) const;
+    Bool_t IsAlive(Int_t pid) const;
+    
+    /** data members **/
+    std::string fName;
+    Bool_t fOwner;
+    Int_t fAttachTimeout;   // [s] for the reader to attach, 0 waits forever
+    time_t fCreateTime;
+    ULong64_t fSize;
+    Control_t *fControl;
+    Char_t *fData;
+
+    static const UInt_t fgMagic = 0x6f32736d; // "o2sm"
+    static const UInt_t fgVersion = 1;
+    
+  }; /** class SharedMemoryRing **/
+  
+  /*****************************************************************/
+  /*****************************************************************/
+    
+} /** namespace eventgen **/
+} /** namespace o2 **/
+
+#endif /* ALICEO2_EVENTGEN_SHAREDMEMORYRING_H_ */ 
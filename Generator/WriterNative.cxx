@@ -0,0 +1,162 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See https://alice-o2.web.cern.ch/ for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \author R+Preghenella - September 2017
+
+#include "WriterNative.h"
+#include "ReaderNative.h"
+#include "FairLogger.h"
+#include "HepMC/GenEvent.h"
+#include "HepMC/GenParticle.h"
+#include "HepMC/GenVertex.h"
+#include "HepMC/GenCrossSection.h"
+#include "HepMC/GenHeavyIon.h"
+#include "HepMC/Units.h"
+
+namespace o2
+{
+namespace eventgen
+{
+
+  /*****************************************************************/
+  /*****************************************************************/
+
+  WriterNative::WriterNative(const std::string &filename, UInt_t blockSize) :
+    HepMC::Writer(),
+    fStream(filename, std::ios::out | std::ios::binary | std::ios::trunc),
+    fBlockSize(blockSize < 1 ? 1 : blockSize),
+    fFailed(kFALSE),
+    fBlock()
+  {
+    /** constructor **/
+
+    /** write magic and version **/
+    UInt_t version = ReaderNative::GetVersion();
+    fStream.write(ReaderNative::GetMagic(), 4);
+    fStream.write(reinterpret_cast<const Char_t *>(&version), sizeof(version));
+    if (!fStream.good()) {
+      LOG(ERROR) << "Cannot open output file: " << filename << std::endl;
+      fFailed = kTRUE;
+    }
+  }
+
+  /*****************************************************************/
+
+  WriterNative::~WriterNative()
+  {
+    /** default destructor **/
+
+    close();
+  }
+
+  /*****************************************************************/
+
+  void
+  WriterNative::write_event(const HepMC::GenEvent &evt)
+  {
+    /** write event **/
+
+    if (fFailed) return;
+
+    /** unit conversion to GeV, mm **/
+    auto pconv = HepMC::Units::conversion_factor(evt.momentum_unit(), HepMC::Units::GEV);
+    auto lconv = HepMC::Units::conversion_factor(evt.length_unit(), HepMC::Units::MM);
+
+    /** particle columns, the mother is looked up as in GeneratorHepMC **/
+    auto const &particles = evt.particles();
+    for (auto const &particle : particles) {
+      auto const &momentum = particle->momentum();
+      auto const &production = particle->production_vertex();
+      Double_t vx = 0., vy = 0., vz = 0., vt = 0.;
+      if (production) {
+	auto const &position = production->position();
+	vx = position.x() * lconv;
+	vy = position.y() * lconv;
+	vz = position.z() * lconv;
+	vt = position.t() * lconv;
+      }
+      auto mother = -1;
+      if (production && !production->particles_in().empty())
+	mother = production->particles_in().front()->id() - 1;
+      fBlock.pdg.push_back(particle->pid());
+      fBlock.status.push_back(particle->status());
+      fBlock.mother.push_back(mother);
+      fBlock.px.push_back(momentum.x() * pconv);
+      fBlock.py.push_back(momentum.y() * pconv);
+      fBlock.pz.push_back(momentum.z() * pconv);
+      fBlock.e.push_back(momentum.t() * pconv);
+      fBlock.vx.push_back(vx);
+      fBlock.vy.push_back(vy);
+      fBlock.vz.push_back(vz);
+      fBlock.vt.push_back(vt);
+    }
+
+    /** event columns **/
+    Int_t flags = 0;
+    fBlock.number.push_back(evt.event_number());
+    fBlock.nParticles.push_back(particles.size());
+    auto cs = evt.cross_section();
+    Bool_t csvalid = cs && cs->is_valid();
+    if (csvalid) flags |= NativeBlock::kCrossSection;
+    fBlock.crossSection.push_back(csvalid ? cs->cross_section : 0.);
+    fBlock.crossSectionError.push_back(csvalid ? cs->cross_section_error : 0.);
+    fBlock.acceptedEvents.push_back(csvalid ? cs->accepted_events : 0);
+    fBlock.attemptedEvents.push_back(csvalid ? cs->attempted_events : 0);
+    auto hi = evt.heavy_ion();
+    Bool_t hivalid = hi && hi->is_valid();
+    if (hivalid) flags |= NativeBlock::kHeavyIon;
+    fBlock.nCollHard.push_back(hivalid ? hi->Ncoll_hard : 0);
+    fBlock.nPartProj.push_back(hivalid ? hi->Npart_proj : 0);
+    fBlock.nPartTarg.push_back(hivalid ? hi->Npart_targ : 0);
+    fBlock.nColl.push_back(hivalid ? hi->Ncoll : 0);
+    fBlock.nSpecNeut.push_back(hivalid ? hi->spectator_neutrons : 0);
+    fBlock.nSpecProt.push_back(hivalid ? hi->spectator_protons : 0);
+    fBlock.impactParameter.push_back(hivalid ? hi->impact_parameter : 0.);
+    fBlock.eventPlaneAngle.push_back(hivalid ? hi->event_plane_angle : 0.);
+    fBlock.eccentricity.push_back(hivalid ? hi->eccentricity : 0.);
+    fBlock.sigmaNN.push_back(hivalid ? hi->sigma_inel_NN : 0.);
+    fBlock.centrality.push_back(hivalid ? hi->centrality : 0.);
+    fBlock.flags.push_back(flags);
+
+    /** write full block **/
+    if (fBlock.GetNumberOfEvents() >= fBlockSize && !Flush()) fFailed = kTRUE;
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  WriterNative::Flush()
+  {
+    /** flush, the buffered block is written out **/
+
+    if (fBlock.GetNumberOfEvents() == 0) return kTRUE;
+    auto retval = fBlock.Write(fStream);
+    fBlock.Clear();
+    if (!retval) LOG(ERROR) << "Failed writing native event output" << std::endl;
+    return retval;
+  }
+
+  /*****************************************************************/
+
+  void
+  WriterNative::close()
+  {
+    /** close **/
+
+    if (!fStream.is_open()) return;
+    if (!fFailed && !Flush()) fFailed = kTRUE;
+    fStream.close();
+  }
+
+  /*****************************************************************/
+  /*****************************************************************/
+
+} /* namespace eventgen */
+} /* namespace o2 */
@@ -0,0 +1,66 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See https://alice-o2.web.cern.ch/ for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \author R+Preghenella - September 2017
+
+#ifndef ALICEO2_EVENTGEN_WRITERNATIVE_H_
+#define ALICEO2_EVENTGEN_WRITERNATIVE_H_
+
+#include "NativeBlock.h"
+#include "HepMC/Writer.h"
+#include <fstream>
+#include <string>
+
+namespace o2
+{
+namespace eventgen
+{
+
+  /*****************************************************************/
+  /*****************************************************************/
+
+  /** HepMC writer of the native columnar format, the events
+      are buffered and written out in blocks **/
+
+  class WriterNative : public HepMC::Writer
+  {
+
+  public:
+
+    /** constructor **/
+    WriterNative(const std::string &filename, UInt_t blockSize = 256);
+    /** destructor **/
+    ~WriterNative();
+
+    /** HepMC::Writer interface **/
+    void write_event(const HepMC::GenEvent &evt) override;
+    bool failed() override {return fFailed;};
+    void close() override;
+
+  protected:
+
+    /** methods **/
+    Bool_t Flush();
+
+    /** data members **/
+    std::ofstream fStream;
+    UInt_t fBlockSize;
+    Bool_t fFailed;
+    NativeBlock fBlock;
+
+  }; /** class WriterNative **/
+
+  /*****************************************************************/
+  /*****************************************************************/
+
+} /** namespace eventgen **/
+} /** namespace o2 **/
+
+#endif /* ALICEO2_EVENTGEN_WRITERNATIVE_H_ */
@@ -26,12 +26,18 @@
 #pragma link C++ class o2::eventgen::GeneratorHepMC+;
 #pragma link C++ class o2::eventgen::GeneratorTGenerator+;
 
+#pragma link C++ struct o2::eventgen::MCEventHeader::GeneratorRecord_t+;
+#pragma link C++ class std::vector<o2::eventgen::MCEventHeader::GeneratorRecord_t>+;
+#pragma link C++ struct o2::eventgen::MCEventHeader::SubEventRecord_t+;
+#pragma link C++ class std::vector<o2::eventgen::MCEventHeader::SubEventRecord_t>+;
 #pragma link C++ class std::vector<GeneratorHeader *>;
-#pragma link C++ class std::map<std::string, GeneratorInfo *>+;
+
+#pragma read sourceClass="o2::eventgen::MCEventHeader" targetClass="o2::eventgen::MCEventHeader" version="[1]" \
+  source="std::vector<o2::eventgen::GeneratorHeader*> fGeneratorHeaders" target="fGeneratorRecords, fGeneratorNames" \
+  code="{ fGeneratorRecords.clear(); for (auto header : onfile.fGeneratorHeaders) { newObj->AddHeader(header); delete header; } onfile.fGeneratorHeaders.clear(); }"
 
 #pragma link C++ class o2sim::GeneratorManager+;
 #pragma link C++ class o2sim::GeneratorManagerBox+;
-#pragma link C++ class o2sim::GeneratorManagerPythia+;
-#pragma link C++ class o2sim::GeneratorManagerHijing+;
+#pragma link C++ class o2sim::GeneratorManagerHepMC+;
 
 #endif
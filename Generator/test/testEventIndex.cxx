@@ -0,0 +1,118 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See https://alice-o2.web.cern.ch/ for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \author R+Preghenella - September 2017
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <unistd.h>
+#include "Generator/EventIndex.h"
+
+/** event index test, build, save and load round trip and
+    rejection of sidecar files with a corrupt event count **/
+
+using o2::eventgen::EventIndex;
+
+Int_t gFailures = 0;
+
+/*****************************************************************/
+
+void
+check(Bool_t condition, const std::string &what)
+{
+  /** check **/
+
+  if (condition) return;
+  std::cout << "FAILED: " << what << std::endl;
+  gFailures++;
+}
+
+/*****************************************************************/
+
+void
+patchEventCount(const std::string &indexname, ULong64_t nevents)
+{
+  /** overwrite the event count, after magic, version, size and time **/
+
+  std::fstream fout(indexname, std::ios::in | std::ios::out | std::ios::binary);
+  fout.seekp(2 * sizeof(UInt_t) + sizeof(ULong64_t) + sizeof(Long64_t));
+  fout.write((const char *)&nevents, sizeof(nevents));
+}
+
+/*****************************************************************/
+
+int
+main (Int_t argc, char **argv)
+{
+
+  /** ascii input, an "E" inside a line is not an event **/
+  std::string filename = "testEventIndex." + std::to_string(getpid()) + ".hepmc";
+  auto indexname = EventIndex::GetIndexFileName(filename);
+  std::vector<ULong64_t> offsets;
+  {
+    std::ofstream fout(filename);
+    fout << "HepMC::Version 3.0.0\n";
+    for (Int_t ievent = 0; ievent < 5; ievent++) {
+      offsets.push_back(fout.tellp());
+      fout << "E " << ievent << " 2 3\nU GEV MM\nP 1 0 2212 E 0 0 0\n";
+    }
+  }
+
+  /** build and save **/
+  {
+    EventIndex index;
+    check(index.Init(filename), "build");
+    check(index.GetNumberOfEvents() == 5, "built events");
+    for (Int_t ievent = 0; ievent < 5 && ievent < index.GetNumberOfEvents(); ievent++)
+      check(index.GetOffset(ievent) == offsets[ievent], "built offset " + std::to_string(ievent));
+  }
+
+  /** load **/
+  {
+    EventIndex index;
+    check(index.Init(filename), "init from the saved index");
+    check(index.Load(indexname), "load");
+    check(index.GetNumberOfEvents() == 5, "loaded events");
+    for (Int_t ievent = 0; ievent < 5 && ievent < index.GetNumberOfEvents(); ievent++)
+      check(index.GetOffset(ievent) == offsets[ievent], "loaded offset " + std::to_string(ievent));
+  }
+
+  /** corrupt event counts are rejected before allocating **/
+  for (auto nevents : {4ull, 6ull, 1ull << 60, ~0ull}) {
+    EventIndex index;
+    check(index.Init(filename), "init");
+    patchEventCount(indexname, nevents);
+    check(!index.Load(indexname), "reject event count " + std::to_string(nevents));
+    check(index.GetNumberOfEvents() == 0, "no events after rejection");
+    check(index.Init(filename) && index.GetNumberOfEvents() == 5, "rebuild after rejection");
+  }
+
+  /** truncated index **/
+  {
+    EventIndex index;
+    check(index.Init(filename), "init");
+    check(truncate(indexname.c_str(), 40) == 0, "truncate");
+    check(!index.Load(indexname), "reject truncated index");
+  }
+
+  std::remove(filename.c_str());
+  std::remove(indexname.c_str());
+
+  /** summary **/
+  if (gFailures > 0) {
+    std::cout << "testEventIndex: " << gFailures << " failures" << std::endl;
+    return 1;
+  }
+  std::cout << "testEventIndex: success" << std::endl;
+  return 0;
+}
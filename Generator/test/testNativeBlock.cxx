@@ -0,0 +1,145 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See https://alice-o2.web.cern.ch/ for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \author R+Preghenella - September 2017
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include "Generator/NativeBlock.h"
+
+/** native block test, write and read round trip and rejection
+    of corrupt counts and truncated blocks **/
+
+using o2::eventgen::NativeBlock;
+
+Int_t gFailures = 0;
+
+/*****************************************************************/
+
+void
+check(Bool_t condition, const std::string &what)
+{
+  /** check **/
+
+  if (condition) return;
+  std::cout << "FAILED: " << what << std::endl;
+  gFailures++;
+}
+
+/*****************************************************************/
+
+void
+fill(NativeBlock &block, Int_t nevents)
+{
+  /** fill, event i has i + 1 particles **/
+
+  block.Clear();
+  for (Int_t ievent = 0; ievent < nevents; ievent++) {
+    block.number.push_back(ievent);
+    block.nParticles.push_back(ievent + 1);
+    block.flags.push_back(NativeBlock::kCrossSection | NativeBlock::kHeavyIon);
+    block.acceptedEvents.push_back(ievent);
+    block.attemptedEvents.push_back(2 * ievent);
+    for (auto column : {&block.nCollHard, &block.nPartProj, &block.nPartTarg, &block.nColl, &block.nSpecNeut, &block.nSpecProt})
+      column->push_back(ievent);
+    for (auto column : {&block.crossSection, &block.crossSectionError, &block.impactParameter, &block.eventPlaneAngle,
+	  &block.eccentricity, &block.sigmaNN, &block.centrality})
+      column->push_back(0.5 * ievent);
+    for (Int_t iparticle = 0; iparticle <= ievent; iparticle++) {
+      block.pdg.push_back(211);
+      block.status.push_back(1);
+      block.mother.push_back(iparticle - 1);
+      for (auto column : {&block.px, &block.py, &block.pz, &block.e, &block.vx, &block.vy, &block.vz, &block.vt})
+	column->push_back(0.25 * iparticle);
+    }
+  }
+}
+
+/*****************************************************************/
+
+void
+patchCounts(std::string &data, UInt_t nevents, UInt_t nparticles)
+{
+  /** overwrite the counts at the beginning of the block **/
+
+  data.replace(0, sizeof(nevents), reinterpret_cast<const Char_t *>(&nevents), sizeof(nevents));
+  data.replace(sizeof(nevents), sizeof(nparticles), reinterpret_cast<const Char_t *>(&nparticles), sizeof(nparticles));
+}
+
+/*****************************************************************/
+
+int
+main (Int_t argc, char **argv)
+{
+
+  NativeBlock block;
+  fill(block, 4);
+  std::stringstream stream;
+  check(block.Write(stream) && block.Write(stream), "write");
+  auto data = stream.str();
+
+  /** round trip, two blocks then the end of the input **/
+  {
+    std::istringstream input(data);
+    NativeBlock read;
+    for (Int_t iblock = 0; iblock < 2; iblock++) {
+      check(read.Read(input), "read block " + std::to_string(iblock));
+      check(read.GetNumberOfEvents() == 4 && read.GetNumberOfParticles() == 10, "counts");
+      check(read.number == block.number && read.nParticles == block.nParticles && read.flags == block.flags, "event columns");
+      check(read.centrality == block.centrality && read.attemptedEvents == block.attemptedEvents, "event info columns");
+      check(read.pdg == block.pdg && read.mother == block.mother && read.px == block.px && read.vt == block.vt, "particle columns");
+    }
+    check(!read.Read(input), "end of input");
+  }
+
+  /** empty block **/
+  {
+    NativeBlock empty, read;
+    std::stringstream input;
+    check(empty.Write(input) && read.Read(input), "empty block");
+    check(read.GetNumberOfEvents() == 0 && read.GetNumberOfParticles() == 0, "empty counts");
+  }
+
+  /** corrupt counts **/
+  auto single = data.substr(0, data.size() / 2);
+  for (auto counts : {std::make_pair(~0u, 10u), std::make_pair(4u, ~0u), std::make_pair(1u << 25, 10u), std::make_pair(4u, 9u), std::make_pair(4u, 11u)}) {
+    auto corrupt = single;
+    patchCounts(corrupt, counts.first, counts.second);
+    std::istringstream input(corrupt);
+    NativeBlock read;
+    check(!read.Read(input), "reject counts " + std::to_string(counts.first) + ", " + std::to_string(counts.second));
+  }
+
+  /** negative particle count of an event **/
+  {
+    NativeBlock negative;
+    fill(negative, 2);
+    negative.nParticles = {-1, 4};
+    std::stringstream input;
+    NativeBlock read;
+    check(negative.Write(input) && !read.Read(input), "reject negative particle count");
+  }
+
+  /** truncated block **/
+  for (auto size : {(size_t)2, (size_t)6, single.size() / 2, single.size() - 1}) {
+    std::istringstream input(single.substr(0, size));
+    NativeBlock read;
+    check(!read.Read(input), "reject block truncated to " + std::to_string(size) + " bytes");
+  }
+
+  /** summary **/
+  if (gFailures > 0) {
+    std::cout << "testNativeBlock: " << gFailures << " failures" << std::endl;
+    return 1;
+  }
+  std::cout << "testNativeBlock: success" << std::endl;
+  return 0;
+}
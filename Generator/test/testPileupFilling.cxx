@@ -0,0 +1,87 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See https://alice-o2.web.cern.ch/ for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \author R+Preghenella - September 2017
+
+#include <iostream>
+#include <string>
+#include "Generator/PrimaryGenerator.h"
+
+/** pileup filling scheme test, the filled bunches of valid
+    schemes and the rejection of malformed or empty ones **/
+
+using o2::eventgen::PrimaryGenerator;
+
+Int_t gFailures = 0;
+
+/*****************************************************************/
+
+void
+check(Bool_t condition, const std::string &what)
+{
+  /** check **/
+
+  if (condition) return;
+  std::cout << "FAILED: " << what << std::endl;
+  gFailures++;
+}
+
+/*****************************************************************/
+
+Int_t
+filled(const std::string &filling, Int_t nbunches)
+{
+  /** number of filled bunches, -1 if the scheme is rejected **/
+
+  PrimaryGenerator primGen;
+  if (!primGen.SetPileup(1., nbunches, 25.e-9, filling.c_str())) return -1;
+  return primGen.GetPileupMean();
+}
+
+/*****************************************************************/
+
+int
+main (Int_t argc, char **argv)
+{
+
+  /** valid schemes, repeated over the timeframe **/
+  check(filled("", 10) == 10, "no scheme fills all bunches");
+  check(filled("  ", 10) == 10, "blank scheme fills all bunches");
+  check(filled("2b3e", 10) == 4, "\"2b3e\" over 10 bunches");
+  check(filled("2b 3e", 10) == 4, "whitespace is ignored");
+  check(filled("1b", 10) == 10, "\"1b\" fills all bunches");
+  /** 19 full trains of 182 bunches and 72 + 26 filled in the last 106 **/
+  check(filled("72b8e72b30e", 3564) == 19 * 144 + 98, "\"72b8e72b30e\" over 3564 bunches");
+  check(filled("0b2b", 10) == 10, "zero counts are allowed next to filled bunches");
+
+  /** schemes without filled bunches **/
+  check(filled("0b", 10) == -1, "reject \"0b\"");
+  check(filled("5e", 10) == -1, "reject \"5e\"");
+  check(filled("0b5e", 10) == -1, "reject \"0b5e\"");
+  check(filled("20e1b", 10) == -1, "reject a scheme filling only after the timeframe");
+
+  /** malformed schemes **/
+  for (auto const &filling : {"b", "2", "2b3", "2x", "b2", "-2b", "2b,3e"})
+    check(filled(filling, 10) == -1, std::string("reject \"") + filling + "\"");
+
+  /** invalid settings **/
+  PrimaryGenerator primGen;
+  check(!primGen.SetPileup(0., 10, 25.e-9), "reject mu = 0");
+  check(!primGen.SetPileup(1., 0, 25.e-9), "reject no bunches");
+  check(!primGen.SetPileup(1., 10, 0.), "reject spacing = 0");
+
+  /** summary **/
+  if (gFailures > 0) {
+    std::cout << "testPileupFilling: " << gFailures << " failures" << std::endl;
+    return 1;
+  }
+  std::cout << "testPileupFilling: success" << std::endl;
+  return 0;
+}
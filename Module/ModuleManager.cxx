@@ -12,8 +12,7 @@
 
 #include "ModuleManager.h"
 #include "Core/ModuleManagerDelegate.h"
-#include "ModuleManagerCave.h"
-#include "ModuleManagerTPC.h"
+#include "Core/Profiler.h"
 #include "FairRunSim.h"
 
 namespace o2sim
@@ -50,6 +49,7 @@ namespace o2sim
       auto delegate = dynamic_cast<ModuleManagerDelegate *>(x.second);
       if (!delegate || !delegate->IsActive()) continue;
       LOG(INFO) << "Initialising \"" << x.first << "\" manager (" << GetDelegateClassName(x.first) << ")" << std::endl;
+      Profiler::Timer timer(Profiler::Instance().GetEntry(std::string("init.module.") + x.first.Data()));
       auto module = delegate->Init();
       if (!module) {
 	LOG(ERROR) << "Failed initialising \"" << x.first << "\" manager" << std::endl;
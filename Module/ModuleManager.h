@@ -31,6 +31,7 @@ namespace o2sim {
     /** methods **/
     Bool_t Init() const override;
     Bool_t Terminate() const override;
+    Bool_t IsTransportOnly() const override {return kTRUE;};
     
   private:
 
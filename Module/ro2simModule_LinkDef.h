@@ -18,6 +18,5 @@
 
 #pragma link C++ class o2sim::ModuleManager+;
 #pragma link C++ class o2sim::ModuleManagerCave+;
-#pragma link C++ class o2sim::ModuleManagerTPC+;
 
 #endif
@@ -11,11 +11,20 @@
 /// \author R+Preghenella - August 2017
 
 #include "RunManager.h"
+#include "Core/Profiler.h"
 #include "FairRunSim.h"
 #include "Simulation/SimulationManager.h"
-#include "Module/ModuleManager.h"
-#include "Generator/GeneratorManager.h"
+#include "TRandom.h"
+#include "TSystem.h"
+#include "TFile.h"
+#include "TParameter.h"
+#include "TRandom3.h"
 #include <fstream>
+#include <algorithm>
+#include <cstdio>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
 
 namespace o2sim
 {
@@ -24,7 +33,14 @@ namespace o2sim
   /*****************************************************************/
   
   RunManager::RunManager() :
-    ConfigurationManager()
+    ConfigurationManager(),
+    fWorkerId(-1),
+    fWorkerPid(),
+    fConfigCache(),
+    fResume(kFALSE),
+    fResumeEvents(0),
+    fResumeOutput(),
+    fResumeSegments()
   {
     /** deafult constructor **/
 
@@ -33,7 +49,7 @@ namespace o2sim
   /*****************************************************************/
 
   Bool_t
-  RunManager::Init() const
+  RunManager::Init()
   {
     /** init **/
 
@@ -49,6 +65,25 @@ namespace o2sim
     /** print status **/
     PrintStatus();
 
+    /** fork workers if requested, the master does not initialise **/
+    if (!ForkWorkers()) return kFALSE;
+    if (IsMaster()) return kTRUE;
+
+    /** resume from the checkpoint, before the values are frozen **/
+    if (fResume && !ReadCheckpoint()) return kFALSE;
+
+    /** batching, the events of a batch are stacked by the generator **/
+    if (!SetupBatch()) return kFALSE;
+
+    /** checkpointing, refused at init by delegates that cannot save **/
+    if (!SetupCheckpoint()) return kFALSE;
+
+    /** freeze the configuration, values are parsed once here **/
+    if (!Compile()) {
+      LOG(ERROR) << "Failed compiling configuration" << std::endl;
+      return kFALSE;
+    }
+
     /**
      ** WARNING: must ensure that simulation manager
      ** the first to be called or enforce order of initialisation
@@ -56,20 +91,31 @@ namespace o2sim
 
     std::cout << std::string(80, '-') << std::endl;
     LOG(INFO) << "Initialising \"" << "simulation" << "\" manager" << std::endl;
+    auto start = Profiler::Now();
     auto delegate = dynamic_cast<RunManagerDelegate *>(GetDelegate("simulation"));
     if (!delegate || !delegate->IsActive() || !delegate->Init()) {
       LOG(ERROR) << "Failed initialising \"" << "simulation" << "\" manager" << std::endl;
       return kFALSE;
     }
+    /** profiling is enabled by the simulation manager itself **/
+    auto entry = Profiler::Instance().GetEntry("init.simulation");
+    if (entry) entry->Add(1, Profiler::Now() - start);
     std::cout << std::string(80, '-') << std::endl;
     
     /** loop over all delegates **/
+    auto simulation = dynamic_cast<SimulationManager *>(delegate);
+    Bool_t generatorOnly = simulation && simulation->IsGeneratorOnly();
     for (auto const &x : DelegateMap()) {
       if (x.first.EqualTo("simulation")) continue; //R+hack
       auto delegate = dynamic_cast<RunManagerDelegate *>(x.second);
       if (!delegate || !delegate->IsActive()) continue;
+      if (generatorOnly && delegate->IsTransportOnly()) {
+	LOG(INFO) << "Skipping \"" << x.first << "\" manager in generator-only mode" << std::endl;
+	continue;
+      }
       std::cout << std::string(80, '-') << std::endl;
       LOG(INFO) << "Initialising \"" << x.first << "\" manager (" << GetDelegateClassName(x.first) << ")" << std::endl;
+      Profiler::Timer timer(Profiler::Instance().GetEntry(std::string("init.") + x.first.Data()));
       if (!delegate->Init()) {
 	LOG(ERROR) << "Failed initialising \"" << x.first << "\" manager" << std::endl;
 	return kFALSE;
@@ -77,7 +123,9 @@ namespace o2sim
       std::cout << std::string(80, '-') << std::endl;
     }
 
-    /** init FairRunSim **/
+    /** init FairRunSim, not needed without transport **/
+    if (generatorOnly) return simulation->InitGeneratorOnly();
+    Profiler::Timer timer(Profiler::Instance().GetEntry("init.runsim"));
     runsim->Init();
     
     /** success **/
@@ -98,32 +146,449 @@ namespace o2sim
       return kFALSE;
     }
 
+    /** the master waits for the workers and merges their output **/
     auto simulation = dynamic_cast<SimulationManager *>(GetDelegate("simulation"));
-    return simulation->Run();
+    if (IsMaster()) {
+      if (!WaitWorkers()) return kFALSE;
+      return simulation->MergeWorkers(fWorkerPid.size());
+    }
+
+    /** restore the state at the checkpoint **/
+    if (fResume && !LoadCheckpoint()) return kFALSE;
+    
+    /** run, writing the checkpoints if requested **/
+    if (!simulation->Run([this](Long64_t events) {return WriteCheckpoint(events);})) return kFALSE;
+
+    /** merge the output segments of a resumed run **/
+    if (!fResumeSegments.empty()) {
+      auto segments = fResumeSegments;
+      segments.push_back(simulation->GetOutputFileName());
+      if (!simulation->MergeSegments(segments, fResumeOutput)) return kFALSE;
+    }
+
+    /** the run is complete, the checkpoint is not needed anymore **/
+    Int_t every;
+    if (fResume || (simulation->GetCheckpoint(every) && every > 0))
+      gSystem->Unlink(simulation->GetCheckpointFileName());
+
+    /** success **/
+    return kTRUE;
   }
     
   /*****************************************************************/
 
+  Bool_t
+  RunManager::UsesThreads() const
+  {
+    /** uses threads, if any active delegate does **/
+
+    for (auto const &x : DelegateMap()) {
+      auto delegate = dynamic_cast<RunManagerDelegate *>(x.second);
+      if (delegate && delegate->IsActive() && delegate->UsesThreads()) return kTRUE;
+    }
+    return kFALSE;
+  }
+
+  /*****************************************************************/
+
   Bool_t
   RunManager::Terminate() const
   {
     /** terminate **/
 
+    /** nothing was initialised by the master **/
+    if (IsMaster()) return kTRUE;
+    
     /** loop over all delegates **/
+    auto simulation = dynamic_cast<SimulationManager *>(GetDelegate("simulation"));
+    Bool_t generatorOnly = simulation && simulation->IsGeneratorOnly();
     for (auto const &x : DelegateMap()) {
       auto delegate = dynamic_cast<RunManagerDelegate *>(x.second);
       if (!delegate || !delegate->IsActive()) continue;
+      if (generatorOnly && delegate->IsTransportOnly()) continue;
       LOG(INFO) << "Terminating \"" << x.first << "\" manager" << std::endl;
       if (!delegate->Terminate()) {
 	LOG(ERROR) << "Failed terminating \"" << x.first << "\" manager" << std::endl;
 	return kFALSE;
       }
     }
+
+    /** profiling summary **/
+    if (Profiler::IsEnabled()) {
+      Profiler::Instance().Print();
+      if (!Profiler::Instance().Dump()) return kFALSE;
+    }
+    
+    /** success **/
+    return kTRUE;
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  RunManager::ForkWorkers()
+  {
+    /** fork workers **/
+
+    /** check number of workers **/
+    auto simulation = dynamic_cast<SimulationManager *>(GetDelegate("simulation"));
+    if (!simulation) {
+      LOG(ERROR) << "Cannot find \"" << "simulation" << "\" manager" << std::endl;
+      return kFALSE;
+    }
+    Int_t nworkers, nevents;
+    UInt_t seed;
+    if (!simulation->GetNumberOfWorkers(nworkers)) return kFALSE;
+    if (!simulation->GetNumberOfEvents(nevents)) return kFALSE;
+    if (!simulation->GetSeed(seed)) return kFALSE;
+    if (nworkers > nevents) nworkers = nevents;
+    if (nworkers <= 1) return kTRUE;
+
+    /** workers need distinct seeds, draw a base seed if not given **/
+    if (seed == 0) {
+      gRandom->SetSeed(0);
+      seed = 1 + gRandom->Integer(800000000);
+    }
+    
+    /** flush output not to duplicate it in the workers **/
+    std::cout.flush();
+    fflush(stdout);
+    fflush(stderr);
+    
+    /** fork **/
+    Int_t first = 0;
+    for (Int_t iworker = 0; iworker < nworkers; iworker++) {
+      Int_t nworkerevents = nevents / nworkers + (iworker < nevents % nworkers ? 1 : 0);
+      Int_t pid = fork();
+      if (pid < 0) {
+	LOG(ERROR) << "Failed to fork worker " << iworker << std::endl;
+	return kFALSE;
+      }
+      /** worker **/
+      if (pid == 0) {
+	fWorkerId = iworker;
+	fWorkerPid.clear();
+	return SetupWorker(iworker, nworkers, nworkerevents, seed + iworker);
+      }
+      /** master **/
+      fWorkerPid.push_back(pid);
+      LOG(INFO) << "Worker " << iworker << " started: " << pid
+		<< " | events: " << first << " -> " << first + nworkerevents - 1
+		<< " | seed: " << seed + iworker << std::endl;
+      first += nworkerevents;
+    }
+    
+    /** success **/
+    return kTRUE;
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  RunManager::SetupWorker(Int_t worker, Int_t nworkers, Int_t nevents, UInt_t seed)
+  {
+    /** setup worker **/
+
+    /** relative paths would resolve in the worker directory **/
+    if (!MakePathsAbsolute(gSystem->WorkingDirectory())) {
+      LOG(ERROR) << "Failed making paths absolute for worker " << worker << std::endl;
+      return kFALSE;
+    }
+
+    /** simulation values **/
+    auto simulation = dynamic_cast<SimulationManager *>(GetDelegate("simulation"));
+    if (!simulation->SetupWorker(worker, nevents, seed)) {
+      LOG(ERROR) << "Failed setting up worker " << worker << std::endl;
+      return kFALSE;
+    }
+    
+    /** generator seeds **/
+    if (!SetupSeed(seed)) {
+      LOG(ERROR) << "Failed setting seeds for worker " << worker << std::endl;
+      return kFALSE;
+    }
+
+    /** delegates reading an input take their own slice of it **/
+    for (auto const &x : DelegateMap()) {
+      auto delegate = dynamic_cast<RunManagerDelegate *>(x.second);
+      if (delegate) delegate->SetWorker(worker, nworkers);
+    }
+    
+    /** success **/
+    return kTRUE;
+  }
+  
+  /*****************************************************************/
+
+  Bool_t
+  RunManager::SetupSeed(UInt_t seed)
+  {
+    /** setup seed of the simulation and of the generators **/
+
+    if (!ConfigurationManager::ProcessCommand(Form("simulation.seed %u", seed), kValues)) return kFALSE;
+    if (DelegateMap().count("generator") &&
+	!ConfigurationManager::ProcessCommand(Form("generator.*.seed %u", seed), kValues)) return kFALSE;
+
+    /** success **/
+    return kTRUE;
+  }
+  
+  /*****************************************************************/
+
+  Bool_t
+  RunManager::SetupBatch()
+  {
+    /** setup batch, the delegates producing events stack them **/
+
+    auto simulation = dynamic_cast<SimulationManager *>(GetDelegate("simulation"));
+    Int_t batch;
+    if (!simulation->GetBatchSize(batch)) return kFALSE;
+    for (auto const &x : DelegateMap()) {
+      auto delegate = dynamic_cast<RunManagerDelegate *>(x.second);
+      if (delegate) delegate->SetBatchSize(batch);
+    }
     
     /** success **/
     return kTRUE;
   }
+  
+  /*****************************************************************/
+
+  Bool_t
+  RunManager::SetupCheckpoint()
+  {
+    /** setup checkpoint **/
+
+    auto simulation = dynamic_cast<SimulationManager *>(GetDelegate("simulation"));
+    Int_t every;
+    if (!simulation->GetCheckpoint(every)) return kFALSE;
+    for (auto const &x : DelegateMap()) {
+      auto delegate = dynamic_cast<RunManagerDelegate *>(x.second);
+      if (delegate) delegate->SetCheckpointing(every > 0);
+    }
+    
+    /** success **/
+    return kTRUE;
+  }
+  
+  /*****************************************************************/
+
+  Bool_t
+  RunManager::WaitWorkers() const
+  {
+    /** wait workers **/
+
+    Bool_t retval = kTRUE;
+    for (Int_t iworker = 0; iworker < (Int_t)fWorkerPid.size(); iworker++) {
+      Int_t status;
+      if (waitpid(fWorkerPid[iworker], &status, 0) < 0) {
+	LOG(ERROR) << "Failed waiting for worker " << iworker << std::endl;
+	retval = kFALSE;
+	continue;
+      }
+      if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+	LOG(ERROR) << "Worker " << iworker << " failed: " << fWorkerPid[iworker] << std::endl;
+	retval = kFALSE;
+	continue;
+      }
+      LOG(INFO) << "Worker " << iworker << " done: " << fWorkerPid[iworker] << std::endl;
+    }
+    return retval;
+  }
+  
+  /*****************************************************************/
+
+  Bool_t
+  RunManager::ReadCheckpoint()
+  {
+    /** read checkpoint, the remaining events are
+	written to a new output segment **/
+
+    auto simulation = dynamic_cast<SimulationManager *>(GetDelegate("simulation"));
+    TString filename = simulation->GetCheckpointFileName();
+    if (gSystem->AccessPathName(filename)) {
+      LOG(WARNING) << "No checkpoint to resume from, starting from the first event: " << filename << std::endl;
+      fResume = kFALSE;
+      return kTRUE;
+    }
+
+    /** events and output segments at the checkpoint **/
+    TDirectory::TContext context;
+    auto fin = TFile::Open(filename);
+    if (!fin || !fin->IsOpen()) {
+      LOG(ERROR) << "Cannot open checkpoint file: " << filename << std::endl;
+      return kFALSE;
+    }
+    auto events = dynamic_cast<TParameter<Long64_t> *>(fin->Get("events"));
+    auto segments = dynamic_cast<TParameter<Int_t> *>(fin->Get("segments"));
+    if (!events || !segments) {
+      LOG(ERROR) << "Invalid checkpoint file: " << filename << std::endl;
+      return kFALSE;
+    }
+    fResumeEvents = events->GetVal();
+    Int_t nsegments = segments->GetVal();
+    delete events;
+    delete segments;
+
+    /** a worker continues with the seed it started with,
+	the worker seeds are drawn again when none is given **/
+    auto seed = dynamic_cast<TParameter<Long64_t> *>(fin->Get("seed"));
+    if (IsWorker() && seed) {
+      LOG(INFO) << "Resuming worker " << fWorkerId << " with seed " << seed->GetVal() << std::endl;
+      if (!SetupSeed(seed->GetVal())) {
+	LOG(ERROR) << "Failed setting seeds for worker " << fWorkerId << std::endl;
+	return kFALSE;
+      }
+    }
+    delete seed;
+    fin->Close();
+    delete fin;
+    Int_t nevents;
+    if (!simulation->GetNumberOfEvents(nevents)) return kFALSE;
+    if (fResumeEvents > nevents) {
+      LOG(ERROR) << "Checkpoint beyond the number of events: " << fResumeEvents << " > " << nevents << std::endl;
+      return kFALSE;
+    }
+
+    /** the output of the first attempt becomes the first segment **/
+    fResumeOutput = simulation->GetOutputFileName();
+    TString first = SimulationManager::GetSegmentFileName(fResumeOutput, 0);
+    if (gSystem->AccessPathName(first) && !gSystem->AccessPathName(fResumeOutput) &&
+	gSystem->Rename(fResumeOutput, first) != 0) {
+      LOG(ERROR) << "Cannot rename output file: " << fResumeOutput << " -> " << first << std::endl;
+      return kFALSE;
+    }
+    fResumeSegments.clear();
+    for (Int_t isegment = 0; isegment < nsegments; isegment++) {
+      TString segment = SimulationManager::GetSegmentFileName(fResumeOutput, isegment);
+      if (gSystem->AccessPathName(segment)) {
+	LOG(ERROR) << "Cannot find output segment: " << segment << std::endl;
+	return kFALSE;
+      }
+      fResumeSegments.push_back(segment);
+    }
+    
+    LOG(INFO) << "Resuming from checkpoint " << filename << ": " << fResumeEvents << " of " << nevents << " events done" << std::endl;
+    return simulation->SetupResume(SimulationManager::GetSegmentFileName(fResumeOutput, nsegments), nevents - fResumeEvents);
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  RunManager::LoadCheckpoint() const
+  {
+    /** load checkpoint **/
+
+    auto simulation = dynamic_cast<SimulationManager *>(GetDelegate("simulation"));
+    TString filename = simulation->GetCheckpointFileName();
+    TDirectory::TContext context;
+    auto fin = TFile::Open(filename);
+    if (!fin || !fin->IsOpen()) {
+      LOG(ERROR) << "Cannot open checkpoint file: " << filename << std::endl;
+      return kFALSE;
+    }
+
+    /** loop over all delegates **/
+    Bool_t generatorOnly = simulation->IsGeneratorOnly();
+    Bool_t retval = kTRUE;
+    for (auto const &x : DelegateMap()) {
+      auto delegate = dynamic_cast<RunManagerDelegate *>(x.second);
+      if (!delegate || !delegate->IsActive()) continue;
+      if (generatorOnly && delegate->IsTransportOnly()) continue;
+      auto dir = fin->GetDirectory(x.first);
+      if (!dir || !delegate->LoadState(dir)) {
+	LOG(ERROR) << "Failed loading state of \"" << x.first << "\" manager" << std::endl;
+	retval = kFALSE;
+	break;
+      }
+    }
+
+    /** random generator, last as loading may have used it **/
+    auto random = dynamic_cast<TRandom *>(fin->Get("random"));
+    if (retval && !random) {
+      LOG(ERROR) << "Cannot find random generator state in checkpoint" << std::endl;
+      retval = kFALSE;
+    }
+    if (retval) {
+      auto random3 = dynamic_cast<TRandom3 *>(random);
+      auto gRandom3 = dynamic_cast<TRandom3 *>(gRandom);
+      if (random3 && gRandom3) {
+	*gRandom3 = *random3;
+	delete random;
+      }
+      else {
+	delete gRandom;
+	gRandom = random;
+      }
+    }
+    fin->Close();
+    delete fin;
+    return retval;
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  RunManager::WriteCheckpoint(Long64_t events) const
+  {
+    /** write checkpoint, to a temporary file that
+	replaces the previous one once complete **/
+
+    auto simulation = dynamic_cast<SimulationManager *>(GetDelegate("simulation"));
+    TString filename = simulation->GetCheckpointFileName();
+    TString tmpname = filename + ".tmp";
+
+    /** seed, drawn for the workers if not given **/
+    UInt_t value;
+    if (!simulation->GetSeed(value)) return kFALSE;
+    TParameter<Long64_t> seed("seed", value);
+    TDirectory::TContext context;
+    auto fout = TFile::Open(tmpname, "RECREATE");
+    if (!fout || !fout->IsOpen()) {
+      LOG(ERROR) << "Cannot open checkpoint file: " << tmpname << std::endl;
+      return kFALSE;
+    }
+    
+    /** events and output segments, this attempt included **/
+    TParameter<Long64_t> nevents("events", fResumeEvents + events);
+    TParameter<Int_t> nsegments("segments", fResumeSegments.size() + 1);
+    fout->WriteTObject(&nevents);
+    fout->WriteTObject(&nsegments);
+    fout->WriteTObject(gRandom, "random");
+
+    fout->WriteTObject(&seed);
+    
+    /** loop over all delegates **/
+    Bool_t generatorOnly = simulation->IsGeneratorOnly();
+    Bool_t retval = kTRUE;
+    for (auto const &x : DelegateMap()) {
+      auto delegate = dynamic_cast<RunManagerDelegate *>(x.second);
+      if (!delegate || !delegate->IsActive()) continue;
+      if (generatorOnly && delegate->IsTransportOnly()) continue;
+      if (!delegate->SaveState(fout->mkdir(x.first))) {
+	LOG(ERROR) << "Failed saving state of \"" << x.first << "\" manager" << std::endl;
+	retval = kFALSE;
+	break;
+      }
+    }
+    fout->Close();
+    delete fout;
+    if (!retval) {
+      gSystem->Unlink(tmpname);
+      return kFALSE;
+    }
 
+    /** replace the previous checkpoint **/
+    if (gSystem->Rename(tmpname, filename) != 0) {
+      LOG(ERROR) << "Cannot rename checkpoint file: " << tmpname << " -> " << filename << std::endl;
+      return kFALSE;
+    }
+    LOG(INFO) << "Checkpoint written to " << filename << ": " << fResumeEvents + events << " events done" << std::endl;
+
+    /** success **/
+    return kTRUE;
+  }
+  
   /*****************************************************************/
   /*****************************************************************/
   
@@ -162,6 +627,43 @@ namespace o2sim
   {
     /** process buffer **/
 
+    /** configuration parsing, delegate libraries included **/
+    Profiler::Timer timer(Profiler::Instance().GetEntry("startup.config"));
+    
+    /** no configuration cache **/
+    if (fConfigCache.IsNull()) return ProcessCommands(buffer);
+    TString filename = GetConfigCacheFileName(buffer);
+    if (filename.IsNull()) {
+      LOG(WARNING) << "Cannot expand configuration cache directory: " << fConfigCache << std::endl;
+      return ProcessCommands(buffer);
+    }
+    
+    /** set the snapshot of an up to date cache, no command is processed **/
+    snapshot_t delegates, values;
+    if (ReadConfigCache(filename, delegates, values)) {
+      LOG(INFO) << "Using configuration cache: " << filename << std::endl;
+      return SetSnapshot(delegates, values);
+    }
+
+    /** process, recording the included files, and cache the snapshot **/
+    std::vector<std::string> files;
+    StartRecording(&files);
+    Bool_t retval = ProcessCommands(buffer);
+    StopRecording();
+    if (retval) {
+      GetSnapshot(delegates, values);
+      WriteConfigCache(filename, delegates, values, files);
+    }
+    return retval;
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  RunManager::ProcessCommands(const std::vector<std::string> &buffer)
+  {
+    /** process commands **/
+
     Bool_t retval = kTRUE;
     /** process delegates **/
     for (auto const &command : buffer) {
@@ -177,6 +679,153 @@ namespace o2sim
 
   /*****************************************************************/
 
+  TString
+  RunManager::GetConfigCacheFileName(const std::vector<std::string> &buffer) const
+  {
+    /** get configuration cache file name, keyed by
+	a FNV-1a hash of the command buffer **/
+
+    ULong64_t hash = 14695981039346656037ULL;
+    for (auto const &command : buffer) {
+      for (auto c : command + "\n") {
+	hash ^= (UChar_t)c;
+	hash *= 1099511628211ULL;
+      }
+    }
+    TString dirname;
+    if (!ExpandVariables(fConfigCache, dirname)) return "";
+    return dirname + Form("/o2sim.%016llx.cfgcache", hash);
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  RunManager::ReadConfigCache(TString filename, snapshot_t &delegates, snapshot_t &values) const
+  {
+    /** read configuration cache, valid only if none of
+	the included files changed since it was written **/
+
+    std::ifstream fin(filename.Data(), std::ios::binary | std::ios::ate);
+    if (!fin.is_open()) return kFALSE;
+    Long64_t length = fin.tellg();
+    fin.seekg(0);
+    /** string sizes beyond the end of the file mean a corrupted cache **/
+    auto readString = [&fin, length](std::string &str) {
+      UInt_t size = 0;
+      if (!fin.read((char *)&size, sizeof(size))) return kFALSE;
+      if ((Long64_t)size > length - (Long64_t)fin.tellg()) return kFALSE;
+      str.resize(size);
+      return (Bool_t)fin.read(&str[0], size);
+    };
+    /** each pair holds at least its two string sizes **/
+    auto readSnapshot = [&fin, length, &readString](snapshot_t &snapshot) {
+      UInt_t n = 0;
+      if (!fin.read((char *)&n, sizeof(n))) return kFALSE;
+      if ((Long64_t)n * 2 * (Long64_t)sizeof(UInt_t) > length - (Long64_t)fin.tellg()) return kFALSE;
+      snapshot.resize(n);
+      for (auto &x : snapshot)
+	if (!readString(x.first) || !readString(x.second)) return kFALSE;
+      return kTRUE;
+    };
+    
+    /** header **/
+    UInt_t magic, version, nfiles;
+    if (!fin.read((char *)&magic, sizeof(magic)) || magic != fgConfigCacheMagic) return kFALSE;
+    if (!fin.read((char *)&version, sizeof(version)) || version != fgConfigCacheVersion) return kFALSE;
+
+    /** included files **/
+    if (!fin.read((char *)&nfiles, sizeof(nfiles))) return kFALSE;
+    for (UInt_t ifile = 0; ifile < nfiles; ifile++) {
+      std::string raw, expanded;
+      Long64_t size, mtime;
+      if (!readString(raw) || !readString(expanded) ||
+	  !fin.read((char *)&size, sizeof(size)) || !fin.read((char *)&mtime, sizeof(mtime))) return kFALSE;
+      TString path;
+      FileStat_t stat;
+      if (!ExpandVariables(raw, path) || expanded != path.Data() ||
+	  gSystem->GetPathInfo(path, stat) != 0 || stat.fSize != size || stat.fMtime != mtime) {
+	LOG(INFO) << "Configuration cache is outdated: " << filename << std::endl;
+	return kFALSE;
+      }
+    }
+
+    /** snapshot **/
+    return readSnapshot(delegates) && readSnapshot(values);
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  RunManager::WriteConfigCache(TString filename, const snapshot_t &delegates, const snapshot_t &values, const std::vector<std::string> &files) const
+  {
+    /** write configuration cache, written to a temporary file
+	and renamed so that concurrent jobs never see a partial one **/
+
+    gSystem->mkdir(gSystem->DirName(filename), kTRUE);
+    TString tmpname = filename + Form(".%d", gSystem->GetPid());
+    std::ofstream fout(tmpname.Data(), std::ios::binary);
+    if (!fout.is_open()) {
+      LOG(WARNING) << "Cannot write configuration cache: " << filename << std::endl;
+      return kFALSE;
+    }
+    auto writeString = [&fout](const std::string &str) {
+      UInt_t size = str.size();
+      fout.write((const char *)&size, sizeof(size));
+      fout.write(str.data(), size);
+    };
+    auto writeSnapshot = [&fout, &writeString](const snapshot_t &snapshot) {
+      UInt_t n = snapshot.size();
+      fout.write((const char *)&n, sizeof(n));
+      for (auto const &x : snapshot) {
+	writeString(x.first);
+	writeString(x.second);
+      }
+    };
+    
+    /** header **/
+    UInt_t magic = fgConfigCacheMagic, version = fgConfigCacheVersion;
+    fout.write((const char *)&magic, sizeof(magic));
+    fout.write((const char *)&version, sizeof(version));
+    
+    /** included files, each one once **/
+    std::vector<std::string> unique;
+    for (auto const &file : files)
+      if (std::find(unique.begin(), unique.end(), file) == unique.end()) unique.push_back(file);
+    UInt_t nfiles = unique.size();
+    fout.write((const char *)&nfiles, sizeof(nfiles));
+    for (auto const &file : unique) {
+      TString path;
+      FileStat_t stat;
+      if (!ExpandVariables(file, path) || gSystem->GetPathInfo(path, stat) != 0) {
+	fout.close();
+	gSystem->Unlink(tmpname);
+	return kFALSE;
+      }
+      Long64_t size = stat.fSize, mtime = stat.fMtime;
+      writeString(file);
+      writeString(path.Data());
+      fout.write((const char *)&size, sizeof(size));
+      fout.write((const char *)&mtime, sizeof(mtime));
+    }
+
+    /** snapshot **/
+    writeSnapshot(delegates);
+    writeSnapshot(values);
+    fout.close();
+    
+    if (!fout || gSystem->Rename(tmpname, filename) != 0) {
+      LOG(WARNING) << "Cannot write configuration cache: " << filename << std::endl;
+      gSystem->Unlink(tmpname);
+      return kFALSE;
+    }
+    LOG(INFO) << "Written configuration cache: " << filename << std::endl;
+    
+    /** success **/
+    return kTRUE;
+  }
+
+  /*****************************************************************/
+
   void
   RunManager::PrintStatus() const
   {
@@ -14,6 +14,7 @@
 #define ALICEO2SIM_RUNMANAGER_H_
 
 #include "Core/ConfigurationManager.h"
+#include <vector>
 
 namespace o2sim {
 
@@ -32,14 +33,56 @@ namespace o2sim {
     virtual Bool_t ProcessCommand(TString command);
     Bool_t ProcessFile(TString filename);
     Bool_t ProcessBuffer(std::vector<std::string> buffer);
+    void SetConfigCache(TString val) {fConfigCache = val;};
+    void SetResume(Bool_t val) {fResume = val;};
     void PrintStatus() const;
+    Bool_t UsesThreads() const;
 
-    Bool_t Init() const;
+    Bool_t Init();
     Bool_t Run() const;
     Bool_t Terminate() const;
+
+    /** worker methods **/
+    Bool_t IsWorker() const {return fWorkerId >= 0;};
+    Bool_t IsMaster() const {return fWorkerId < 0 && !fWorkerPid.empty();};
     
   private:
 
+    Bool_t ForkWorkers();
+    Bool_t SetupWorker(Int_t worker, Int_t nworkers, Int_t nevents, UInt_t seed);
+    Bool_t WaitWorkers() const;
+    Bool_t SetupSeed(UInt_t seed);
+    Bool_t SetupBatch();
+    Bool_t SetupCheckpoint();
+
+    /** checkpoint methods **/
+    Bool_t ReadCheckpoint();
+    Bool_t LoadCheckpoint() const;
+    Bool_t WriteCheckpoint(Long64_t events) const;
+
+    /** configuration cache methods **/
+    Bool_t ProcessCommands(const std::vector<std::string> &buffer);
+    TString GetConfigCacheFileName(const std::vector<std::string> &buffer) const;
+    Bool_t ReadConfigCache(TString filename, snapshot_t &delegates, snapshot_t &values) const;
+    Bool_t WriteConfigCache(TString filename, const snapshot_t &delegates, const snapshot_t &values, const std::vector<std::string> &files) const;
+
+    /** worker members **/
+    Int_t fWorkerId;               //! worker id, -1 if not a worker
+    std::vector<Int_t> fWorkerPid; //! pid of the forked workers
+
+    /** configuration cache directory, no cache if empty **/
+    TString fConfigCache;          //!
+
+    /** checkpoint members, the output of each attempt
+	of a resumed run is written to its own segment **/
+    Bool_t fResume;                       //! resume from the checkpoint if any
+    Long64_t fResumeEvents;               //! events done by the previous attempts
+    TString fResumeOutput;                //! output file the segments are merged into
+    std::vector<TString> fResumeSegments; //! output segments of the previous attempts
+
+    static const UInt_t fgConfigCacheMagic = 0x6f326366; // "o2cf"
+    static const UInt_t fgConfigCacheVersion = 2;
+
     ClassDefOverride(RunManager, 1)
       
   }; /** class RunManager **/
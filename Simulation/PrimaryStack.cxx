@@ -0,0 +1,122 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See https://alice-o2.web.cern.ch/ for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \author R+Preghenella - September 2017
+
+
+#include "PrimaryStack.h"
+#include "TClonesArray.h"
+#include "TParticle.h"
+
+namespace o2sim
+{
+  
+  /*****************************************************************/
+  /*****************************************************************/
+
+  PrimaryStack::PrimaryStack() :
+    FairGenericStack(),
+    fParticles(new TClonesArray("TParticle", 1000)),
+    fNParticles(0),
+    fCurrentTrack(-1)
+  {
+    /** default constructor **/
+
+  }
+
+  /*****************************************************************/
+
+  PrimaryStack::~PrimaryStack()
+  {
+    /** destructor **/
+
+    delete fParticles;
+  }
+  
+  /*****************************************************************/
+
+  void
+  PrimaryStack::PushTrack(Int_t toBeDone, Int_t parent, Int_t pdg,
+			  Double_t px, Double_t py, Double_t pz, Double_t e,
+			  Double_t vx, Double_t vy, Double_t vz, Double_t tof,
+			  Double_t polx, Double_t poly, Double_t polz,
+			  TMCProcess mech, Int_t &ntr, Double_t weight, Int_t is)
+  {
+    /** push track, the objects of the array are reused **/
+
+    auto particle = new ((*fParticles)[fNParticles]) TParticle(pdg, is, parent, -1, -1, -1,
+							     px, py, pz, e, vx, vy, vz, tof);
+    particle->SetPolarisation(polx, poly, polz);
+    particle->SetWeight(weight);
+    particle->SetUniqueID(mech);
+    particle->SetBit(kTransportBit, toBeDone);
+    ntr = fNParticles++;
+  }
+
+  /*****************************************************************/
+
+  TParticle *
+  PrimaryStack::PopNextTrack(Int_t &itrack)
+  {
+    /** pop next track, nothing is transported **/
+
+    itrack = -1;
+    return nullptr;
+  }
+
+  /*****************************************************************/
+
+  TParticle *
+  PrimaryStack::PopPrimaryForTracking(Int_t i)
+  {
+    /** pop primary for tracking **/
+
+    if (i < 0 || i >= fNParticles) return nullptr;
+    return (TParticle *)fParticles->At(i);
+  }
+
+  /*****************************************************************/
+
+  TParticle *
+  PrimaryStack::GetCurrentTrack() const
+  {
+    /** get current track **/
+
+    if (fCurrentTrack < 0 || fCurrentTrack >= fNParticles) return nullptr;
+    return (TParticle *)fParticles->At(fCurrentTrack);
+  }
+
+  /*****************************************************************/
+
+  Int_t
+  PrimaryStack::GetCurrentParentTrackNumber() const
+  {
+    /** get current parent track number **/
+
+    auto particle = GetCurrentTrack();
+    return particle ? particle->GetFirstMother() : -1;
+  }
+
+  /*****************************************************************/
+
+  void
+  PrimaryStack::Reset()
+  {
+    /** reset, keep the memory of the particles **/
+
+    fParticles->Clear("C");
+    fNParticles = 0;
+    fCurrentTrack = -1;
+  }
+
+  /*****************************************************************/
+  /*****************************************************************/
+
+} /** namespace o2sim **/
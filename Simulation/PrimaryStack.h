@@ -0,0 +1,88 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See https://alice-o2.web.cern.ch/ for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \author R+Preghenella - September 2017
+
+
+#ifndef ALICEO2SIM_PRIMARYSTACK_H_
+#define ALICEO2SIM_PRIMARYSTACK_H_
+
+#include "FairGenericStack.h"
+
+class TClonesArray;
+class TParticle;
+
+namespace o2sim {
+  
+  /*****************************************************************/
+  /*****************************************************************/
+
+  /** minimal stack that only collects the primaries pushed by
+      the primary generator, used by the generator-only mode where
+      no transport takes place **/
+  
+  class PrimaryStack : public FairGenericStack
+  {
+    
+  public:
+
+    /** particles to be transported are flagged with this bit **/
+    enum EBits_t {
+      kTransportBit = BIT(14)
+    };
+    
+    /** default constructor **/
+    PrimaryStack();
+    /** destructor **/
+    virtual ~PrimaryStack();
+
+    /** TVirtualMCStack interface **/
+    void PushTrack(Int_t toBeDone, Int_t parent, Int_t pdg,
+		   Double_t px, Double_t py, Double_t pz, Double_t e,
+		   Double_t vx, Double_t vy, Double_t vz, Double_t tof,
+		   Double_t polx, Double_t poly, Double_t polz,
+		   TMCProcess mech, Int_t &ntr, Double_t weight, Int_t is) override;
+    TParticle *PopNextTrack(Int_t &itrack) override;
+    TParticle *PopPrimaryForTracking(Int_t i) override;
+    void SetCurrentTrack(Int_t itrack) override {fCurrentTrack = itrack;};
+    Int_t GetNtrack() const override {return fNParticles;};
+    Int_t GetNprimary() const override {return fNParticles;};
+    TParticle *GetCurrentTrack() const override;
+    Int_t GetCurrentTrackNumber() const override {return fCurrentTrack;};
+    Int_t GetCurrentParentTrackNumber() const override;
+
+    /** FairGenericStack interface **/
+    void Reset() override;
+
+    /** getters **/
+    TClonesArray *GetParticles() const {return fParticles;};
+    
+  protected:
+
+    /** copy constructor **/
+    PrimaryStack(const PrimaryStack &);
+    /** operator= **/
+    PrimaryStack &operator=(const PrimaryStack &);
+
+    /** data members **/
+    TClonesArray *fParticles;
+    Int_t fNParticles;
+    Int_t fCurrentTrack;
+    
+    ClassDefOverride(PrimaryStack, 1)
+      
+  }; /** class PrimaryStack **/
+
+  /*****************************************************************/
+  /*****************************************************************/
+
+} /** namespace o2sim **/
+
+#endif /* ALICEO2SIM_PRIMARYSTACK_H_ */
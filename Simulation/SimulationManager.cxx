@@ -11,8 +11,22 @@
 /// \author R+Preghenella - August 2017
 
 #include "SimulationManager.h"
+#include "Core/Profiler.h"
+#include "Core/CheckpointHook.h"
 #include "FairRunSim.h"
 #include "TSystem.h"
+#include "TRandom.h"
+#include "TFileMerger.h"
+#include "TFile.h"
+#include "TTree.h"
+#include "PrimaryStack.h"
+#include "FairPrimaryGenerator.h"
+#include "FairMCEventHeader.h"
+#include "FairRootManager.h"
+#include <thread>
+#include <algorithm>
+#include <cstdlib>
+#include <cerrno>
 
 namespace o2sim
 {
@@ -29,12 +43,20 @@ namespace o2sim
     RegisterValue("vmc_path", "$VMCWORKDIR");
     RegisterValue("geometry_path", "Detectors/Geometry");
     RegisterValue("config_path", "Detectors/gconfig");
-    RegisterValue("output_filename", "ALICEo2sim.output.root");
+    RegisterPath("output_filename", "ALICEo2sim.output.root");
     RegisterValue("params_filename", "ALICEo2sim.params.root");
     RegisterValue("materials_filename", "media.geo");
     RegisterValue("mc_engine", "TGeant3");
     RegisterValue("nevents", "1");
     RegisterValue("run_id", "0");
+    RegisterValue("nworkers", "1");
+    RegisterValue("seed", "0");
+    RegisterValue("profiling", "off");
+    RegisterPath("profiling_filename", "o2sim.profile.json");
+    RegisterValue("mode", "transport");
+    RegisterValue("checkpoint", "0");
+    RegisterPath("checkpoint_filename", "o2sim.checkpoint.root");
+    RegisterValue("batch", "1");
     
   }
   
@@ -52,6 +74,15 @@ namespace o2sim
       return kFALSE;
     }
 
+    /** setup profiling **/
+    if (!SetupProfiling()) return kFALSE;
+
+    /** check mode **/
+    if (!IsValue("mode", "transport") && !IsValue("mode", "generator_only")) {
+      LOG(FATAL) << "Invalid mode: " << GetValue("mode") << std::endl;
+      return kFALSE;
+    }
+    
     /** setup environment **/
     if (!SetupEnvironment()) return kFALSE;
     
@@ -69,6 +100,14 @@ namespace o2sim
     }
     run_id = run_id_str.Atoi();
     runsim->SetRunId(run_id);
+
+    /** set random seed **/
+    UInt_t seed;
+    if (!GetSeed(seed)) return kFALSE;
+    if (seed != 0) {
+      gRandom->SetSeed(seed);
+      LOG(INFO) << "Random seed: " << seed << std::endl;
+    }
     
     /** success **/
     return kTRUE;
@@ -77,10 +116,11 @@ namespace o2sim
   /*****************************************************************/
   
   Bool_t
-  SimulationManager::Run() const
+  SimulationManager::InitGeneratorOnly() const
   {
-    /** run **/
-    
+    /** init generator only, the primary generator is 
+	initialised here instead of by FairRunSim **/
+
     /** FairRunSim instance **/
     auto runsim = FairRunSim::Instance();
     if (!runsim) {
@@ -88,22 +128,137 @@ namespace o2sim
       return kFALSE;
     }
 
-    /** get number of events **/
-    Int_t nevents = -1;
-    TString nevents_str = GetValue("nevents");
-    if (!nevents_str.IsDigit()) {
-      LOG(FATAL) << "Invalid number of events: " << nevents_str << std::endl;
+    /** primary generator and event header **/
+    auto primGen = runsim->GetPrimaryGenerator();
+    auto header = runsim->GetMCEventHeader();
+    if (!primGen || !header) {
+      LOG(ERROR) << "Generator-only mode requires a primary generator and an event header" << std::endl;
+      return kFALSE;
+    }
+    primGen->SetEvent(header);
+    if (!primGen->Init()) {
+      LOG(ERROR) << "Failed initialising primary generator" << std::endl;
+      return kFALSE;
+    }
+
+    /** success **/
+    return kTRUE;
+  }
+  
+  /*****************************************************************/
+  
+  Bool_t
+  SimulationManager::Run(const std::function<Bool_t(Long64_t)> &checkpoint) const
+  {
+    /** run, the checkpoint function is called every given
+	number of events with the events done so far **/
+    
+    /** FairRunSim instance **/
+    auto runsim = FairRunSim::Instance();
+    if (!runsim) {
+      LOG(FATAL) << "FairRunSim instance not created yet" << std::endl;
       return kFALSE;
     }
-    nevents = nevents_str.Atoi();
+
+    /** get number of events, checkpoint interval and batch size **/
+    Int_t nevents = -1, every = 0, batch = 1;
+    if (!GetNumberOfEvents(nevents)) return kFALSE;
+    if (!GetCheckpoint(every)) return kFALSE;
+    if (!GetBatchSize(batch)) return kFALSE;
+    if (!checkpoint) every = 0;
+
+    /** generator events are transported in batches, the
+	checkpoints count transport events and report generator events **/
+    Int_t ntransport = (nevents + batch - 1) / batch;
+    if (batch > 1)
+      LOG(INFO) << "Transporting " << nevents << " generator events in " << ntransport << " batches of " << batch << std::endl;
+    auto batchCheckpoint = [&checkpoint, batch](Long64_t events) {return checkpoint(events * batch);};
     
     /** run simulation **/
-    runsim->Run(nevents);
+    Profiler::Timer timer(Profiler::Instance().GetEntry("simulation.run"));
+    if (IsGeneratorOnly()) return RunGeneratorOnly(ntransport, every, batchCheckpoint);
+
+    /** the whole run goes through FairRunSim, the checkpoints are
+	written between events from the primary generator through the
+	checkpoint hook. the output tree is only saved at the checkpoints **/
+    auto &hook = CheckpointHook::Instance();
+    if (every > 0) {
+      auto tree = FairRootManager::Instance()->GetOutTree();
+      if (tree) tree->SetAutoSave(0);
+      hook.Set(every, [tree, &batchCheckpoint](Long64_t events) {
+	  if (tree) tree->AutoSave("SaveSelf FlushBaskets");
+	  return batchCheckpoint(events);
+	});
+    }
+    runsim->Run(ntransport);
+    hook.Set(0, nullptr);
+    if (hook.IsFailed()) return kFALSE;
 
     /** success **/
     return kTRUE;
   }
 
+  /*****************************************************************/
+
+  Bool_t
+  SimulationManager::RunGeneratorOnly(Int_t nevents, Int_t every, const std::function<Bool_t(Long64_t)> &checkpoint) const
+  {
+    /** run generator only, the primary generator is driven
+	directly and no VMC engine nor geometry are set up **/
+
+    /** FairRunSim instance **/
+    auto runsim = FairRunSim::Instance();
+    if (!runsim) {
+      LOG(FATAL) << "FairRunSim instance not created yet" << std::endl;
+      return kFALSE;
+    }
+    auto primGen = runsim->GetPrimaryGenerator();
+    auto header = runsim->GetMCEventHeader();
+
+    /** output file with primaries and event header only **/
+    auto fout = TFile::Open(GetValue("output_filename"), "RECREATE");
+    if (!fout || !fout->IsOpen()) {
+      LOG(ERROR) << "Cannot open output file: " << GetValue("output_filename") << std::endl;
+      return kFALSE;
+    }
+    PrimaryStack stack;
+    auto particles = stack.GetParticles();
+    auto tree = new TTree("o2sim", "o2sim generator-only output");
+    tree->Branch("Primaries", &particles);
+    tree->Branch("MCEventHeader.", header->ClassName(), &header);
+    if (every > 0) tree->SetAutoSave(0);
+
+    /** event loop **/
+    LOG(INFO) << "Running generator only: " << nevents << " events" << std::endl;
+    Bool_t retval = kTRUE;
+    for (Int_t ievent = 0; ievent < nevents; ievent++) {
+      stack.Reset();
+      header->Reset();
+      if (!primGen->GenerateEvent(&stack)) {
+	LOG(ERROR) << "Failed generating event " << ievent << std::endl;
+	retval = kFALSE;
+	break;
+      }
+      tree->Fill();
+      /** checkpoint **/
+      if (every > 0 && (ievent + 1) % every == 0 && ievent + 1 < nevents) {
+	tree->AutoSave("SaveSelf FlushBaskets");
+	if (!checkpoint(ievent + 1)) {
+	  retval = kFALSE;
+	  break;
+	}
+      }
+    }
+
+    /** write and close **/
+    fout->cd();
+    tree->Write();
+    fout->Close();
+    delete fout;
+    
+    return retval;
+  }
+  
   /*****************************************************************/
   
   Bool_t
@@ -117,6 +272,266 @@ namespace o2sim
   
   /*****************************************************************/
 
+  Bool_t
+  SimulationManager::SetupWorker(Int_t worker, Int_t nevents, UInt_t seed)
+  {
+    /** setup worker **/
+
+    /** worker output files, computed before leaving the parent directory **/
+    TString output = GetWorkerFileName("output_filename", worker);
+    TString checkpoint = GetWorkerFileName("checkpoint_filename", worker);
+    TString profiling = GetWorkerFileName("profiling_filename", worker);
+
+    /** each worker runs in its own directory **/
+    TString workdir = Form("o2sim.worker%d", worker);
+    gSystem->mkdir(workdir);
+    if (!gSystem->ChangeDirectory(workdir)) {
+      LOG(FATAL) << "Cannot change to worker directory: " << workdir << std::endl;
+      return kFALSE;
+    }
+
+    /** override worker values **/
+    Bool_t retval = kTRUE;
+    retval &= ProcessCommand("output_filename " + output, kValues);
+    retval &= ProcessCommand("checkpoint_filename " + checkpoint, kValues);
+    retval &= ProcessCommand("profiling_filename " + profiling, kValues);
+    retval &= ProcessCommand(Form("nevents %d", nevents), kValues);
+    retval &= ProcessCommand(Form("seed %u", seed), kValues);
+    retval &= ProcessCommand("nworkers 1", kValues);
+    return retval;
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  SimulationManager::MergeWorkers(Int_t nworkers) const
+  {
+    /** merge workers **/
+
+    std::vector<TString> filenames;
+    for (Int_t iworker = 0; iworker < nworkers; iworker++)
+      filenames.push_back(GetWorkerFileName("output_filename", iworker));
+    LOG(INFO) << "Merging " << nworkers << " worker output files into " << GetValue("output_filename") << std::endl;
+    if (!MergeFiles(filenames, GetValue("output_filename"))) return kFALSE;
+
+    /** remove worker output files **/
+    for (auto const &filename : filenames)
+      gSystem->Unlink(filename);
+    
+    /** success **/
+    return kTRUE;
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  SimulationManager::SetupResume(TString filename, Int_t nevents)
+  {
+    /** setup resume **/
+
+    Bool_t retval = kTRUE;
+    retval &= ProcessCommand("output_filename " + filename, kValues);
+    retval &= ProcessCommand(Form("nevents %d", nevents), kValues);
+    return retval;
+  }
+  
+  /*****************************************************************/
+
+  Bool_t
+  SimulationManager::MergeSegments(const std::vector<TString> &segments, TString filename) const
+  {
+    /** merge segments **/
+
+    LOG(INFO) << "Merging " << segments.size() << " output segments into " << filename << std::endl;
+    if (!MergeFiles(segments, filename)) return kFALSE;
+
+    /** remove segments **/
+    for (auto const &segment : segments)
+      gSystem->Unlink(segment);
+    
+    /** success **/
+    return kTRUE;
+  }
+  
+  /*****************************************************************/
+
+  Bool_t
+  SimulationManager::MergeFiles(const std::vector<TString> &filenames, TString filename) const
+  {
+    /** merge files **/
+
+    /** add input files **/
+    TFileMerger merger(kFALSE);
+    if (!merger.OutputFile(filename, "RECREATE")) {
+      LOG(ERROR) << "Cannot create merged output file: " << filename << std::endl;
+      return kFALSE;
+    }
+    for (auto const &input : filenames) {
+      if (!merger.AddFile(input)) {
+	LOG(ERROR) << "Cannot add output file: " << input << std::endl;
+	return kFALSE;
+      }
+    }
+
+    /** merge **/
+    if (!merger.Merge()) {
+      LOG(ERROR) << "Failed merging output files into " << filename << std::endl;
+      return kFALSE;
+    }
+    
+    /** success **/
+    return kTRUE;
+  }
+  
+  /*****************************************************************/
+
+  Bool_t
+  SimulationManager::GetNumberOfEvents(Int_t &n) const
+  {
+    /** get number of events **/
+
+    TString value = GetValue("nevents");
+    if (!value.IsDigit()) {
+      LOG(FATAL) << "Invalid number of events: " << value << std::endl;
+      return kFALSE;
+    }
+    /** success **/
+    n = value.Atoi();
+    return kTRUE;
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  SimulationManager::GetNumberOfWorkers(Int_t &n) const
+  {
+    /** get number of workers **/
+
+    TString value = GetValue("nworkers");
+    /** one worker per core **/
+    if (value.EqualTo("max")) {
+      n = std::max(1U, std::thread::hardware_concurrency());
+      return kTRUE;
+    }
+    if (!value.IsDigit() || value.Atoi() < 1) {
+      LOG(FATAL) << "Invalid number of workers: " << value << std::endl;
+      return kFALSE;
+    }
+    /** success **/
+    n = value.Atoi();
+    return kTRUE;
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  SimulationManager::GetSeed(UInt_t &seed) const
+  {
+    /** get seed **/
+
+    TString value = GetValue("seed");
+    char *end = nullptr;
+    errno = 0;
+    auto val = std::strtoull(value.Data(), &end, 10);
+    if (!value.IsDigit() || value.IsNull() || *end != '\0' || errno == ERANGE || val > kMaxUInt) {
+      LOG(FATAL) << "Invalid random seed: " << value << std::endl;
+      return kFALSE;
+    }
+    /** success **/
+    seed = val;
+    return kTRUE;
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  SimulationManager::GetCheckpoint(Int_t &n) const
+  {
+    /** get checkpoint interval, 0 if off **/
+
+    TString value = GetValue("checkpoint");
+    if (!value.IsDigit()) {
+      LOG(FATAL) << "Invalid checkpoint interval: " << value << std::endl;
+      return kFALSE;
+    }
+    /** success **/
+    n = value.Atoi();
+    return kTRUE;
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  SimulationManager::GetBatchSize(Int_t &n) const
+  {
+    /** get batch size, generator events per transport event **/
+
+    TString value = GetValue("batch");
+    if (!value.IsDigit() || value.Atoi() < 1) {
+      LOG(FATAL) << "Invalid batch size: " << value << std::endl;
+      return kFALSE;
+    }
+    /** success **/
+    n = value.Atoi();
+    return kTRUE;
+  }
+
+  /*****************************************************************/
+
+  TString
+  SimulationManager::GetSegmentFileName(TString filename, Int_t segment)
+  {
+    /** get segment file name **/
+
+    /** insert segment tag before the extension **/
+    TString tag = Form(".part%d", segment);
+    if (filename.EndsWith(".root")) filename.Insert(filename.Length() - 5, tag);
+    else filename += tag;
+    return filename;
+  }
+
+  /*****************************************************************/
+
+  TString
+  SimulationManager::GetWorkerFileName(TString name, Int_t worker) const
+  {
+    /** get worker file name **/
+
+    /** insert worker tag before the extension **/
+    TString filename;
+    if (!GetPath(name, filename)) filename = GetValue(name);
+    TString tag = Form(".worker%d", worker);
+    Int_t dot = filename.Last('.');
+    if (dot > filename.Last('/')) filename.Insert(dot, tag);
+    else filename += tag;
+    /** make it absolute, workers change directory **/
+    if (!filename.BeginsWith("/"))
+      filename = TString(gSystem->WorkingDirectory()) + "/" + filename;
+    return filename;
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  SimulationManager::SetupProfiling() const
+  {
+    /** setup profiling **/
+
+    if (IsValue("profiling", "off")) return kTRUE;
+    if (!IsValue("profiling", "on")) {
+      LOG(FATAL) << "Invalid profiling: " << GetValue("profiling") << std::endl;
+      return kFALSE;
+    }
+    Profiler::SetEnabled(kTRUE);
+    Profiler::Instance().SetFileName(GetValue("profiling_filename").Data());
+    LOG(INFO) << "Profiling enabled, summary will be written to " << GetValue("profiling_filename") << std::endl;
+    
+    /** success **/
+    return kTRUE;
+  }
+
+  /*****************************************************************/
+
   Bool_t
   SimulationManager::SetupEnvironment() const
   {
@@ -127,9 +542,8 @@ namespace o2sim
 				       {"geometry_path", ""},
 				       {"config_path", ""}};
     for (auto &x : path) {
-      x.second = GetValue(x.first);
-      if (gSystem->ExpandPathName(x.second)) {
-	LOG(FATAL) << "Cannot expand \"" << x.first << "\": " << x.second << std::endl;
+      if (!GetPath(x.first, x.second)) {
+	LOG(FATAL) << "Cannot expand \"" << x.first << "\": " << GetValue(x.first) << std::endl;
 	return kFALSE;
       }
     }
@@ -14,6 +14,8 @@
 #define ALICEO2SIM_SIMULATIONMANAGER_H_
 
 #include "Core/RunManagerDelegate.h"
+#include <functional>
+#include <vector>
 
 namespace o2sim {
   
@@ -30,12 +32,37 @@ namespace o2sim {
     
     /** methods **/
     Bool_t Init() const override;
-    Bool_t Run() const;
+    Bool_t InitGeneratorOnly() const;
+    Bool_t Run(const std::function<Bool_t(Long64_t)> &checkpoint = nullptr) const;
     Bool_t Terminate() const override;
+
+    /** worker methods **/
+    Bool_t SetupWorker(Int_t worker, Int_t nevents, UInt_t seed);
+    Bool_t MergeWorkers(Int_t nworkers) const;
+
+    /** checkpoint methods, a resumed run writes the remaining
+	events to a new output segment **/
+    Bool_t SetupResume(TString filename, Int_t nevents);
+    Bool_t MergeSegments(const std::vector<TString> &segments, TString filename) const;
+    static TString GetSegmentFileName(TString filename, Int_t segment);
+
+    /** getters **/
+    Bool_t GetNumberOfEvents(Int_t &n) const;
+    Bool_t GetNumberOfWorkers(Int_t &n) const;
+    Bool_t GetSeed(UInt_t &seed) const;
+    Bool_t GetCheckpoint(Int_t &n) const;
+    Bool_t GetBatchSize(Int_t &n) const;
+    TString GetCheckpointFileName() const {return GetValue("checkpoint_filename");};
+    TString GetOutputFileName() const {return GetValue("output_filename");};
+    Bool_t IsGeneratorOnly() const {return IsValue("mode", "generator_only");};
     
   private:
     
+    Bool_t RunGeneratorOnly(Int_t nevents, Int_t every, const std::function<Bool_t(Long64_t)> &checkpoint) const;
+    Bool_t MergeFiles(const std::vector<TString> &filenames, TString filename) const;
+    Bool_t SetupProfiling() const;
     Bool_t SetupEnvironment() const;
+    TString GetWorkerFileName(TString name, Int_t worker) const;
     
     ClassDefOverride(SimulationManager, 1)
       
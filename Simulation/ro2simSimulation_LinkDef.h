@@ -17,5 +17,6 @@
 #pragma link off all functions;
 
 #pragma link C++ class o2sim::SimulationManager+;
+#pragma link C++ class o2sim::PrimaryStack+;
 
 #endif
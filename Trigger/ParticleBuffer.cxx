@@ -0,0 +1,201 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See https://alice-o2.web.cern.ch/ for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \author R+Preghenella - September 2017
+
+#include "ParticleBuffer.h"
+#include "FairPrimaryGenerator.h"
+#include <cmath>
+
+namespace o2
+{
+namespace eventgen
+{
+
+  /*****************************************************************/
+  /*****************************************************************/
+
+  ParticleBuffer::ParticleBuffer() :
+    fPdgCode(),
+    fStatusCode(),
+    fPx(),
+    fPy(),
+    fPz(),
+    fE(),
+    fVx(),
+    fVy(),
+    fVz(),
+    fVt(),
+    fMother(),
+    fWantTracking(),
+    fWeight()
+  {
+    /** default constructor **/
+
+  }
+
+  /*****************************************************************/
+
+  ParticleBuffer::~ParticleBuffer()
+  {
+    /** default destructor **/
+
+  }
+
+  /*****************************************************************/
+
+  void
+  ParticleBuffer::Reserve(Int_t n)
+  {
+    /** reserve **/
+
+    fPdgCode.reserve(n);
+    fStatusCode.reserve(n);
+    fPx.reserve(n);
+    fPy.reserve(n);
+    fPz.reserve(n);
+    fE.reserve(n);
+    fVx.reserve(n);
+    fVy.reserve(n);
+    fVz.reserve(n);
+    fVt.reserve(n);
+    fMother.reserve(n);
+    fWantTracking.reserve(n);
+    fWeight.reserve(n);
+  }
+  
+  /*****************************************************************/
+
+  void
+  ParticleBuffer::Reset()
+  {
+    /** reset, keeps the allocated capacity **/
+
+    fPdgCode.clear();
+    fStatusCode.clear();
+    fPx.clear();
+    fPy.clear();
+    fPz.clear();
+    fE.clear();
+    fVx.clear();
+    fVy.clear();
+    fVz.clear();
+    fVt.clear();
+    fMother.clear();
+    fWantTracking.clear();
+    fWeight.clear();
+  }
+
+  /*****************************************************************/
+
+  void
+  ParticleBuffer::Swap(ParticleBuffer &other)
+  {
+    /** swap, exchanges the storage without copying **/
+
+    fPdgCode.swap(other.fPdgCode);
+    fStatusCode.swap(other.fStatusCode);
+    fPx.swap(other.fPx);
+    fPy.swap(other.fPy);
+    fPz.swap(other.fPz);
+    fE.swap(other.fE);
+    fVx.swap(other.fVx);
+    fVy.swap(other.fVy);
+    fVz.swap(other.fVz);
+    fVt.swap(other.fVt);
+    fMother.swap(other.fMother);
+    fWantTracking.swap(other.fWantTracking);
+    fWeight.swap(other.fWeight);
+  }
+
+  /*****************************************************************/
+
+  void
+  ParticleBuffer::Boost(Double_t boost)
+  {
+    /** boost along z by the given rapidity, momenta and 
+	production points are boosted once per particle **/
+
+    if (std::abs(boost) < 1.e-6) return;
+    const Double_t c = 2.99792458e10; // [cm/s]
+    auto coshb = std::cosh(boost);
+    auto sinhb = std::sinh(boost);
+    Int_t n = GetSize();
+    BoostKernel(fPz.data(), fE.data(), n, coshb, sinhb, sinhb);
+    BoostKernel(fVz.data(), fVt.data(), n, coshb, sinhb * c, sinhb / c);
+  }
+
+  /*****************************************************************/
+
+  void
+  ParticleBuffer::BoostKernel(Double_t *__restrict__ z, Double_t *__restrict__ t, Int_t n,
+			      Double_t coshb, Double_t sinhbz, Double_t sinhbt)
+  {
+    /** boost kernel over contiguous arrays, the columns do not alias
+	and the loop has no branches so that it can be vectorised **/
+
+    for (Int_t i = 0; i < n; i++) {
+      auto zz = z[i] * coshb - t[i] * sinhbz;
+      auto tt = t[i] * coshb - z[i] * sinhbt;
+      z[i] = zz;
+      t[i] = tt;
+    }
+  }
+
+  /*****************************************************************/
+
+  void
+  ParticleBuffer::AddParticle(Int_t pdg, Int_t status,
+			      Double_t px, Double_t py, Double_t pz, Double_t e,
+			      Double_t vx, Double_t vy, Double_t vz, Double_t vt,
+			      Int_t mother, Bool_t wantTracking, Double_t weight)
+  {
+    /** add particle **/
+
+    fPdgCode.push_back(pdg);
+    fStatusCode.push_back(status);
+    fPx.push_back(px);
+    fPy.push_back(py);
+    fPz.push_back(pz);
+    fE.push_back(e);
+    fVx.push_back(vx);
+    fVy.push_back(vy);
+    fVz.push_back(vz);
+    fVt.push_back(vt);
+    fMother.push_back(mother);
+    fWantTracking.push_back(wantTracking);
+    fWeight.push_back(weight);
+  }
+
+  /*****************************************************************/
+
+  void
+  ParticleBuffer::AddTracks(FairPrimaryGenerator *primGen) const
+  {
+    /** add tracks **/
+
+    /** loop over particles **/
+    Int_t nParticles = GetSize();
+    for (Int_t iparticle = 0; iparticle < nParticles; iparticle++)
+      primGen->AddTrack(fPdgCode[iparticle],
+			fPx[iparticle], fPy[iparticle], fPz[iparticle],
+			fVx[iparticle], fVy[iparticle], fVz[iparticle],
+			fMother[iparticle],
+			fWantTracking[iparticle],
+			fE[iparticle],
+			fVt[iparticle],
+			fWeight[iparticle]);
+  }
+  
+  /*****************************************************************/
+  /*****************************************************************/
+    
+} /* namespace eventgen */
+} /* namespace o2 */
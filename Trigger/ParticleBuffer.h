@@ -0,0 +1,113 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See https://alice-o2.web.cern.ch/ for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \author R+Preghenella - September 2017
+
+#ifndef ALICEO2_EVENTGEN_PARTICLEBUFFER_H_
+#define ALICEO2_EVENTGEN_PARTICLEBUFFER_H_
+
+#include "Rtypes.h"
+#include <vector>
+
+class FairPrimaryGenerator;
+
+namespace o2
+{
+namespace eventgen
+{
+
+  /*****************************************************************/
+  /*****************************************************************/
+
+  /** flat structure-of-arrays buffer of the generated particles,
+      pre-allocated and reused from one event to the next **/
+  
+  class ParticleBuffer
+  {
+    
+  public:
+
+    /** default constructor **/
+    ParticleBuffer();
+    /** destructor **/
+    virtual ~ParticleBuffer();
+
+    /** getters **/
+    Int_t GetSize() const {return fPdgCode.size();};
+    Int_t GetPdgCode(Int_t i) const {return fPdgCode[i];};
+    Int_t GetStatusCode(Int_t i) const {return fStatusCode[i];};
+    Int_t GetMother(Int_t i) const {return fMother[i];};
+    Double_t GetPx(Int_t i) const {return fPx[i];};
+    Double_t GetPy(Int_t i) const {return fPy[i];};
+    Double_t GetPz(Int_t i) const {return fPz[i];};
+    Double_t GetE(Int_t i) const {return fE[i];};
+    Bool_t GetWantTracking(Int_t i) const {return fWantTracking[i];};
+
+    /** column accessors **/
+    const Int_t *PdgCode() const {return fPdgCode.data();};
+    const Int_t *StatusCode() const {return fStatusCode.data();};
+    Double_t *Px() {return fPx.data();};
+    Double_t *Py() {return fPy.data();};
+    Double_t *Pz() {return fPz.data();};
+    Double_t *E() {return fE.data();};
+    Double_t *Vx() {return fVx.data();};
+    Double_t *Vy() {return fVy.data();};
+    Double_t *Vz() {return fVz.data();};
+    Double_t *Vt() {return fVt.data();};
+    const Double_t *Px() const {return fPx.data();};
+    const Double_t *Py() const {return fPy.data();};
+    const Double_t *Pz() const {return fPz.data();};
+    const Double_t *E() const {return fE.data();};
+    const Double_t *Vx() const {return fVx.data();};
+    const Double_t *Vy() const {return fVy.data();};
+    const Double_t *Vz() const {return fVz.data();};
+    const Double_t *Vt() const {return fVt.data();};
+    
+    /** methods **/
+    void Reserve(Int_t n);
+    void Reset();
+    void Swap(ParticleBuffer &other);
+    void Boost(Double_t boost);
+    void AddParticle(Int_t pdg, Int_t status,
+		     Double_t px, Double_t py, Double_t pz, Double_t e,
+		     Double_t vx, Double_t vy, Double_t vz, Double_t vt,
+		     Int_t mother, Bool_t wantTracking, Double_t weight = 1.);
+    void AddTracks(FairPrimaryGenerator *primGen) const;
+    
+  protected:
+
+    /** methods **/
+    static void BoostKernel(Double_t *__restrict__ z, Double_t *__restrict__ t, Int_t n,
+			    Double_t coshb, Double_t sinhbz, Double_t sinhbt);
+    
+    /** data members **/
+    std::vector<Int_t>    fPdgCode;
+    std::vector<Int_t>    fStatusCode;
+    std::vector<Double_t> fPx;
+    std::vector<Double_t> fPy;
+    std::vector<Double_t> fPz;
+    std::vector<Double_t> fE;
+    std::vector<Double_t> fVx;
+    std::vector<Double_t> fVy;
+    std::vector<Double_t> fVz;
+    std::vector<Double_t> fVt;           // [s]
+    std::vector<Int_t>    fMother;
+    std::vector<UChar_t>  fWantTracking;
+    std::vector<Double_t> fWeight;
+    
+  }; /** class ParticleBuffer **/
+  
+  /*****************************************************************/
+  /*****************************************************************/
+    
+} /** namespace eventgen **/
+} /** namespace o2 **/
+
+#endif /* ALICEO2_EVENTGEN_PARTICLEBUFFER_H_ */ 
@@ -9,12 +9,17 @@
 // or submit itself to any jurisdiction.
 
 #include "ParticleTrigger.h"
+#include "ParticleBuffer.h"
 #include "HepMC/GenEvent.h"
 #include "HepMC/GenParticle.h"
 #include "HepMC/GenVertex.h"
 #include "TClonesArray.h"
 #include "TParticle.h"
+#include "TDatabasePDG.h"
+#include "TParticlePDG.h"
+#include "TMath.h"
 #include <cmath>
+#include <algorithm>
 
 namespace o2
 {
@@ -28,13 +33,34 @@ namespace eventgen
     Trigger(),
     TriggerHepMC(),
     TriggerTGenerator(),
-    fPdgCode(0),
+    TriggerParticles(),
+    fPdgCodes(),
     fPtMin(0.),
     fPtMax(1.e9),
     fYMin(-1.e9),
-    fYMax(1.e9)
+    fYMax(1.e9),
+    fEtaMin(-1.e9),
+    fEtaMax(1.e9),
+    fPhiMin(0.),
+    fPhiMax(TMath::TwoPi()),
+    fCharge(0),
+    fUseCharge(kFALSE),
+    fPt2Min(0.),
+    fPt2Max(0.),
+    fUseY(kFALSE),
+    fSinh2YMin(0.),
+    fSinh2YMax(0.),
+    fUseEta(kFALSE),
+    fSinh2EtaMin(0.),
+    fSinh2EtaMax(0.),
+    fUsePhi(kFALSE),
+    fPhiLow(0.),
+    fPhiWidth(TMath::TwoPi()),
+    fChargeMap()
   {
     /** default contructor */
+
+    Compile();
   }
 
   /*****************************************************************/
@@ -46,6 +72,104 @@ namespace eventgen
 
   /*****************************************************************/
 
+  void
+  ParticleTrigger::Compile()
+  {
+    /** compile the cuts into comparisons without sqrt/log **/
+
+    /** pt against squared bounds **/
+    fPt2Min = fPtMin > 0. ? fPtMin * fPtMin : 0.;
+    fPt2Max = fPtMax * fPtMax;
+
+    /** rapidity and pseudorapidity are compared through the signed
+	square of their sinh, y = asinh(pz / mt) and eta = asinh(pz / pt).
+	bounds beyond +-50 are treated as open **/
+    auto sinh2 = [](Double_t x) {
+      auto s = std::sinh(std::max(-50., std::min(50., x)));
+      return s * std::abs(s);
+    };
+    fUseY = fYMin > -50. || fYMax < 50.;
+    fSinh2YMin = sinh2(fYMin);
+    fSinh2YMax = sinh2(fYMax);
+    fUseEta = fEtaMin > -50. || fEtaMax < 50.;
+    fSinh2EtaMin = sinh2(fEtaMin);
+    fSinh2EtaMax = sinh2(fEtaMax);
+
+    /** phi as an offset from the lower edge brought into [0, 2pi),
+	so that a range crossing 0 or given in (-pi, pi] is a window
+	like any other **/
+    fPhiWidth = fPhiMax - fPhiMin;
+    fUsePhi = fPhiWidth < TMath::TwoPi();
+    fPhiLow = std::fmod(fPhiMin, TMath::TwoPi());
+    if (fPhiLow < 0.) fPhiLow += TMath::TwoPi();
+
+    /** charge lookup table **/
+    fChargeMap.clear();
+    if (!fUseCharge) return;
+    auto particleList = TDatabasePDG::Instance()->ParticleList();
+    if (!particleList) return;
+    for (auto const &object : *particleList) {
+      auto particle = dynamic_cast<TParticlePDG *>(object);
+      if (!particle) continue;
+      fChargeMap[particle->PdgCode()] = TMath::Nint(particle->Charge() / 3.);
+    }
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  ParticleTrigger::IsSelected(Int_t pdg, Double_t px, Double_t py, Double_t pz, Double_t e) const
+  {
+    /** is selected **/
+
+    /** check pdg **/
+    if (!fPdgCodes.empty() && std::find(fPdgCodes.begin(), fPdgCodes.end(), pdg) == fPdgCodes.end()) return kFALSE;
+    /** check pt **/
+    auto pt2 = px * px + py * py;
+    if (pt2 < fPt2Min || pt2 > fPt2Max) return kFALSE;
+    /** check the others **/
+    return IsSelectedSlow(pdg, px, py, pz, e);
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  ParticleTrigger::IsSelectedSlow(Int_t pdg, Double_t px, Double_t py, Double_t pz, Double_t e) const
+  {
+    /** is selected, cuts after pdg and pt **/
+
+    auto pz2 = pz * std::abs(pz);
+    /** check rapidity **/
+    if (fUseY) {
+      auto mt2 = e * e - pz * pz;
+      /** no rapidity without transverse mass **/
+      if (mt2 <= 0.) return kFALSE;
+      if (pz2 < fSinh2YMin * mt2 || pz2 > fSinh2YMax * mt2) return kFALSE;
+    }
+    /** check pseudorapidity **/
+    if (fUseEta) {
+      auto pt2 = px * px + py * py;
+      if (pz2 < fSinh2EtaMin * pt2 || pz2 > fSinh2EtaMax * pt2) return kFALSE;
+    }
+    /** check charge **/
+    if (fUseCharge) {
+      auto charge = fChargeMap.find(pdg);
+      if (charge == fChargeMap.end() || charge->second != fCharge) return kFALSE;
+    }
+    /** check phi **/
+    if (fUsePhi) {
+      auto dphi = std::atan2(py, px) - fPhiLow;
+      if (dphi < 0.) dphi += TMath::TwoPi();
+      if (dphi < 0.) dphi += TMath::TwoPi();
+      if (dphi > fPhiWidth) return kFALSE;
+    }
+
+    /** success **/
+    return kTRUE;
+  }
+  
+  /*****************************************************************/
+
   Bool_t
   ParticleTrigger::IsTriggered(HepMC::GenEvent *event) const
   {
@@ -53,29 +177,9 @@ namespace eventgen
 
     /** loop over particles **/
     for (auto const &particle : event->particles()) {
-
-      /** get momentum information **/
-      auto pdg = particle->pid();      
-      auto momentum = particle->momentum();
-      auto px = momentum.x();
-      auto py = momentum.y();
-      auto pz = momentum.z();
-      auto et = momentum.t();
-      auto pt = sqrt(px * px + py * py);
-      auto pp = sqrt(px * px + py * py + pz * pz);
-      auto rapidity = 0.5 * log ( (et + pz) / (et - pz) );
-
-      /** check pdg **/
-      if (pdg != fPdgCode) continue;
-      /** check pt **/
-      if (pt < fPtMin) continue;
-      if (pt > fPtMax) continue;
-      /** check rapidity **/
-      if (rapidity < fYMin) continue;
-      if (rapidity > fYMax) continue;
-
-      /** success **/
-      return kTRUE;
+      auto const &momentum = particle->momentum();
+      if (IsSelected(particle->pid(), momentum.x(), momentum.y(), momentum.z(), momentum.t()))
+	return kTRUE;
     }
 
     /** failure **/
@@ -89,20 +193,81 @@ namespace eventgen
   {
     /** is triggered **/
 
-    /* add tracks */
+    /** loop over particles **/
     Int_t nParticles = particles->GetEntries();
-    TParticle *particle = NULL;
     for (Int_t iparticle = 0; iparticle < nParticles; iparticle++) {
-      particle = (TParticle *)particles->At(iparticle);
+      auto particle = (TParticle *)particles->UncheckedAt(iparticle);
       if (!particle) continue;
-      if (particle->GetPdgCode() != fPdgCode) continue;
-      if (particle->Pt() < fPtMin) continue;
-      if (particle->Pt() > fPtMax) continue;
-      if (particle->Y() < fYMin) continue;
-      if (particle->Y() > fYMax) continue;
-      return kTRUE;
+      if (IsSelected(particle->GetPdgCode(), particle->Px(), particle->Py(), particle->Pz(), particle->Energy()))
+	return kTRUE;
     }
 
+    /** failure **/
+    return kFALSE;
+  }
+
+  /*****************************************************************/
+  
+  Bool_t
+  ParticleTrigger::IsTriggered(const ParticleBuffer &particles) const
+  {
+    /** is triggered **/
+
+    /** the particles are scanned in blocks. cheap cuts on pdg and 
+	squared pt are evaluated over the whole block without branches, 
+	so that they can be vectorised, into a mask. the remaining cuts 
+	are evaluated only on the candidates and the scan stops at the 
+	first selected particle **/
+    
+    const Int_t kBlockSize = 256;
+    UChar_t mask[kBlockSize];
+    auto pdg = particles.PdgCode();
+    auto px = particles.Px();
+    auto py = particles.Py();
+    auto pz = particles.Pz();
+    auto et = particles.E();
+    auto pdgCodes = fPdgCodes.data();
+    Int_t nPdgCodes = fPdgCodes.size();
+    auto pt2Min = fPt2Min;
+    auto pt2Max = fPt2Max;
+    Int_t nParticles = particles.GetSize();
+
+    /** loop over blocks **/
+    for (Int_t first = 0; first < nParticles; first += kBlockSize) {
+      Int_t n = std::min(kBlockSize, nParticles - first);
+      auto bpdg = pdg + first;
+      auto bpx = px + first;
+      auto bpy = py + first;
+
+      /** check pdg **/
+      for (Int_t i = 0; i < n; i++)
+	mask[i] = nPdgCodes == 0;
+      for (Int_t icode = 0; icode < nPdgCodes; icode++) {
+	auto code = pdgCodes[icode];
+	for (Int_t i = 0; i < n; i++)
+	  mask[i] |= bpdg[i] == code;
+      }
+      Int_t nSelected = 0;
+      for (Int_t i = 0; i < n; i++)
+	nSelected += mask[i];
+      if (nSelected == 0) continue;
+
+      /** check pt **/
+      for (Int_t i = 0; i < n; i++) {
+	auto pt2 = bpx[i] * bpx[i] + bpy[i] * bpy[i];
+	mask[i] &= (pt2 >= pt2Min) & (pt2 <= pt2Max);
+      }
+
+      /** check the others on the candidates **/
+      for (Int_t i = 0; i < n; i++) {
+	if (!mask[i]) continue;
+	auto j = first + i;
+	if (IsSelectedSlow(pdg[j], px[j], py[j], pz[j], et[j])) return kTRUE;
+      }
+      
+    } /** end of loop over blocks **/
+
+    /** failure **/
     return kFALSE;
   }
 
@@ -15,6 +15,9 @@
 
 #include "TriggerHepMC.h"
 #include "TriggerTGenerator.h"
+#include "TriggerParticles.h"
+#include <vector>
+#include <unordered_map>
 
 namespace o2
 {
@@ -24,7 +27,12 @@ namespace eventgen
   /*****************************************************************/
   /*****************************************************************/
 
-  class ParticleTrigger : public TriggerHepMC, public TriggerTGenerator
+  /** fires when at least one particle passes all cuts. the cuts are
+      compiled into cheap comparisons by Compile(), which has to be
+      called again after changing them. they are evaluated from the
+      cheapest to the most expensive one **/
+  
+  class ParticleTrigger : public TriggerHepMC, public TriggerTGenerator, public TriggerParticles
   {
     
   public:
@@ -34,14 +42,21 @@ namespace eventgen
     /** destructor **/
     virtual ~ParticleTrigger();
 
-    void SetPdgCode(Int_t val) {fPdgCode = val;};
+    void SetPdgCode(Int_t val) {fPdgCodes.assign(1, val);};
+    void AddPdgCode(Int_t val) {fPdgCodes.push_back(val);};
     void SetPtRange(Double_t min, Double_t max) {fPtMin = min; fPtMax = max;};
     void SetPtMin(Double_t val) {fPtMin = val;};
     void SetPtMax(Double_t val) {fPtMax = val;};
     void SetYRange(Double_t min, Double_t max) {fYMin = min; fYMax = max;};
     void SetYMin(Double_t val) {fYMin = val;};
     void SetYMax(Double_t val) {fYMax = val;};
+    void SetEtaRange(Double_t min, Double_t max) {fEtaMin = min; fEtaMax = max;};
+    void SetPhiRange(Double_t min, Double_t max) {fPhiMin = min; fPhiMax = max;};
+    void SetCharge(Int_t val) {fCharge = val; fUseCharge = kTRUE;};
 
+    /** methods **/
+    void Compile();
+    
   protected:
 
     /** copy constructor **/
@@ -51,22 +66,49 @@ namespace eventgen
     
     virtual Bool_t IsTriggered(HepMC::GenEvent *event) const override;
     virtual Bool_t IsTriggered(TClonesArray *particles, TGenerator *generator) const override;
+    virtual Bool_t IsTriggered(const ParticleBuffer &particles) const override;
+
+    /** methods **/
+    Bool_t IsSelected(Int_t pdg, Double_t px, Double_t py, Double_t pz, Double_t e) const;
+    Bool_t IsSelectedSlow(Int_t pdg, Double_t px, Double_t py, Double_t pz, Double_t e) const;
 
-    Int_t fPdgCode;
+    /** cuts **/
+    std::vector<Int_t> fPdgCodes;
     Double_t fPtMin;
     Double_t fPtMax;
     Double_t fYMin;
     Double_t fYMax;
+    Double_t fEtaMin;
+    Double_t fEtaMax;
+    Double_t fPhiMin;
+    Double_t fPhiMax;
+    Int_t fCharge;
+    Bool_t fUseCharge;
+
+    /** compiled cuts **/
+    Double_t fPt2Min;                            //! squared pt bounds
+    Double_t fPt2Max;                            //!
+    Bool_t fUseY;                                //! pz|pz| / mt^2 against sinh(y)|sinh(y)|
+    Double_t fSinh2YMin;                         //!
+    Double_t fSinh2YMax;                         //!
+    Bool_t fUseEta;                              //! pz|pz| / pt^2 against sinh(eta)|sinh(eta)|
+    Double_t fSinh2EtaMin;                       //!
+    Double_t fSinh2EtaMax;                       //!
+    Bool_t fUsePhi;                              //! phi - low edge, in [0, 2pi), against the width
+    Double_t fPhiLow;                            //!
+    Double_t fPhiWidth;                          //!
+    std::unordered_map<Int_t, Int_t> fChargeMap; //! PDG code to charge [e]
     
-    ClassDefOverride(ParticleTrigger, 1);
+    /** version 1 stored a single PDG code, it is converted
+	by the read rule in the LinkDef **/
+    ClassDefOverride(ParticleTrigger, 2);
 
   }; /** class ParticleTrigger **/
-  }
 
-/*****************************************************************/
+  /*****************************************************************/
   /*****************************************************************/
 
- /** namespace eventgen **/
+} /** namespace eventgen **/
 } /** namespace o2 **/
 
 #endif /** ALICEO2_EVENTGEN_PARTICLETRIGGER_H_ **/ 
@@ -14,6 +14,8 @@
 #include "TGenerator.h"
 #include "TParticle.h"
 #include "TRandom.h"
+#include "TDirectory.h"
+#include "TParameter.h"
 
 namespace o2
 {
@@ -28,7 +30,8 @@ namespace eventgen
     fDownscale(1.),
     fNumberOfTimeSlots(1),
     fActiveTimeSlot(0),
-    fTimeSlot(0)
+    fTimeSlot(0),
+    fRandom(kDefaultSeed)
   {
     /** default contructor **/
   }
@@ -58,6 +61,43 @@ namespace eventgen
     return kTRUE;
   }
 
+  /*****************************************************************/
+
+  Bool_t
+  Trigger::SaveState(TDirectory *dir, const TString &prefix) const
+  {
+    /** save state **/
+
+    TParameter<Int_t> timeSlot(prefix + ".timeslot", fTimeSlot);
+    if (dir->WriteTObject(&timeSlot) <= 0) return kFALSE;
+    if (dir->WriteTObject(&fRandom, prefix + ".random") <= 0) return kFALSE;
+
+    /** success **/
+    return kTRUE;
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  Trigger::LoadState(TDirectory *dir, const TString &prefix)
+  {
+    /** load state **/
+
+    auto timeSlot = dynamic_cast<TParameter<Int_t> *>(dir->Get(prefix + ".timeslot"));
+    auto random = dynamic_cast<TRandom3 *>(dir->Get(prefix + ".random"));
+    if (!timeSlot || !random) {
+      LOG(ERROR) << "Cannot find state of \"" << GetName() << "\" trigger: " << prefix << std::endl;
+      return kFALSE;
+    }
+    fTimeSlot = timeSlot->GetVal();
+    fRandom = *random;
+    delete timeSlot;
+    delete random;
+
+    /** success **/
+    return kTRUE;
+  }
+
   /*****************************************************************/
   /*****************************************************************/
 
@@ -14,7 +14,7 @@
 #define ALICEO2_EVENTGEN_TRIGGER_H_
 
 #include "TNamed.h"
-#include "TRandom.h"
+#include "TRandom3.h"
 
 namespace HepMC {
   class GenEvent;
@@ -22,6 +22,7 @@ namespace HepMC {
 
 class TClonesArray;
 class TGenerator;
+class TDirectory;
 
 namespace o2
 {
@@ -32,6 +33,9 @@ namespace eventgen
   {
     
   public:
+
+    /** seed used when none is given, TRandom3 would take the clock **/
+    enum {kDefaultSeed = 4357};
     
     /** default constructor **/
     Trigger();
@@ -47,6 +51,12 @@ namespace eventgen
     void SetDownscale(Double_t val) {fDownscale = val;};
     void SetNumberOfTimeSlots(UInt_t val) {fNumberOfTimeSlots = val;};
     void SetActiveTimeSlot(UInt_t val) {fActiveTimeSlot = val;};
+    void SetSeed(UInt_t val) {fRandom.SetSeed(val > 0 ? val : kDefaultSeed);};
+
+    /** checkpoint methods, the time slot and the random
+	state are stored under the given name prefix **/
+    virtual Bool_t SaveState(TDirectory *dir, const TString &prefix) const;
+    virtual Bool_t LoadState(TDirectory *dir, const TString &prefix);
 
   protected:
     
@@ -57,7 +67,7 @@ namespace eventgen
 
     /** methods **/
     Bool_t IsActive();
-    Bool_t IsDownscaled() {return gRandom->Uniform() > fDownscale;};
+    Bool_t IsDownscaled() {return fRandom.Uniform() > fDownscale;};
 
     /** data members **/
     Double_t fDownscale;
@@ -67,6 +77,7 @@ namespace eventgen
   private:
 
     UInt_t fTimeSlot;
+    TRandom3 fRandom; //! own generator, triggers may run off the main thread
 
     ClassDefOverride(Trigger, 1);
   };
@@ -0,0 +1,434 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See https://alice-o2.web.cern.ch/ for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \author R+Preghenella - September 2017
+
+#include "TriggerExpression.h"
+#include "FairLogger.h"
+#include "TDirectory.h"
+#include "TParameter.h"
+#include "TArrayD.h"
+#include <algorithm>
+#include <chrono>
+#include <cctype>
+
+namespace o2
+{
+namespace eventgen
+{
+
+  /*****************************************************************/
+  /*****************************************************************/
+
+  TriggerExpression::TriggerExpression() :
+    Trigger(),
+    TriggerParticles(),
+    fNodes(),
+    fRoot(-1),
+    fEvaluations(0),
+    fTriggers(),
+    fTriggerFired()
+  {
+    /** default constructor **/
+  }
+
+  /*****************************************************************/
+
+  TriggerExpression::~TriggerExpression()
+  {
+    /** default destructor **/
+
+    for (auto &trigger : fTriggers)
+      delete trigger;
+  }
+  
+  /*****************************************************************/
+
+  Bool_t
+  TriggerExpression::Parse(const std::string &expression, const std::map<std::string, Trigger *> &triggers)
+  {
+    /** parse, the triggers are owned from here on **/
+
+    for (auto const &x : triggers)
+      if (std::find(fTriggers.begin(), fTriggers.end(), x.second) == fTriggers.end())
+	fTriggers.push_back(x.second);
+
+    /** tokenise, parentheses are tokens on their own **/
+    std::vector<std::string> tokens;
+    std::string token;
+    for (auto c : expression) {
+      if (std::isspace(c) || c == '(' || c == ')') {
+	if (!token.empty()) tokens.push_back(token);
+	token.clear();
+	if (c == '(' || c == ')') tokens.push_back(std::string(1, c));
+      }
+      else token += c;
+    }
+    if (!token.empty()) tokens.push_back(token);
+    
+    /** build tree **/
+    fNodes.clear();
+    fRoot = -1;
+    size_t pos = 0;
+    fRoot = ParseOr(tokens, pos, triggers);
+    if (fRoot < 0) return kFALSE;
+    if (pos != tokens.size()) {
+      LOG(ERROR) << "Unexpected \"" << tokens[pos] << "\" in trigger expression: " << expression << std::endl;
+      fRoot = -1;
+      return kFALSE;
+    }
+
+    /** success **/
+    return kTRUE;
+  }
+
+  /*****************************************************************/
+
+  Int_t
+  TriggerExpression::AddNode(ENodeType_t type, const std::string &name, Trigger *trigger)
+  {
+    /** add node **/
+
+    Node_t node;
+    node.type = type;
+    node.name = name;
+    node.trigger = trigger;
+    node.particles = dynamic_cast<TriggerParticles *>(trigger);
+    node.calls = 0;
+    node.passed = 0;
+    node.timed = 0;
+    node.time = 0.;
+    fNodes.push_back(node);
+    return fNodes.size() - 1;
+  }
+  
+  /*****************************************************************/
+
+  Int_t
+  TriggerExpression::ParseOr(const std::vector<std::string> &tokens, size_t &pos, const std::map<std::string, Trigger *> &triggers)
+  {
+    /** parse OR, operands are collected in a single node **/
+
+    auto first = ParseAnd(tokens, pos, triggers);
+    if (first < 0) return -1;
+    if (pos >= tokens.size() || !TString(tokens[pos]).EqualTo("OR", TString::kIgnoreCase)) return first;
+    auto inode = AddNode(kOr);
+    fNodes[inode].children.push_back(first);
+    while (pos < tokens.size() && TString(tokens[pos]).EqualTo("OR", TString::kIgnoreCase)) {
+      pos++;
+      auto next = ParseAnd(tokens, pos, triggers);
+      if (next < 0) return -1;
+      fNodes[inode].children.push_back(next);
+    }
+    return inode;
+  }
+  
+  /*****************************************************************/
+
+  Int_t
+  TriggerExpression::ParseAnd(const std::vector<std::string> &tokens, size_t &pos, const std::map<std::string, Trigger *> &triggers)
+  {
+    /** parse AND, operands are collected in a single node **/
+
+    auto first = ParseNot(tokens, pos, triggers);
+    if (first < 0) return -1;
+    if (pos >= tokens.size() || !TString(tokens[pos]).EqualTo("AND", TString::kIgnoreCase)) return first;
+    auto inode = AddNode(kAnd);
+    fNodes[inode].children.push_back(first);
+    while (pos < tokens.size() && TString(tokens[pos]).EqualTo("AND", TString::kIgnoreCase)) {
+      pos++;
+      auto next = ParseNot(tokens, pos, triggers);
+      if (next < 0) return -1;
+      fNodes[inode].children.push_back(next);
+    }
+    return inode;
+  }
+  
+  /*****************************************************************/
+
+  Int_t
+  TriggerExpression::ParseNot(const std::vector<std::string> &tokens, size_t &pos, const std::map<std::string, Trigger *> &triggers)
+  {
+    /** parse NOT, parentheses and trigger names **/
+
+    if (pos >= tokens.size()) {
+      LOG(ERROR) << "Unexpected end of trigger expression" << std::endl;
+      return -1;
+    }
+    auto token = tokens[pos++];
+
+    /** NOT **/
+    if (TString(token).EqualTo("NOT", TString::kIgnoreCase)) {
+      auto child = ParseNot(tokens, pos, triggers);
+      if (child < 0) return -1;
+      auto inode = AddNode(kNot);
+      fNodes[inode].children.push_back(child);
+      return inode;
+    }
+    
+    /** parentheses **/
+    if (token == "(") {
+      auto inode = ParseOr(tokens, pos, triggers);
+      if (inode < 0) return -1;
+      if (pos >= tokens.size() || tokens[pos] != ")") {
+	LOG(ERROR) << "Missing \")\" in trigger expression" << std::endl;
+	return -1;
+      }
+      pos++;
+      return inode;
+    }
+
+    /** trigger name **/
+    auto trigger = triggers.find(token);
+    if (trigger == triggers.end()) {
+      LOG(ERROR) << "Unknown trigger in trigger expression: " << token << std::endl;
+      return -1;
+    }
+    return AddNode(kLeaf, token, trigger->second);
+  }
+  
+  /*****************************************************************/
+
+  Bool_t
+  TriggerExpression::IsTriggered(const ParticleBuffer &particles) const
+  {
+    /** is triggered, one evaluation in fgTimingPeriod is timed **/
+
+    if (fRoot < 0) return kFALSE;
+    if (++fEvaluations % fgReorderPeriod == 0) Reorder();
+    return Evaluate(fRoot, particles, fEvaluations % fgTimingPeriod == 0);
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  TriggerExpression::UsesParticles() const
+  {
+    /** uses particles, when any operand is a particle trigger **/
+
+    for (auto const &node : fNodes)
+      if (node.type == kLeaf && node.particles) return kTRUE;
+    return kFALSE;
+  }
+  
+  /*****************************************************************/
+
+  Bool_t
+  TriggerExpression::Evaluate(Int_t inode, const ParticleBuffer &particles, Bool_t timed) const
+  {
+    /** evaluate with short circuit, measuring selectivity and,
+	when timed, cost **/
+
+    std::chrono::steady_clock::time_point start;
+    if (timed) start = std::chrono::steady_clock::now();
+    auto &node = fNodes[inode];
+    Bool_t result = kFALSE;
+    switch (node.type) {
+    case kLeaf:
+      if (node.particles) result = node.particles->TriggerEvent(particles);
+      else if (fTriggerFired) result = fTriggerFired(node.trigger);
+      break;
+    case kNot:
+      result = !Evaluate(node.children[0], particles, timed);
+      break;
+    case kAnd:
+      result = kTRUE;
+      for (auto const &child : node.children)
+	if (!Evaluate(child, particles, timed)) {
+	  result = kFALSE;
+	  break;
+	}
+      break;
+    case kOr:
+      result = kFALSE;
+      for (auto const &child : node.children)
+	if (Evaluate(child, particles, timed)) {
+	  result = kTRUE;
+	  break;
+	}
+      break;
+    }
+    if (timed) {
+      node.time += std::chrono::duration<Double_t>(std::chrono::steady_clock::now() - start).count();
+      node.timed++;
+    }
+    node.calls++;
+    if (result) node.passed++;
+    return result;
+  }
+  
+  /*****************************************************************/
+
+  Double_t
+  TriggerExpression::GetRank(Int_t inode, ENodeType_t parent) const
+  {
+    /** rank of an operand, the expected cost to decide the parent.
+	an AND is decided by a failing operand and an OR by a passing 
+	one. operands not measured yet go first **/
+
+    auto const &node = fNodes[inode];
+    if (node.calls == 0 || node.timed == 0) return 0.;
+    auto cost = node.time / node.timed;
+    auto pass = (Double_t)node.passed / node.calls;
+    auto decide = parent == kAnd ? 1. - pass : pass;
+    return decide > 0. ? cost / decide : 1.e30;
+  }
+  
+  /*****************************************************************/
+
+  void
+  TriggerExpression::Reorder() const
+  {
+    /** reorder the operands of the AND/OR nodes by rank **/
+
+    for (auto &node : fNodes) {
+      if (node.type != kAnd && node.type != kOr) continue;
+      auto type = node.type;
+      std::stable_sort(node.children.begin(), node.children.end(),
+		       [this, type](Int_t a, Int_t b) {return GetRank(a, type) < GetRank(b, type);});
+    }
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  TriggerExpression::SaveState(TDirectory *dir, const TString &prefix) const
+  {
+    /** save state, the operand order is saved with the
+	statistics it is derived from **/
+
+    if (!Trigger::SaveState(dir, prefix)) return kFALSE;
+
+    /** nodes, packed as calls, passed, timed, time, number of children, children **/
+    std::vector<Double_t> nodes;
+    for (auto const &node : fNodes) {
+      nodes.push_back(node.calls);
+      nodes.push_back(node.passed);
+      nodes.push_back(node.timed);
+      nodes.push_back(node.time);
+      nodes.push_back(node.children.size());
+      for (auto const &child : node.children)
+	nodes.push_back(child);
+    }
+    TArrayD array(nodes.size(), nodes.data());
+    if (dir->WriteObject(&array, prefix + ".nodes") <= 0) return kFALSE;
+    TParameter<Long64_t> evaluations(prefix + ".evaluations", fEvaluations);
+    if (dir->WriteTObject(&evaluations) <= 0) return kFALSE;
+
+    /** operand triggers **/
+    for (Int_t inode = 0; inode < (Int_t)fNodes.size(); inode++) {
+      if (fNodes[inode].type != kLeaf) continue;
+      if (!fNodes[inode].trigger->SaveState(dir, prefix + Form(".node%d", inode))) return kFALSE;
+    }
+    
+    /** success **/
+    return kTRUE;
+  }
+
+  /*****************************************************************/
+
+  Bool_t
+  TriggerExpression::LoadState(TDirectory *dir, const TString &prefix)
+  {
+    /** load state **/
+
+    if (!Trigger::LoadState(dir, prefix)) return kFALSE;
+
+    /** nodes, the expression must not have changed **/
+    TArrayD *array = nullptr;
+    dir->GetObject(prefix + ".nodes", array);
+    auto evaluations = dynamic_cast<TParameter<Long64_t> *>(dir->Get(prefix + ".evaluations"));
+    if (!array || !evaluations) {
+      LOG(ERROR) << "Cannot find state of trigger expression: " << prefix << std::endl;
+      return kFALSE;
+    }
+    Int_t pos = 0;
+    Bool_t valid = kTRUE;
+    for (auto &node : fNodes) {
+      if (pos + 5 > array->GetSize()) {
+	valid = kFALSE;
+	break;
+      }
+      node.calls = array->At(pos++);
+      node.passed = array->At(pos++);
+      node.timed = array->At(pos++);
+      node.time = array->At(pos++);
+      size_t nchildren = array->At(pos++);
+      if (nchildren != node.children.size() || pos + (Int_t)nchildren > array->GetSize()) {
+	valid = kFALSE;
+	break;
+      }
+      for (auto &child : node.children)
+	child = array->At(pos++);
+    }
+    valid &= pos == array->GetSize();
+    fEvaluations = evaluations->GetVal();
+    delete array;
+    delete evaluations;
+    if (!valid) {
+      LOG(ERROR) << "Saved state does not match trigger expression: " << ToString() << std::endl;
+      return kFALSE;
+    }
+    
+    /** operand triggers **/
+    for (Int_t inode = 0; inode < (Int_t)fNodes.size(); inode++) {
+      if (fNodes[inode].type != kLeaf) continue;
+      if (!fNodes[inode].trigger->LoadState(dir, prefix + Form(".node%d", inode))) return kFALSE;
+    }
+    
+    /** success **/
+    return kTRUE;
+  }
+
+  /*****************************************************************/
+
+  std::string
+  TriggerExpression::ToString(Int_t inode) const
+  {
+    /** to string **/
+
+    if (inode < 0) return "";
+    auto const &node = fNodes[inode];
+    if (node.type == kLeaf) return node.name;
+    if (node.type == kNot) return "NOT " + ToString(node.children[0]);
+    std::string op = node.type == kAnd ? " AND " : " OR ";
+    std::string str = "(";
+    for (size_t ichild = 0; ichild < node.children.size(); ichild++) {
+      if (ichild > 0) str += op;
+      str += ToString(node.children[ichild]);
+    }
+    return str + ")";
+  }
+  
+  /*****************************************************************/
+
+  void
+  TriggerExpression::PrintCounters() const
+  {
+    /** print counters **/
+
+    TriggerParticles::PrintCounters();
+    if (fRoot < 0) return;
+    LOG(INFO) << "Trigger expression \"" << GetName() << "\" in current order: " << ToString() << std::endl;
+    for (auto const &node : fNodes) {
+      if (node.type != kLeaf) continue;
+      LOG(INFO) << "Trigger expression operand \"" << node.name << "\":"
+		<< " calls = " << node.calls
+		<< " | passed = " << node.passed
+		<< " | average time = " << (node.timed > 0 ? node.time / node.timed : 0.) << " s"
+		<< std::endl;
+    }
+  }
+  
+  /*****************************************************************/
+  /*****************************************************************/
+
+} /* namespace eventgen */
+} /* namespace o2 */
@@ -0,0 +1,124 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See https://alice-o2.web.cern.ch/ for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \author R+Preghenella - September 2017
+
+#ifndef ALICEO2_EVENTGEN_TRIGGEREXPRESSION_H_
+#define ALICEO2_EVENTGEN_TRIGGEREXPRESSION_H_
+
+#include "TriggerParticles.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <functional>
+
+namespace o2
+{
+namespace eventgen
+{
+
+  /*****************************************************************/
+  /*****************************************************************/
+
+  /** boolean combination of triggers, e.g. 
+      "(jpsi AND muon) OR NOT highpt". the expression is parsed once
+      into a tree with n-ary AND/OR nodes and evaluated with short
+      circuit. the operands of each AND/OR node are periodically 
+      reordered by their measured cost and selectivity, so that the 
+      ones most likely to decide the result cheaply come first.
+      particle triggers run on the particle buffer, the others are
+      handed to the generator through the trigger-fired function.
+      the expression owns the triggers it is given **/
+  
+  class TriggerExpression : public TriggerParticles
+  {
+    
+  public:
+    
+    /** default constructor **/
+    TriggerExpression();
+    /** destructor **/
+    virtual ~TriggerExpression();
+
+    /** methods **/
+    Bool_t Parse(const std::string &expression, const std::map<std::string, Trigger *> &triggers);
+    Bool_t UsesParticles() const override;
+    std::string ToString() const {return ToString(fRoot);};
+    void PrintCounters() const override;
+
+    /** setters **/
+    void SetTriggerFired(std::function<Bool_t(Trigger *)> val) {fTriggerFired = val;};
+
+    /** checkpoint methods, with the operand order and the state
+	of the operand triggers **/
+    Bool_t SaveState(TDirectory *dir, const TString &prefix) const override;
+    Bool_t LoadState(TDirectory *dir, const TString &prefix) override;
+    
+  protected:
+    
+    /** copy constructor **/
+    TriggerExpression(const TriggerExpression &);
+    /** operator= **/
+    TriggerExpression &operator=(const TriggerExpression &);
+
+    enum ENodeType_t {
+      kLeaf,
+      kAnd,
+      kOr,
+      kNot
+    };
+    
+    struct Node_t {
+      ENodeType_t type;
+      std::string name;
+      Trigger *trigger;
+      TriggerParticles *particles; // null for generator-specific triggers
+      std::vector<Int_t> children;
+      Long64_t calls;
+      Long64_t passed;
+      Long64_t timed; // calls in the timed evaluations
+      Double_t time;  // [s]
+    };
+    
+    /** methods **/
+    Bool_t Evaluate(Int_t inode, const ParticleBuffer &particles, Bool_t timed) const;
+    void Reorder() const;
+    Double_t GetRank(Int_t inode, ENodeType_t parent) const;
+    std::string ToString(Int_t inode) const;
+    Int_t AddNode(ENodeType_t type, const std::string &name = "", Trigger *trigger = nullptr);
+    Int_t ParseOr(const std::vector<std::string> &tokens, size_t &pos, const std::map<std::string, Trigger *> &triggers);
+    Int_t ParseAnd(const std::vector<std::string> &tokens, size_t &pos, const std::map<std::string, Trigger *> &triggers);
+    Int_t ParseNot(const std::vector<std::string> &tokens, size_t &pos, const std::map<std::string, Trigger *> &triggers);
+    
+    /** data members **/
+    mutable std::vector<Node_t> fNodes; //! statistics and operand order change at run time
+    Int_t fRoot;
+    mutable Long64_t fEvaluations;      //!
+    std::vector<Trigger *> fTriggers;   //! owned
+    std::function<Bool_t(Trigger *)> fTriggerFired; //!
+    
+    static const Long64_t fgReorderPeriod = 1000;
+    static const Long64_t fgTimingPeriod = 16; // one evaluation in this many is timed
+    
+  private:
+    
+    Bool_t IsTriggered(const ParticleBuffer &particles) const override;
+
+    ClassDefOverride(TriggerExpression, 1);
+
+  }; /** class TriggerExpression **/
+  
+  /*****************************************************************/
+  /*****************************************************************/
+
+} /** namespace eventgen **/
+} /** namespace o2 **/
+
+#endif /* ALICEO2_EVENTGEN_TRIGGEREXPRESSION_H_ */ 
@@ -12,6 +12,7 @@
 
 #include "TriggerManagerParticle.h"
 #include "ParticleTrigger.h"
+#include <vector>
 
 namespace o2sim
 {
@@ -28,6 +29,9 @@ namespace o2sim
     RegisterValue("pdg_code");
     RegisterValue("pt");
     RegisterValue("rapidity");
+    RegisterValue("eta");
+    RegisterValue("phi");
+    RegisterValue("charge");
   }
 
   /*****************************************************************/
@@ -37,18 +41,26 @@ namespace o2sim
   {
     /** init **/
 
-    Int_t pdg_code;
-    Double_t pt[2], rapidity[2];
+    Double_t pt[2], rapidity[2], eta[2], phi[2];
+    Int_t charge;
 
-    /** pdg code **/
-    if (!GetValue("pdg_code", pdg_code) || pdg_code == 0) {
+    /** pdg codes, one or more **/
+    Int_t npdg = GetValueSize("pdg_code");
+    std::vector<Int_t> pdg_code(npdg);
+    if (npdg == 0 || !GetValue("pdg_code", pdg_code.data(), npdg)) {
+      LOG(ERROR) << "Invalid PDG code" << std::endl;
+      return NULL;
+    }
+    for (auto const &code : pdg_code) {
+      if (code != 0) continue;
       LOG(ERROR) << "Invalid PDG code" << std::endl;
       return NULL;
     }
 
     /** create trigger **/ 
     o2::eventgen::ParticleTrigger *trigger = new o2::eventgen::ParticleTrigger();
-    trigger->SetPdgCode(pdg_code);
+    for (auto const &code : pdg_code)
+      trigger->AddPdgCode(code);
 
     /** setup trigger **/
 
@@ -68,6 +80,33 @@ namespace o2sim
       }
       trigger->SetYRange(rapidity[0], rapidity[1]);
     }
+    /** eta **/
+    if (!IsNull("eta")) {
+      if (!GetValue("eta", eta, 2) || eta[0] > eta[1]) {
+	LOG(ERROR) << "Invalid eta range" << std::endl;
+	return NULL;
+      }
+      trigger->SetEtaRange(eta[0], eta[1]);
+    }
+    /** phi **/
+    if (!IsNull("phi")) {
+      if (!GetValue("phi", phi, 2) || phi[0] > phi[1]) {
+	LOG(ERROR) << "Invalid phi range" << std::endl;
+	return NULL;
+      }
+      trigger->SetPhiRange(phi[0], phi[1]);
+    }
+    /** charge **/
+    if (!IsNull("charge")) {
+      if (!GetValue("charge", charge)) {
+	LOG(ERROR) << "Invalid charge" << std::endl;
+	return NULL;
+      }
+      trigger->SetCharge(charge);
+    }
+
+    /** compile cuts **/
+    trigger->Compile();
 
     /** success **/
     return trigger;
@@ -0,0 +1,111 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See https://alice-o2.web.cern.ch/ for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \author R+Preghenella - September 2017
+
+#include "TriggerParticles.h"
+#include "ParticleBuffer.h"
+#include "FairLogger.h"
+
+namespace o2
+{
+namespace eventgen
+{
+
+  /*****************************************************************/
+  /*****************************************************************/
+
+  TriggerParticles::TriggerParticles() :
+    Trigger(),
+    fScanEvents(0),
+    fScanParticles(0),
+    fScanTriggered(0),
+    fScanTime(0.),
+    fProfileScan(nullptr)
+  {
+    /** default constructor **/
+  }
+
+  /*****************************************************************/
+
+  TriggerParticles::~TriggerParticles()
+  {
+    /** default destructor **/
+  }
+  
+  /*****************************************************************/
+
+  Bool_t
+  TriggerParticles::TriggerEvent(const ParticleBuffer &particles)
+  {
+    /** trigger event **/
+
+    /** check active **/
+    if (!IsActive()) return kFALSE;
+    /* trigger */
+    auto start = fProfileScan ? o2sim::Profiler::Now() : 0;
+    auto triggered = IsTriggered(particles);
+    if (fProfileScan) {
+      auto elapsed = o2sim::Profiler::Now() - start;
+      fScanTime += elapsed * 1.e-9;
+      fProfileScan->Add(1, elapsed);
+    }
+    fScanEvents++;
+    fScanParticles += particles.GetSize();
+    if (!triggered) return kFALSE;
+    fScanTriggered++;
+    /* downscale */
+    if (IsDownscaled()) return kFALSE;
+
+    /** success **/
+    return kTRUE;
+  }
+
+  /*****************************************************************/
+
+  void
+  TriggerParticles::InitProfiling()
+  {
+    /** init profiling **/
+
+    fProfileScan = o2sim::Profiler::Instance().GetEntry(std::string("trigger.") + GetName() + ".scan");
+  }
+
+  /*****************************************************************/
+
+  void
+  TriggerParticles::PrintCounters() const
+  {
+    /** print counters, times are measured only when profiling **/
+
+    if (fScanEvents <= 0) return;
+    if (!fProfileScan) {
+      LOG(INFO) << "Scan counters for \"" << GetName() << "\" trigger:"
+		<< " events = " << fScanEvents
+		<< " | triggered = " << fScanTriggered
+		<< " | particles = " << fScanParticles
+		<< std::endl;
+      return;
+    }
+    LOG(INFO) << "Scan counters for \"" << GetName() << "\" trigger:"
+	      << " events = " << fScanEvents
+	      << " | triggered = " << fScanTriggered
+	      << " | particles = " << fScanParticles
+	      << " | total time = " << fScanTime << " s"
+	      << " | rate = " << fScanEvents / fScanTime << " events/s"
+	      << ", " << fScanParticles / fScanTime << " particles/s"
+	      << std::endl;
+  }
+  
+  /*****************************************************************/
+  /*****************************************************************/
+
+} /* namespace eventgen */
+} /* namespace o2 */
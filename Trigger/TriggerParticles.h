@@ -0,0 +1,85 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See https://alice-o2.web.cern.ch/ for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \author R+Preghenella - September 2017
+
+#ifndef ALICEO2_EVENTGEN_TRIGGERPARTICLES_H_
+#define ALICEO2_EVENTGEN_TRIGGERPARTICLES_H_
+
+#include "Trigger.h"
+#include "Core/Profiler.h"
+
+namespace o2
+{
+namespace eventgen
+{
+
+  class ParticleBuffer;
+  
+  /*****************************************************************/
+  /*****************************************************************/
+
+  /** trigger on the flat particle buffer filled by the generator,
+      independent of the generator interface **/
+  
+  class TriggerParticles : public virtual Trigger
+  {
+    
+  public:
+    
+    /** default constructor **/
+    TriggerParticles();
+    /** destructor **/
+    virtual ~TriggerParticles();
+
+    /** getters **/
+    Long64_t GetScanEvents() const {return fScanEvents;};
+    Long64_t GetScanParticles() const {return fScanParticles;};
+    Long64_t GetScanTriggered() const {return fScanTriggered;};
+    Double_t GetScanTime() const {return fScanTime;};
+    
+    /** methods **/
+    Bool_t TriggerEvent(const ParticleBuffer &particles);
+    virtual void PrintCounters() const;
+    virtual Bool_t UsesParticles() const {return kTRUE;};
+    void InitProfiling();
+    
+  protected:
+    
+    /** copy constructor **/
+    TriggerParticles(const TriggerParticles &);
+    /** operator= **/
+    TriggerParticles &operator=(const TriggerParticles &);
+
+  private:
+
+    /** methods **/
+    virtual Bool_t IsTriggered(const ParticleBuffer &particles) const = 0;
+
+    /** scan counters **/
+    Long64_t fScanEvents;     //! scanned events
+    Long64_t fScanParticles;  //! scanned particles
+    Long64_t fScanTriggered;  //! triggered events
+    Double_t fScanTime;       //! total scan time [s], when profiling
+
+    /** profiling entry, null when profiling is off **/
+    o2sim::Profiler::Entry *fProfileScan;  //!
+    
+    ClassDefOverride(TriggerParticles, 1);
+
+  }; /** class TriggerParticles **/
+  
+  /*****************************************************************/
+  /*****************************************************************/
+
+} /** namespace eventgen **/
+} /** namespace o2 **/
+
+#endif /* ALICEO2_EVENTGEN_TRIGGERPARTICLES_H_ */ 
@@ -19,8 +19,14 @@
 #pragma link C++ class o2::eventgen::Trigger+;
 #pragma link C++ class o2::eventgen::TriggerHepMC+;
 #pragma link C++ class o2::eventgen::TriggerTGenerator+;
+#pragma link C++ class o2::eventgen::TriggerParticles+;
+#pragma link C++ class o2::eventgen::TriggerExpression+;
 #pragma link C++ class o2::eventgen::ParticleTrigger+;
 
+#pragma read sourceClass="o2::eventgen::ParticleTrigger" targetClass="o2::eventgen::ParticleTrigger" version="[1]" \
+  source="Int_t fPdgCode" target="fPdgCodes" \
+  code="{ fPdgCodes.assign(1, onfile.fPdgCode); }"
+
 #pragma link C++ class o2sim::TriggerManagerParticle+;
 
 #endif
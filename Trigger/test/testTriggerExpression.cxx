@@ -0,0 +1,139 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See https://alice-o2.web.cern.ch/ for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \author R+Preghenella - September 2017
+
+#include <iostream>
+#include <string>
+#include <map>
+#include "Trigger/TriggerExpression.h"
+#include "Trigger/ParticleBuffer.h"
+
+/** trigger expression test, operator precedence, short circuit,
+    generator-specific operands and malformed expressions **/
+
+using o2::eventgen::Trigger;
+using o2::eventgen::TriggerParticles;
+using o2::eventgen::TriggerExpression;
+using o2::eventgen::ParticleBuffer;
+
+/*****************************************************************/
+
+/** particle trigger with a fixed decision, counting its calls
+    outside, the expression deletes it **/
+class FixedTrigger : public TriggerParticles
+{
+public:
+  FixedTrigger(Bool_t result, Int_t *calls = nullptr) : Trigger(), TriggerParticles(), fResult(result), fCalls(calls) {};
+private:
+  Bool_t IsTriggered(const ParticleBuffer &particles) const override {if (fCalls) (*fCalls)++; return fResult;};
+  Bool_t fResult;
+  Int_t *fCalls;
+};
+
+/** generator-specific trigger, decided by the trigger-fired function **/
+class GeneratorTrigger : public Trigger
+{
+public:
+  GeneratorTrigger() : Trigger() {};
+};
+
+Int_t gFailures = 0;
+
+/*****************************************************************/
+
+void
+check(Bool_t condition, const std::string &what)
+{
+  /** check **/
+
+  if (condition) return;
+  std::cout << "FAILED: " << what << std::endl;
+  gFailures++;
+}
+
+/*****************************************************************/
+
+Bool_t
+evaluate(const std::string &expression, const std::map<std::string, Bool_t> &results,
+	 std::map<std::string, Int_t> *calls = nullptr, std::string *str = nullptr)
+{
+  /** evaluate the expression once on fixed triggers **/
+
+  std::map<std::string, Trigger *> leaves;
+  for (auto const &x : results)
+    leaves[x.first] = new FixedTrigger(x.second, calls ? &(*calls)[x.first] : nullptr);
+  TriggerExpression triggerExpression;
+  if (!triggerExpression.Parse(expression, leaves)) {
+    check(kFALSE, "parse \"" + expression + "\"");
+    return kFALSE;
+  }
+  if (str) *str = triggerExpression.ToString();
+  ParticleBuffer particles;
+  return triggerExpression.TriggerEvent(particles);
+}
+
+/*****************************************************************/
+
+int
+main (Int_t argc, char **argv)
+{
+
+  std::string str;
+  
+  /** precedence, NOT over AND over OR **/
+  check(evaluate("a OR b AND c", {{"a", kTRUE}, {"b", kFALSE}, {"c", kFALSE}}, nullptr, &str), "AND binds tighter than OR");
+  check(str == "(a OR (b AND c))", "tree of \"a OR b AND c\": " + str);
+  check(!evaluate("NOT a AND b", {{"a", kFALSE}, {"b", kFALSE}}, nullptr, &str), "NOT binds tighter than AND");
+  check(str == "(NOT a AND b)", "tree of \"NOT a AND b\": " + str);
+  check(!evaluate("(a OR b) AND c", {{"a", kTRUE}, {"b", kFALSE}, {"c", kFALSE}}), "parentheses");
+  check(evaluate("NOT NOT a", {{"a", kTRUE}}), "double NOT");
+  check(evaluate("a or b and not c", {{"a", kFALSE}, {"b", kTRUE}, {"c", kFALSE}}), "lower-case operators");
+
+  /** short circuit **/
+  std::map<std::string, Int_t> calls;
+  check(evaluate("a OR b", {{"a", kTRUE}, {"b", kTRUE}}, &calls), "OR result");
+  check(calls["a"] == 1 && calls["b"] == 0, "OR stops at the first passing operand");
+  calls.clear();
+  check(!evaluate("a AND b", {{"a", kFALSE}, {"b", kTRUE}}, &calls), "AND result");
+  check(calls["a"] == 1 && calls["b"] == 0, "AND stops at the first failing operand");
+  calls.clear();
+  check(!evaluate("a AND b OR c AND d", {{"a", kFALSE}, {"b", kTRUE}, {"c", kFALSE}, {"d", kTRUE}}, &calls), "nested result");
+  check(calls["b"] == 0 && calls["d"] == 0, "nested short circuit");
+
+  /** generator-specific operands go through the trigger-fired function **/
+  {
+    auto generatorTrigger = new GeneratorTrigger();
+    std::map<std::string, Trigger *> leaves = {{"gen", generatorTrigger}, {"a", new FixedTrigger(kTRUE)}};
+    TriggerExpression triggerExpression;
+    check(triggerExpression.Parse("a AND gen", leaves), "parse generator-specific operand");
+    Int_t fired = 0;
+    triggerExpression.SetTriggerFired([&fired, generatorTrigger](Trigger *trigger) {fired++; return trigger == generatorTrigger;});
+    ParticleBuffer particles;
+    check(triggerExpression.TriggerEvent(particles) && fired == 1, "generator-specific operand");
+  }
+  
+  /** malformed expressions **/
+  for (auto const &expression : {"", "a AND", "OR a", "(a OR b", "a OR b)", "a b", "NOT", "()", "a AND unknown", "a AND AND b"}) {
+    std::map<std::string, Trigger *> leaves = {{"a", new FixedTrigger(kTRUE)}, {"b", new FixedTrigger(kTRUE)}};
+    TriggerExpression triggerExpression;
+    check(!triggerExpression.Parse(expression, leaves), std::string("reject \"") + expression + "\"");
+    ParticleBuffer particles;
+    check(!triggerExpression.TriggerEvent(particles), std::string("no trigger from \"") + expression + "\"");
+  }
+
+  /** summary **/
+  if (gFailures > 0) {
+    std::cout << "testTriggerExpression: " << gFailures << " failures" << std::endl;
+    return 1;
+  }
+  std::cout << "testTriggerExpression: success" << std::endl;
+  return 0;
+}
@@ -0,0 +1,140 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See https://alice-o2.web.cern.ch/ for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \author R+Preghenella - September 2017
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include "Trigger/ParticleBuffer.h"
+
+/** particle boost benchmark, the structure-of-arrays kernel of
+    the particle buffer against a per-particle boost over an
+    array of particles that computes the hyperbolic functions
+    for each momentum and each production point. the events are
+    boosted back and forth so that the values stay bounded **/
+
+using Clock = std::chrono::steady_clock;
+
+/** particle as an array-of-structures element **/
+struct Particle
+{
+  Double_t px, py, pz, e, vx, vy, vz, vt;
+};
+
+/*****************************************************************/
+
+void
+boostParticle(Particle &particle, Double_t boost)
+{
+  /** per-particle boost along z **/
+
+  const Double_t c = 2.99792458e10; // [cm/s]
+  auto pz = particle.pz * std::cosh(boost) - particle.e * std::sinh(boost);
+  auto e = particle.e * std::cosh(boost) - particle.pz * std::sinh(boost);
+  auto vz = particle.vz * std::cosh(boost) - particle.vt * c * std::sinh(boost);
+  auto vt = particle.vt * std::cosh(boost) - particle.vz / c * std::sinh(boost);
+  particle.pz = pz;
+  particle.e = e;
+  particle.vz = vz;
+  particle.vt = vt;
+}
+
+/*****************************************************************/
+
+void
+report(const std::string &mode, Long64_t particles, Double_t elapsed, Double_t checksum)
+{
+  /** report **/
+
+  std::cout << "  " << mode
+	    << " | particles = " << particles
+	    << " | time = " << elapsed << " s"
+	    << " | rate = " << particles / elapsed << " particles/s"
+	    << " | checksum = " << checksum
+	    << std::endl;
+}
+
+/*****************************************************************/
+
+int
+main (Int_t argc, char **argv)
+{
+
+  /** process arguments **/
+  if (argc < 4) {
+    std::cout << "usage: ro2sim-boost-bench [nParticles per event] [nEvents] [rapidity boost]" << std::endl;
+    return 1;
+  }
+  Int_t nparticles = std::stoi(argv[1]);
+  Long64_t nevents = std::stoll(argv[2]);
+  Double_t boost = std::stod(argv[3]);
+  if (nparticles <= 0 || nevents <= 0 || std::abs(boost) < 1.e-6) {
+    std::cout << "Invalid arguments: particles and events must be positive, the boost not zero" << std::endl;
+    return 1;
+  }
+  std::cout << "Particle boost benchmark | particles = " << nparticles
+	    << " per event | events = " << nevents
+	    << " | boost = " << boost << std::endl;
+
+  /** the same random particles in both layouts **/
+  std::mt19937_64 engine(12345);
+  std::uniform_real_distribution<Double_t> momentum(-10., 10.), vertex(-1., 1.), time(0., 1.e-9);
+  o2::eventgen::ParticleBuffer buffer;
+  std::vector<Particle> particles(nparticles);
+  buffer.Reserve(nparticles);
+  for (auto &particle : particles) {
+    particle.px = momentum(engine);
+    particle.py = momentum(engine);
+    particle.pz = momentum(engine);
+    particle.e = std::sqrt(particle.px * particle.px + particle.py * particle.py + particle.pz * particle.pz + 0.0195);
+    particle.vx = vertex(engine);
+    particle.vy = vertex(engine);
+    particle.vz = vertex(engine);
+    particle.vt = time(engine);
+    buffer.AddParticle(211, 1,
+		       particle.px, particle.py, particle.pz, particle.e,
+		       particle.vx, particle.vy, particle.vz, particle.vt,
+		       -1, kTRUE);
+  }
+  Long64_t total = nevents * nparticles;
+
+  /** structure-of-arrays kernel **/
+  {
+    auto start = Clock::now();
+    for (Long64_t ievent = 0; ievent < nevents; ievent++)
+      buffer.Boost(ievent % 2 ? -boost : boost);
+    std::chrono::duration<Double_t> elapsed = Clock::now() - start;
+    Double_t checksum = 0.;
+    for (Int_t i = 0; i < nparticles; i++)
+      checksum += buffer.Pz()[i] + buffer.Vz()[i];
+    report("structure-of-arrays", total, elapsed.count(), checksum);
+  }
+
+  /** per-particle boost **/
+  {
+    auto start = Clock::now();
+    for (Long64_t ievent = 0; ievent < nevents; ievent++) {
+      auto sign = ievent % 2 ? -boost : boost;
+      for (auto &particle : particles)
+	boostParticle(particle, sign);
+    }
+    std::chrono::duration<Double_t> elapsed = Clock::now() - start;
+    Double_t checksum = 0.;
+    for (const auto &particle : particles)
+      checksum += particle.pz + particle.vz;
+    report("per-particle       ", total, elapsed.count(), checksum);
+  }
+
+  return 0;
+}
@@ -0,0 +1,392 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See https://alice-o2.web.cern.ch/ for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \author R+Preghenella - September 2017
+
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <sstream>
+#include <random>
+#include <cerrno>
+#include <csignal>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include "Pythia8/Pythia.h"
+#include "THijing.h"
+#include "TClonesArray.h"
+#include "TParticle.h"
+#include "TRandom.h"
+#include "Generator/SharedMemoryRing.h"
+#include "Generator/GeneratorDaemon.h"
+#include "Generator/GeneratorManagerHijing.h"
+
+/** local generator server. each configuration is held by a
+    forked process that initialises the generator once, so that a
+    slow initialisation does not block the other clients. the server
+    passes each request to the holder of its configuration, which
+    serves it from a forked copy that reseeds the generator and
+    streams its events into the requested shared-memory ring until
+    the reader goes away. the server exits after being idle for a
+    while, the holders exit when the server closes their channel **/
+
+using o2::eventgen::SharedMemoryRing;
+using o2::eventgen::GeneratorDaemon;
+
+/*****************************************************************/
+
+/** initialised generator held by the server **/
+class Backend
+{
+public:
+  virtual ~Backend() {};
+  virtual Bool_t Init(const std::string &config) = 0;
+  virtual void Seed(UInt_t seed) = 0;
+  virtual Bool_t Next(SharedMemoryRing::EventHeader_t &header,
+		      std::vector<SharedMemoryRing::ParticleRecord_t> &particles) = 0;
+};
+
+/*****************************************************************/
+
+class BackendPythia8 : public Backend
+{
+public:
+  
+  Bool_t Init(const std::string &config) override
+  {
+    /** read settings line by line and init **/
+    std::istringstream lines(config);
+    std::string line;
+    while (std::getline(lines, line))
+      if (!fPythia.readString(line)) return kFALSE;
+    return fPythia.init();
+  }
+
+  void Seed(UInt_t seed) override
+  {
+    /** the random engine is restarted after initialisation **/
+    fPythia.rndm.init(seed % 900000000);
+  }
+
+  Bool_t Next(SharedMemoryRing::EventHeader_t &header,
+	      std::vector<SharedMemoryRing::ParticleRecord_t> &particles) override
+  {
+    if (!fPythia.next()) return kFALSE;
+    
+    /** pack particles, skipping the system entry **/
+    auto const &event = fPythia.event;
+    particles.resize(event.size() - 1);
+    for (Int_t ipart = 1; ipart < event.size(); ipart++) {
+      auto const &particle = event[ipart];
+      auto &record = particles[ipart - 1];
+      record.pdg = particle.id();
+      record.status = particle.statusHepMC();
+      record.mother = particle.mother1() - 1;
+      record.reserved = 0;
+      record.px = particle.px();
+      record.py = particle.py();
+      record.pz = particle.pz();
+      record.e = particle.e();
+      record.vx = particle.xProd();
+      record.vy = particle.yProd();
+      record.vz = particle.zProd();
+      record.vt = particle.tProd();
+    }
+
+    /** header **/
+    header.nParticles = particles.size();
+    header.flags = SharedMemoryRing::kCrossSection;
+    header.crossSection = fPythia.info.sigmaGen() * 1.e9; // [mb -> pb]
+    header.crossSectionError = fPythia.info.sigmaErr() * 1.e9; // [mb -> pb]
+    header.acceptedEvents = fPythia.info.nAccepted();
+    header.attemptedEvents = fPythia.info.nTried();
+    return kTRUE;
+  }
+
+private:
+  Pythia8::Pythia fPythia;
+};
+
+/*****************************************************************/
+
+class BackendHijing : public Backend
+{
+public:
+
+  BackendHijing() : fHijing(NULL), fParticles(new TClonesArray("TParticle", 1000)) {};
+  ~BackendHijing() {delete fHijing; delete fParticles;};
+  
+  Bool_t Init(const std::string &config) override
+  {
+    /** seeded for each request **/
+    fHijing = o2sim::GeneratorManagerHijing::CreateHijing(config);
+    return fHijing != NULL;
+  }
+
+  void Seed(UInt_t seed) override
+  {
+    /** THijing draws from gRandom **/
+    gRandom->SetSeed(seed);
+  }
+
+  Bool_t Next(SharedMemoryRing::EventHeader_t &header,
+	      std::vector<SharedMemoryRing::ParticleRecord_t> &particles) override
+  {
+    fHijing->GenerateEvent();
+    fHijing->ImportParticles(fParticles, "All");
+
+    /** pack particles, THijing positions are in [mm] and times in [mm/c] **/
+    Int_t nParticles = fParticles->GetEntries();
+    particles.resize(nParticles);
+    for (Int_t ipart = 0; ipart < nParticles; ipart++) {
+      auto particle = (TParticle *)fParticles->UncheckedAt(ipart);
+      auto &record = particles[ipart];
+      record.pdg = particle->GetPdgCode();
+      record.status = particle->GetStatusCode();
+      record.mother = particle->GetMother(0);
+      record.reserved = 0;
+      record.px = particle->Px();
+      record.py = particle->Py();
+      record.pz = particle->Pz();
+      record.e = particle->Energy();
+      record.vx = particle->Vx();
+      record.vy = particle->Vy();
+      record.vz = particle->Vz();
+      record.vt = particle->T();
+    }
+
+    /** header **/
+    header.nParticles = particles.size();
+    header.flags = 0;
+    return kTRUE;
+  }
+
+private:
+  THijing *fHijing;
+  TClonesArray *fParticles;
+};
+
+/*****************************************************************/
+
+Backend *
+CreateBackend(const std::string &kind)
+{
+  if (kind == "pythia8") return new BackendPythia8();
+  if (kind == "hijing") return new BackendHijing();
+  return NULL;
+}
+
+/*****************************************************************/
+
+/** consecutive failed events after which a writer gives up **/
+const Int_t kMaxFailures = 1000;
+
+void
+Serve(Int_t client, Backend *backend, const GeneratorDaemon::Request_t &request, Bool_t reused, Int_t attachTimeout)
+{
+  /** serve a request, runs in the forked copy **/
+
+  /** reseed, the server has drawn a seed if none was given **/
+  backend->Seed(request.seed);
+
+  /** create ring, then tell the client it can attach **/
+  SharedMemoryRing ring;
+  if (!ring.Create(request.shmName, request.shmSize, attachTimeout)) {
+    GeneratorDaemon::WriteReply(client, GeneratorDaemon::kStatusInitFailed, reused);
+    close(client);
+    return;
+  }
+  GeneratorDaemon::WriteReply(client, GeneratorDaemon::kStatusOK, reused);
+  close(client);
+
+  /** event loop, write fails when the reader is gone
+      or when it did not attach in time **/
+  SharedMemoryRing::EventHeader_t header;
+  std::vector<SharedMemoryRing::ParticleRecord_t> particles;
+  Int_t nfailures = 0;
+  for (Long64_t iev = 0; ; ) {
+    if (!backend->Next(header, particles)) {
+      if (++nfailures < kMaxFailures) continue;
+      std::cout << "Generator failed " << nfailures << " consecutive events, stopping writer " << getpid() << std::endl;
+      break;
+    }
+    nfailures = 0;
+    header.number = iev++;
+    if (!ring.WriteEvent(header, particles.data())) break;
+  }
+
+  /** done **/
+  ring.SetWriterDone();
+  ring.Close();
+}
+
+/*****************************************************************/
+
+void
+Hold(Int_t channel, const GeneratorDaemon::Request_t &first, const std::string &config, Int_t attachTimeout)
+{
+  /** hold a generator, runs in the forked holder. requests come
+      from the server over the channel, each served by a fork **/
+
+  std::string kind = first.kind;
+  auto backend = CreateBackend(kind);
+  Bool_t initialised = backend && backend->Init(config);
+  if (!initialised) {
+    /** fail the queued requests, the server then starts a new holder **/
+    std::cout << "Failed initialising " << kind << " generator" << std::endl;
+    fcntl(channel, F_SETFL, O_NONBLOCK);
+  }
+
+  /** request loop, ends when the server closes the channel **/
+  while (true) {
+    GeneratorDaemon::Request_t request;
+    Bool_t reused;
+    Int_t client = GeneratorDaemon::ReceiveClient(channel, request, reused);
+    if (client < 0) break;
+    if (!initialised) {
+      GeneratorDaemon::WriteReply(client, GeneratorDaemon::kStatusInitFailed, kFALSE);
+      close(client);
+      continue;
+    }
+    Int_t pid = fork();
+    if (pid < 0) {
+      GeneratorDaemon::WriteReply(client, GeneratorDaemon::kStatusForkFailed, reused);
+      close(client);
+      continue;
+    }
+    if (pid == 0) {
+      close(channel);
+      Serve(client, backend, request, reused, attachTimeout);
+      _exit(0);
+    }
+    std::cout << "Request for " << kind << " generator served by process " << pid
+	      << (reused ? " (reused)" : "") << std::endl;
+    close(client);
+  }
+  delete backend;
+}
+
+/*****************************************************************/
+
+int
+main (Int_t argc, char **argv)
+{
+
+  /** process arguments **/
+  if (argc > 1 && std::string(argv[1]) == "--help") {
+    std::cout << "usage: ro2sim-gend [socketName] [idleTimeout (s)] [maxGenerators] [attachTimeout (s)]" << std::endl;
+    return 1;
+  }
+  std::string name = argc > 1 ? argv[1] : GeneratorDaemon::GetSocketName();
+  Int_t timeout = argc > 2 ? std::stoi(argv[2]) : 3600;
+  Int_t maxGenerators = argc > 3 ? std::stoi(argv[3]) : 8;
+  Int_t attachTimeout = argc > 4 ? std::stoi(argv[4]) : 60;
+
+  /** holders and writers are not waited for, clients may go away **/
+  signal(SIGCHLD, SIG_IGN);
+  signal(SIGPIPE, SIG_IGN);
+  
+  /** listen **/
+  Int_t lock = -1;
+  Int_t fd = GeneratorDaemon::Listen(name, lock);
+  if (fd < 0) return 1;
+  std::cout << "Generator server listening on " << name << std::endl;
+
+  /** channels to the generator holders and their last use **/
+  std::map<ULong64_t, std::pair<Int_t, Long64_t>> holders;
+  Long64_t nrequests = 0;
+  std::random_device entropy;
+  
+  /** request loop **/
+  while (true) {
+    struct pollfd pfd = {fd, POLLIN, 0};
+    Int_t n = poll(&pfd, 1, timeout * 1000);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) break;
+    Int_t client = accept(fd, NULL, NULL);
+    if (client < 0) continue;
+
+    /** read request **/
+    GeneratorDaemon::Request_t request;
+    std::string config;
+    if (!GeneratorDaemon::ReadRequest(client, request, config)) {
+      GeneratorDaemon::WriteReply(client, GeneratorDaemon::kStatusBadRequest, kFALSE);
+      close(client);
+      continue;
+    }
+    auto key = request.hash;
+
+    /** each writer is reseeded, unseeded requests get a seed of
+	their own not to repeat the events of the initialised state **/
+    while (request.seed == 0) request.seed = entropy();
+
+    /** pass the request to the holder, a new holder is started if
+	there is none or if the channel is gone after a failed init **/
+    Bool_t sent = kFALSE, reused = kFALSE;
+    for (Int_t itry = 0; itry < 2 && !sent; itry++) {
+      auto it = holders.find(key);
+      reused = it != holders.end();
+      if (!reused) {
+	/** drop the least recently used holder **/
+	if ((Int_t)holders.size() >= maxGenerators) {
+	  auto lru = holders.begin();
+	  for (auto jt = holders.begin(); jt != holders.end(); ++jt)
+	    if (jt->second.second < lru->second.second) lru = jt;
+	  close(lru->second.first);
+	  holders.erase(lru);
+	}
+	Int_t channel[2];
+	if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, channel) < 0) break;
+	Int_t pid = fork();
+	if (pid < 0) {
+	  close(channel[0]);
+	  close(channel[1]);
+	  break;
+	}
+	if (pid == 0) {
+	  /** the holder keeps only its own channel **/
+	  close(fd);
+	  close(lock);
+	  close(client);
+	  close(channel[0]);
+	  for (auto &x : holders) close(x.second.first);
+	  Hold(channel[1], request, config, attachTimeout);
+	  _exit(0);
+	}
+	close(channel[1]);
+	std::cout << "Initialising " << request.kind << " generator " << std::hex << key << std::dec
+		  << " in process " << pid << std::endl;
+	it = holders.insert({key, {channel[0], 0}}).first;
+      }
+      it->second.second = nrequests;
+      sent = GeneratorDaemon::SendClient(it->second.first, client, request, reused);
+      if (!sent) {
+	close(it->second.first);
+	holders.erase(it);
+      }
+    }
+    if (!sent) GeneratorDaemon::WriteReply(client, GeneratorDaemon::kStatusForkFailed, kFALSE);
+    nrequests++;
+    close(client);
+  }
+
+  /** idle, done **/
+  std::cout << "Generator server idle for " << timeout << " s, exiting" << std::endl;
+  close(fd);
+  unlink(name.c_str());
+  for (auto &x : holders) close(x.second.first);
+  close(lock);
+  return 0;
+}
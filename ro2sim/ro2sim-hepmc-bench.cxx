@@ -0,0 +1,162 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See https://alice-o2.web.cern.ch/ for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \author R+Preghenella - September 2017
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <sys/stat.h>
+
+#include "HepMC/Reader.h"
+#include "HepMC/GenEvent.h"
+#include "Generator/DecompressionBuffer.h"
+#include "Generator/HepMCFile.h"
+#include "Generator/ReaderQueue.h"
+
+/** HepMC input benchmark, the same sample converted to several
+    formats (ascii, ROOT tree, native, compressed or not) with
+    ro2sim-hepmc-convert is read with the synchronous reader and
+    with the read-ahead queue. a fixed busy time per event stands
+    in for the transport, which the read-ahead can overlap with **/
+
+using Clock = std::chrono::steady_clock;
+
+/*****************************************************************/
+
+void
+consume(const HepMC::GenEvent &event, Double_t work, Long64_t &particles)
+{
+  /** consume event, spinning for the given time [us] **/
+
+  particles += event.particles().size();
+  auto end = Clock::now() + std::chrono::duration<Double_t, std::micro>(work);
+  while (Clock::now() < end);
+}
+
+/*****************************************************************/
+
+void
+report(const std::string &mode, Long64_t events, Long64_t particles, Double_t elapsed)
+{
+  /** report **/
+
+  std::cout << "  " << mode
+	    << " | events = " << events
+	    << " | particles = " << particles
+	    << " | time = " << elapsed << " s"
+	    << " | rate = " << events / elapsed << " events/s"
+	    << std::endl;
+}
+
+/*****************************************************************/
+
+Bool_t
+bench(const std::string &filename, Long64_t nevents, Double_t work, Int_t depth)
+{
+  /** benchmark one file **/
+
+  struct stat info;
+  if (stat(filename.c_str(), &info) != 0) {
+    std::cout << "Cannot access input file: " << filename << std::endl;
+    return kFALSE;
+  }
+  if (!S_ISREG(info.st_mode)) {
+    std::cout << "Input is read twice, not a regular file: " << filename << std::endl;
+    return kFALSE;
+  }
+  auto type = o2::eventgen::HepMCFile::DetectFileType(filename);
+  auto compression = o2::eventgen::DecompressionBuffer::Detect(filename);
+  std::cout << filename << " | format = " << o2::eventgen::HepMCFile::GetFileTypeName(type)
+	    << " | compression = " << o2::eventgen::DecompressionBuffer::GetCompressionName(compression)
+	    << " | size = " << info.st_size / 1048576. << " MB" << std::endl;
+
+  /** parsing in the calling thread **/
+  {
+    o2::eventgen::HepMCFile file;
+    HepMC::Reader *reader = file.CreateReader(filename);
+    if (!reader) return kFALSE;
+    HepMC::GenEvent event;
+    Long64_t events = 0, particles = 0;
+    Bool_t complete = kFALSE;
+    auto start = Clock::now();
+    for (; nevents < 0 || events < nevents; events++) {
+      event.clear();
+      reader->read_event(event);
+      if (reader->failed()) {
+	complete = kTRUE;
+	break;
+      }
+      consume(event, work, particles);
+    }
+    std::chrono::duration<Double_t> elapsed = Clock::now() - start;
+    reader->close();
+    delete reader;
+    report("synchronous", events, particles, elapsed.count());
+    if (complete && events > 0)
+      std::cout << "  size per event = " << (Double_t)info.st_size / events << " bytes" << std::endl;
+  }
+
+  /** parsing in the reader thread **/
+  {
+    o2::eventgen::HepMCFile file;
+    HepMC::Reader *reader = file.CreateReader(filename);
+    if (!reader) return kFALSE;
+    o2::eventgen::ReaderQueue queue(reader, depth);
+    HepMC::GenEvent *event = NULL;
+    Long64_t events = 0, particles = 0;
+    auto start = Clock::now();
+    queue.Start();
+    for (; nevents < 0 || events < nevents; events++) {
+      event = queue.Next(event);
+      if (!event) break;
+      consume(*event, work, particles);
+    }
+    std::chrono::duration<Double_t> elapsed = Clock::now() - start;
+    queue.Stop();
+    reader->close();
+    delete reader;
+    report("read-ahead ", events, particles, elapsed.count());
+    std::cout << "  read-ahead | average fill level = " << queue.GetFillLevel()
+	      << " | stalls = " << queue.GetStalls()
+	      << " | stall time = " << queue.GetStallTime() << " s"
+	      << " | read time = " << queue.GetReadTime() << " s"
+	      << std::endl;
+  }
+
+  /** success **/
+  return kTRUE;
+}
+
+/*****************************************************************/
+
+int
+main (Int_t argc, char **argv)
+{
+
+  /** process arguments **/
+  if (argc < 5) {
+    std::cout << "usage: ro2sim-hepmc-bench [nEvents (-1 = all)] [work per event (us)] [readAhead] [fileName] [fileName ...]" << std::endl;
+    return 1;
+  }
+  Long64_t nevents = std::stoll(argv[1]);
+  Double_t work = std::stod(argv[2]);
+  Int_t depth = std::stoi(argv[3]);
+  std::vector<std::string> filenames(argv + 4, argv + argc);
+  std::cout << "HepMC input benchmark | work = " << work << " us/event | read-ahead = " << depth << std::endl;
+
+  /** loop over files **/
+  Int_t retval = 0;
+  for (const auto &filename : filenames)
+    if (!bench(filename, nevents, work, depth)) retval = 1;
+
+  return retval;
+}
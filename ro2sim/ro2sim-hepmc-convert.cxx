@@ -0,0 +1,112 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See https://alice-o2.web.cern.ch/ for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \author R+Preghenella - September 2017
+
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <sys/stat.h>
+
+#include "HepMC/GenEvent.h"
+#include "HepMC/Reader.h"
+#include "HepMC/WriterAscii.h"
+#ifdef O2SIM_WITH_HEPMC3_ROOTIO
+#include "HepMC/WriterRootTree.h"
+#endif
+#include "Generator/HepMCFile.h"
+#include "Generator/WriterNative.h"
+
+/** HepMC event converter, any input read by ro2sim is written as
+    HepMC3 ascii (.hepmc), HepMC3 ROOT tree (.root) or in the native
+    columnar format (any other extension). the native output can be
+    compressed afterwards with gzip, zstd or xz **/
+
+/*****************************************************************/
+
+Bool_t
+endsWith(const std::string &value, const std::string &ending)
+{
+  /** ends with **/
+
+  return value.size() >= ending.size() && value.compare(value.size() - ending.size(), ending.size(), ending) == 0;
+}
+
+/*****************************************************************/
+
+int
+main (Int_t argc, char **argv)
+{
+
+  /** process arguments **/
+  if (argc < 3) {
+    std::cout << "usage: ro2sim-hepmc-convert [inputFileName] [outputFileName] [nEvents (-1 = all)] [eventsPerBlock]" << std::endl;
+    return 1;
+  }
+  std::string input = argv[1];
+  std::string output = argv[2];
+  Long64_t nevents = argc > 3 ? std::stoll(argv[3]) : -1;
+  UInt_t blockSize = argc > 4 ? std::stoul(argv[4]) : 256;
+
+  /** open input **/
+  o2::eventgen::HepMCFile file;
+  auto reader = file.CreateReader(input);
+  if (!reader || reader->failed()) {
+    std::cout << "Cannot read input file: " << input << std::endl;
+    return 1;
+  }
+
+  /** open output according to the extension **/
+  HepMC::Writer *writer = NULL;
+  if (endsWith(output, ".root")) {
+#ifdef O2SIM_WITH_HEPMC3_ROOTIO
+    writer = new HepMC::WriterRootTree(output);
+#else
+    std::cout << "Cannot write HepMC3 ROOT tree output, built without HepMC3 ROOT I/O: " << output << std::endl;
+    return 1;
+#endif
+  }
+  else if (endsWith(output, ".hepmc") || endsWith(output, ".hepmc3")) writer = new HepMC::WriterAscii(output);
+  else writer = new o2::eventgen::WriterNative(output, blockSize);
+  if (writer->failed()) {
+    std::cout << "Cannot write output file: " << output << std::endl;
+    return 1;
+  }
+
+  /** event loop **/
+  HepMC::GenEvent event;
+  Long64_t events = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (; nevents < 0 || events < nevents; events++) {
+    event.clear();
+    reader->read_event(event);
+    if (reader->failed()) break;
+    writer->write_event(event);
+    if (writer->failed()) {
+      std::cout << "Failed writing event " << events << " to output file: " << output << std::endl;
+      return 1;
+    }
+  }
+  writer->close();
+  reader->close();
+  delete writer;
+  delete reader;
+  std::chrono::duration<Double_t> elapsed = std::chrono::steady_clock::now() - start;
+
+  /** summary **/
+  struct stat inputInfo, outputInfo;
+  stat(input.c_str(), &inputInfo);
+  stat(output.c_str(), &outputInfo);
+  std::cout << "Converted " << events << " events in " << elapsed.count() << " s: "
+	    << input << " (" << o2::eventgen::HepMCFile::GetFileTypeName(file.GetFileType()) << ", " << inputInfo.st_size << " bytes) -> "
+	    << output << " (" << outputInfo.st_size << " bytes)" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,173 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See https://alice-o2.web.cern.ch/ for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \author R+Preghenella - September 2017
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <cstdio>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "Pythia8/Pythia.h"
+#include "HepMC/GenEvent.h"
+#include "HepMC/ReaderAsciiHepMC2.h"
+#include "HepMC/WriterAsciiHepMC2.h"
+#include "Generator/SharedMemoryRing.h"
+#include "Generator/ReaderSharedMemory.h"
+
+/** Pythia8 interface benchmark, the same Pythia8 events are sent
+    through the HepMC2 ascii fifo and through the shared-memory
+    ring, writer and reader in separate threads as with the
+    interface process. the events are generated beforehand, the
+    rate is that of the event channel alone **/
+
+using Clock = std::chrono::steady_clock;
+using Record = o2::eventgen::SharedMemoryRing::ParticleRecord_t;
+
+/*****************************************************************/
+
+void
+pack(const Pythia8::Event &event, std::vector<Record> &particles)
+{
+  /** pack particles, skipping the system entry **/
+
+  particles.resize(event.size() - 1);
+  for (Int_t ipart = 1; ipart < event.size(); ipart++) {
+    auto const &particle = event[ipart];
+    auto &record = particles[ipart - 1];
+    record.pdg = particle.id();
+    record.status = particle.statusHepMC();
+    record.mother = particle.mother1() - 1;
+    record.reserved = 0;
+    record.px = particle.px();
+    record.py = particle.py();
+    record.pz = particle.pz();
+    record.e = particle.e();
+    record.vx = particle.xProd();
+    record.vy = particle.yProd();
+    record.vz = particle.zProd();
+    record.vt = particle.tProd();
+  }
+}
+
+/*****************************************************************/
+
+void
+report(const std::string &mode, Long64_t events, Long64_t particles, Double_t elapsed)
+{
+  /** report **/
+
+  std::cout << mode
+	    << " | events = " << events
+	    << " | particles = " << particles
+	    << " | time = " << elapsed << " s"
+	    << " | rate = " << events / elapsed << " events/s"
+	    << std::endl;
+}
+
+/*****************************************************************/
+
+int
+main (Int_t argc, char **argv)
+{
+
+  /** process arguments **/
+  if (argc < 2) {
+    std::cout << "usage: ro2sim-pythia8-bench [configFileName] [nEvents] [shmSize (MB)]" << std::endl;
+    return 1;
+  }
+  std::string config = argv[1];
+  Int_t nevents = argc > 2 ? std::stoi(argv[2]) : 1000;
+  ULong64_t size = argc > 3 ? std::stoull(argv[3]) : 64;
+
+  /** generate events **/
+  Pythia8::Pythia pythia;
+  if (!pythia.readFile(config) || !pythia.init()) {
+    std::cout << "Failed to initialise Pythia8 with configuration: " << config << std::endl;
+    return 1;
+  }
+  std::vector<std::vector<Record>> events;
+  for (Int_t iev = 0; (Int_t)events.size() < nevents && iev < 10 * nevents; iev++) {
+    if (!pythia.next()) continue;
+    events.emplace_back();
+    pack(pythia.event, events.back());
+  }
+  std::cout << "Pythia8 interface benchmark | events = " << events.size() << std::endl;
+
+  /** HepMC2 ascii through a fifo, as written by the wrapper script **/
+  {
+    std::string fifoName = "o2sim.bench." + std::to_string(getpid()) + ".fifo";
+    if (mkfifo(fifoName.c_str(), 0600) < 0) {
+      std::cout << "Could not create fifo: " << fifoName << std::endl;
+      return 1;
+    }
+    auto start = Clock::now();
+    std::thread writer([&events, &fifoName] {
+	HepMC::WriterAsciiHepMC2 output(fifoName);
+	HepMC::GenEvent event;
+	std::vector<HepMC::GenParticlePtr> particles;
+	for (size_t iev = 0; iev < events.size(); iev++) {
+	  event.clear();
+	  event.set_units(HepMC::Units::GEV, HepMC::Units::MM);
+	  event.set_event_number(iev);
+	  o2::eventgen::ReaderSharedMemory::FillParticles(event, events[iev], particles);
+	  output.write_event(event);
+	}
+	output.close();
+      });
+    HepMC::ReaderAsciiHepMC2 input(fifoName);
+    HepMC::GenEvent event;
+    Long64_t nread = 0, nparticles = 0;
+    while (input.read_event(event) && !input.failed()) {
+      nread++;
+      nparticles += event.particles().size();
+    }
+    writer.join();
+    input.close();
+    std::chrono::duration<Double_t> elapsed = Clock::now() - start;
+    std::remove(fifoName.c_str());
+    report("fifo, HepMC2 ascii  ", nread, nparticles, elapsed.count());
+  }
+
+  /** packed records through the shared-memory ring **/
+  {
+    std::string shmName = "/o2sim.bench." + std::to_string(getpid());
+    auto start = Clock::now();
+    std::thread writer([&events, &shmName, size] {
+	o2::eventgen::SharedMemoryRing ring;
+	if (!ring.Create(shmName, size * 1024 * 1024)) return;
+	o2::eventgen::SharedMemoryRing::EventHeader_t header = {};
+	for (size_t iev = 0; iev < events.size(); iev++) {
+	  header.number = iev;
+	  header.nParticles = events[iev].size();
+	  if (!ring.WriteEvent(header, events[iev].data())) break;
+	}
+	ring.SetWriterDone();
+	ring.Close();
+      });
+    o2::eventgen::ReaderSharedMemory input(shmName);
+    HepMC::GenEvent event;
+    Long64_t nread = 0, nparticles = 0;
+    while (input.read_event(event) && !input.failed()) {
+      nread++;
+      nparticles += event.particles().size();
+    }
+    writer.join();
+    input.close();
+    std::chrono::duration<Double_t> elapsed = Clock::now() - start;
+    report("shared-memory ring  ", nread, nparticles, elapsed.count());
+  }
+
+  return 0;
+}
@@ -0,0 +1,99 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See https://alice-o2.web.cern.ch/ for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \author R+Preghenella - September 2017
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Pythia8/Pythia.h"
+#include "Generator/SharedMemoryRing.h"
+
+/** Pythia8 event writer for the shared-memory interface, 
+    events are produced until the reader goes away, does not
+    attach in time or the generator keeps failing **/
+
+const Int_t kMaxFailures = 100;  // consecutive failed events
+
+int
+main (Int_t argc, char **argv)
+{
+
+  /** process arguments **/
+  if (argc < 3) {
+    std::cout << "usage: ro2sim-pythia8 [configFileName] [shmName] [shmSize (MB)]" << std::endl;
+    return 1;
+  }
+  std::string config = argv[1];
+  std::string name = argv[2];
+  ULong64_t size = argc > 3 ? std::stoull(argv[3]) : 64;
+  
+  /** init pythia **/
+  Pythia8::Pythia pythia;
+  if (!pythia.readFile(config) || !pythia.init()) {
+    std::cout << "Failed to initialise Pythia8 with configuration: " << config << std::endl;
+    return 1;
+  }
+
+  /** create ring **/
+  o2::eventgen::SharedMemoryRing ring;
+  if (!ring.Create(name, size * 1024 * 1024)) return 1;
+
+  /** event loop **/
+  o2::eventgen::SharedMemoryRing::EventHeader_t header;
+  std::vector<o2::eventgen::SharedMemoryRing::ParticleRecord_t> particles;
+  Int_t nfailures = 0;
+  for (Long64_t iev = 0; ; iev++) {
+    if (!pythia.next()) {
+      if (++nfailures < kMaxFailures) continue;
+      std::cout << "Pythia8 failed generating " << kMaxFailures << " consecutive events" << std::endl;
+      break;
+    }
+    nfailures = 0;
+    
+    /** pack particles, skipping the system entry **/
+    auto const &event = pythia.event;
+    particles.resize(event.size() - 1);
+    for (Int_t ipart = 1; ipart < event.size(); ipart++) {
+      auto const &particle = event[ipart];
+      auto &record = particles[ipart - 1];
+      record.pdg = particle.id();
+      record.status = particle.statusHepMC();
+      record.mother = particle.mother1() - 1;
+      record.reserved = 0;
+      record.px = particle.px();
+      record.py = particle.py();
+      record.pz = particle.pz();
+      record.e = particle.e();
+      record.vx = particle.xProd();
+      record.vy = particle.yProd();
+      record.vz = particle.zProd();
+      record.vt = particle.tProd();
+    }
+
+    /** header **/
+    header.number = iev;
+    header.nParticles = particles.size();
+    header.flags = o2::eventgen::SharedMemoryRing::kCrossSection;
+    header.crossSection = pythia.info.sigmaGen() * 1.e9; // [mb -> pb]
+    header.crossSectionError = pythia.info.sigmaErr() * 1.e9; // [mb -> pb]
+    header.acceptedEvents = pythia.info.nAccepted();
+    header.attemptedEvents = pythia.info.nTried();
+
+    /** write, fails when the reader is gone **/
+    if (!ring.WriteEvent(header, particles.data())) break;
+  }
+
+  /** done **/
+  ring.SetWriterDone();
+  ring.Close();
+  return 0;
+}
@@ -12,18 +12,60 @@
 
 #include <boost/program_options.hpp>
 #include <iostream>
+#include <fstream>
+#include <sstream>
 #include <string>
+#include <ctime>
+#include <unistd.h>
 
 #include "FairRunSim.h"
+#include "TROOT.h"
 #include "Run/RunManager.h"
+#include "Core/Profiler.h"
+
+/** time spent before main, that is loading the linked libraries
+    and registering their dictionaries, from the process start
+    time in /proc/self/stat. returns -1 if not available **/
+Long64_t
+GetPreloadTime()
+{
+  std::ifstream fin("/proc/self/stat");
+  std::string stat;
+  if (!fin.is_open() || !std::getline(fin, stat)) return -1;
+  /** the command name may contain spaces, fields start after it **/
+  auto pos = stat.rfind(')');
+  if (pos == std::string::npos) return -1;
+  std::istringstream fields(stat.substr(pos + 2));
+  std::string field;
+  for (Int_t i = 3; i < 22; ++i) fields >> field;
+  ULong64_t start;
+  if (!(fields >> start)) return -1;
+  struct timespec now;
+  if (clock_gettime(CLOCK_BOOTTIME, &now) != 0) return -1;
+  Long64_t elapsed = (Long64_t)now.tv_sec * 1000000000LL + now.tv_nsec;
+  elapsed -= (Long64_t)(start * (1000000000. / sysconf(_SC_CLK_TCK)));
+  return elapsed;
+}
 
 int
 main (Int_t argc, char **argv)
 {
 
+  /** startup profile is requested before anything else is done **/
+  Long64_t preload = -1;
+  for (Int_t i = 1; i < argc; ++i)
+    if (std::string(argv[i]) == "--startup-profile") {
+      preload = GetPreloadTime();
+      o2sim::Profiler::SetStartupEnabled(kTRUE);
+    }
+  if (preload >= 0) o2sim::Profiler::Instance().GetEntry("startup.preload")->Add(1, preload);
+  
   /** create instances **/
+  auto start = o2sim::Profiler::Now();
   FairRunSim *rs = new FairRunSim();
   o2sim::RunManager *rm = new o2sim::RunManager();
+  auto entry = o2sim::Profiler::Instance().GetEntry("startup.instances");
+  if (entry) entry->Add(1, o2sim::Profiler::Now() - start);
 
   /** process arguments **/
   namespace po = boost::program_options;
@@ -34,6 +76,9 @@ main (Int_t argc, char **argv)
     ("generator", po::value<std::string>(), "Select a generator recipe")
     ("nevents", po::value<int>(), "Number of events to be generated")
     ("config", po::value<std::string>(), "Use custom configuration from file")
+    ("config-cache", po::value<std::string>(), "Directory of the resolved configuration cache")
+    ("startup-profile", "Report the time spent in each startup stage")
+    ("resume", "Resume the run from the last checkpoint")
   ;
 
   po::variables_map vm;
@@ -78,10 +123,27 @@ main (Int_t argc, char **argv)
     commandBuffer.push_back(command.str());
   }
 
+  /** configuration cache **/
+  if (vm.count("config-cache"))
+    rm->SetConfigCache(vm["config-cache"].as<std::string>());
+
+  /** resume from checkpoint **/
+  if (vm.count("resume")) rm->SetResume(kTRUE);
+  
   /** process command buffer **/
   if (!rm->ProcessBuffer(commandBuffer)) exit(1);
+  /** ROOT thread safety before any thread is started, only if
+      background files or generator events are read by other threads **/
+  if (rm->UsesThreads()) ROOT::EnableThreadSafety();
   /** init **/
   if (!rm->Init()) exit(1);
+  /** startup report, FairRunSim::Init includes the geometry construction.
+      the run is profiled only if simulation.profiling is on **/
+  if (vm.count("startup-profile")) {
+    o2sim::Profiler::Instance().Print("startup.");
+    o2sim::Profiler::Instance().Print("init.");
+    o2sim::Profiler::SetStartupEnabled(kFALSE);
+  }
   /** run **/
   if (!rm->Run()) exit(1);
   /** terminate **/
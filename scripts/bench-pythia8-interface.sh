@@ -0,0 +1,54 @@
+#! /usr/bin/env bash
+
+# Pythia8 interface benchmark, the same inelastic Pythia8 setup is run
+# in generator-only mode with each interface_mode. the startup is the
+# time to the first event, the per-event overhead is taken from the
+# difference between a 1-event and an N-event run
+
+if [[ $# -lt 1 || $1 -lt 2 ]]; then
+    echo "usage: bench-pythia8-interface.sh [nEvents (>= 2)] [interfaceModes (default: fifo shm inprocess)]"
+    exit -1
+fi
+
+NEVENTS=$1
+shift
+MODES=${@:-fifo shm inprocess}
+GENERATOR=py8_inelastic
+
+# time of a profiling entry
+entry_time() {
+    sed -n "s/.*\"$2\": {\"count\": [0-9]*, \"time\": \([0-9.eE+-]*\)}.*/\1/p" $1
+}
+
+# init and generation time of a run with the given number of events
+run_time() {
+    local mode=$1 nevents=$2
+    local cfg=bench.$mode.$nevents.cfg
+    local profile=bench.$mode.$nevents.json
+    cat > $cfg <<EOC
+include()		\$O2SIM_ROOT/receipes/o2sim.cfg
+generator.include()	\$O2SIM_ROOT/receipes/generators/pythia8_inelastic.cfg
+simulation
+.mode			generator_only
+.nevents		$nevents
+.nworkers		1
+.output_filename	bench.$mode.$nevents.root
+.profiling		on
+.profiling_filename	$profile
+generator.$GENERATOR.interface_mode	$mode
+EOC
+    ro2sim --config $cfg > bench.$mode.$nevents.log 2>&1 || return 1
+    local init=$(entry_time $profile init.generator)
+    local generate=$(entry_time $profile generator.$GENERATOR.generate)
+    echo "$init + $generate" | bc -l
+}
+
+printf '=%.0s' {1..80} && printf '\n'
+for MODE in $MODES; do
+    T1=$(run_time $MODE 1) || { echo "$MODE: run failed, see bench.$MODE.1.log"; continue; }
+    TN=$(run_time $MODE $NEVENTS) || { echo "$MODE: run failed, see bench.$MODE.$NEVENTS.log"; continue; }
+    PEREVENT=$(echo "($TN - $T1) / ($NEVENTS - 1)" | bc -l)
+    printf "%-10s | startup = %8.3f s | per event = %8.3f ms | rate = %8.1f events/s\n" \
+	   $MODE $T1 $(echo "1000 * $PEREVENT" | bc -l) $(echo "1 / $PEREVENT" | bc -l)
+done
+printf '=%.0s' {1..80} && printf '\n'